@@ -0,0 +1,214 @@
+/**
+ * Benchmark Catalogs
+ *
+ * Builds solver catalogs without Node: a deterministic synthetic
+ * generator, a loader for catalogs written by convert-catalog.js (or
+ * binary catalogs from native/tools/build-catalog.js) and a randomized
+ * request mix.
+ * Include after ../src/constraint-solver.c (built with SOLVER_NO_NAPI).
+ * Each driver uses some of these; the others are marked unused.
+ */
+
+#ifndef BENCH_CATALOG_H
+#define BENCH_CATALOG_H
+
+#include <stdio.h>
+
+/**
+ * Finish a filled catalog: candidate index and default recovery windows
+ */
+static void finish_catalog(Catalog* cat) {
+    build_candidate_index(cat);
+    for (int32_t m = 0; m < MASK_MUSCLES; m++) {
+        if (cat->muscle_recovery_hours[m] == 0) {
+            cat->muscle_recovery_hours[m] = DEFAULT_RECOVERY_HOURS;
+        }
+    }
+}
+
+/**
+ * Fill a catalog with deterministic pseudo-random exercises
+ * Distribution loosely follows the real catalogs: every exercise works at
+ * the gym, a third need one equipment item, ~6 muscles activated each
+ */
+static Catalog* synthetic_catalog(int32_t count, uint32_t seed) {
+    Catalog* cat = catalog_create(count);
+    if (!cat) return NULL;
+
+    uint32_t rng = seed ? seed : 0x2545F491u;
+    float activations[MAX_MUSCLES];
+
+    for (int32_t i = 0; i < count; i++) {
+        Exercise* ex = &cat->exercises[i];
+        ex->id = (int32_t)(xorshift32(&rng) & 0x7FFFFFFF);
+        ex->estimated_seconds = 30 + (int32_t)(xorshift32(&rng) % 60);
+        ex->rest_seconds = 60 + (int32_t)(xorshift32(&rng) % 4) * 15;
+        ex->locations_mask = (int32_t)(xorshift32(&rng) & 0x3F) | 1;
+        ex->equipment_required_mask = (xorshift32(&rng) % 3 == 0) ? 1 << (xorshift32(&rng) % 5) : 0;
+        ex->primary_muscles_mask = 1 << (xorshift32(&rng) % 31);
+
+        cat->difficulty[i] = 1 + (int32_t)(xorshift32(&rng) % 5);
+        cat->movement_pattern[i] = (int32_t)(xorshift32(&rng) % PATTERN_SLOTS);
+        cat->is_compound[i] = (int32_t)(xorshift32(&rng) & 1);
+
+        for (int32_t m = 0; m < MAX_MUSCLES; m++) {
+            activations[m] = (xorshift32(&rng) % 8 == 0) ? (float)(xorshift32(&rng) % 100) : 0.0f;
+        }
+        set_exercise_muscles(cat, i, activations);
+        cat->exercise_count++;
+    }
+
+    finish_catalog(cat);
+    return cat;
+}
+
+/**
+ * Load a catalog written by convert-catalog.js, or a binary catalog from
+ * native/tools/build-catalog.js (mapped in place)
+ * Returns NULL (after printing the reason) on error
+ */
+static __attribute__((unused)) Catalog* load_catalog(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+
+    char magic[sizeof(CATALOG_MAGIC)] = {0};
+    if (fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, CATALOG_MAGIC, sizeof(magic)) == 0) {
+        fclose(file);
+        int error = 0;
+        Catalog* cat = catalog_from_file(path, &error);
+        if (!cat) {
+            fprintf(stderr, "%s: %s\n", path, catalog_error_string(error));
+        }
+        return cat;
+    }
+    rewind(file);
+
+    int32_t version = 0, count = 0;
+    int32_t recovery[MASK_MUSCLES];
+    if (fscanf(file, "musclemap-solver-catalog %d recovery", &version) != 1 || version != 1) {
+        fprintf(stderr, "%s: not a version 1 solver catalog\n", path);
+        fclose(file);
+        return NULL;
+    }
+    for (int32_t m = 0; m < MASK_MUSCLES; m++) {
+        if (fscanf(file, "%d", &recovery[m]) != 1) {
+            fprintf(stderr, "%s: truncated recovery line\n", path);
+            fclose(file);
+            return NULL;
+        }
+    }
+    if (fscanf(file, " exercises %d", &count) != 1 || count < 0 || count > MAX_CATALOG_EXERCISES) {
+        fprintf(stderr, "%s: bad exercise count\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    Catalog* cat = catalog_create(count);
+    if (!cat) {
+        fclose(file);
+        return NULL;
+    }
+    memcpy(cat->muscle_recovery_hours, recovery, sizeof(recovery));
+
+    for (int32_t i = 0; i < count; i++) {
+        Exercise* ex = &cat->exercises[i];
+        int32_t activated = 0;
+        float activations[MAX_MUSCLES] = {0};
+
+        int32_t fields = fscanf(file, "%d %d %d %d %d %d %d %d %d %d",
+                                &ex->id, &cat->difficulty[i], &cat->is_compound[i], &cat->movement_pattern[i],
+                                &ex->estimated_seconds, &ex->rest_seconds, &ex->locations_mask,
+                                &ex->equipment_required_mask, &ex->primary_muscles_mask, &activated);
+        if (fields != 10) {
+            fprintf(stderr, "%s: bad exercise record %d\n", path, i);
+            free(cat);
+            fclose(file);
+            return NULL;
+        }
+
+        for (int32_t a = 0; a < activated; a++) {
+            int32_t muscle;
+            float value;
+            if (fscanf(file, " %d:%f", &muscle, &value) != 2) {
+                fprintf(stderr, "%s: bad activation in record %d\n", path, i);
+                free(cat);
+                fclose(file);
+                return NULL;
+            }
+            if (muscle >= 0 && muscle < MAX_MUSCLES) {
+                activations[muscle] = value;
+            }
+        }
+
+        set_exercise_muscles(cat, i, activations);
+        cat->exercise_count++;
+    }
+
+    fclose(file);
+    finish_catalog(cat);
+    return cat;
+}
+
+typedef struct {
+    SolverRequest request;
+    uint64_t* excluded;                  // Owned bitset, or NULL
+} BenchRequest;
+
+/**
+ * Randomized request mix
+ * Mostly gym/home sessions of 10-90 minutes with one or two goals; a
+ * quarter exclude a muscle, a third carry recent-work history and a fifth
+ * exclude up to eight exercises
+ */
+static __attribute__((unused)) BenchRequest* generate_requests(const Catalog* cat, int32_t count, uint32_t seed,
+                                                               int32_t optimize_us) {
+    static const int32_t locations[] = {0, 0, 0, 1, 1, 2, 3, 4, 5};
+    BenchRequest* requests = calloc((size_t)count, sizeof(BenchRequest));
+    if (!requests) return NULL;
+
+    uint32_t rng = seed ? seed : 0x9E3779B9u;
+    for (int32_t i = 0; i < count; i++) {
+        SolverRequest* req = &requests[i].request;
+        req->weights = DEFAULT_WEIGHTS;
+        req->time_available_seconds = 600 + (int32_t)(xorshift32(&rng) % 4800);
+        req->location = locations[xorshift32(&rng) % (sizeof(locations) / sizeof(locations[0]))];
+        req->equipment_mask = (int32_t)(xorshift32(&rng) & 0x1FF);
+        req->goals_mask = 1 << (xorshift32(&rng) % 5);
+        if (xorshift32(&rng) % 3 == 0) req->goals_mask |= 1 << (xorshift32(&rng) % 5);
+        req->fitness_level = (int32_t)(xorshift32(&rng) % 3);
+        if (xorshift32(&rng) % 4 == 0) req->excluded_muscles_mask = 1 << (xorshift32(&rng) % 31);
+        if (xorshift32(&rng) % 3 == 0) {
+            req->recent_24h_muscles_mask = (int32_t)(xorshift32(&rng) & 0xFFFF);
+            req->recent_48h_muscles_mask = (int32_t)(xorshift32(&rng) & 0xFFFF0);
+        }
+        req->optimize_deadline_us = optimize_us;
+
+        if (cat->exercise_count > 0 && xorshift32(&rng) % 5 == 0) {
+            uint64_t* excluded = calloc((size_t)cat->words, sizeof(uint64_t));
+            if (excluded) {
+                int32_t excluded_count = 1 + (int32_t)(xorshift32(&rng) % 8);
+                for (int32_t e = 0; e < excluded_count; e++) {
+                    int32_t idx = (int32_t)(xorshift32(&rng) % (uint32_t)cat->exercise_count);
+                    excluded[idx / 64] |= 1ULL << (idx % 64);
+                }
+                requests[i].excluded = excluded;
+                req->excluded_exercises = excluded;
+            }
+        }
+    }
+    return requests;
+}
+
+/**
+ * Free a request mix from generate_requests()
+ */
+static __attribute__((unused)) void free_requests(BenchRequest* requests, int32_t count) {
+    if (!requests) return;
+    for (int32_t i = 0; i < count; i++) free(requests[i].excluded);
+    free(requests);
+}
+
+#endif // BENCH_CATALOG_H
@@ -0,0 +1,59 @@
+#!/usr/bin/env node
+/**
+ * Convert the exercise JSON catalogs into the solver benchmark format
+ *
+ * Usage: node convert-catalog.js [output] (default: bench/catalog.txt)
+ *
+ * Reads musclemap_exercises.json and new-path-exercises.json from the
+ * repository root and writes the text format read by load_catalog() in
+ * bench-catalog.h:
+ *
+ *   musclemap-solver-catalog 1
+ *   recovery <32 recovery hours, one per mask muscle>
+ *   exercises <count>
+ *   <id> <difficulty> <compound> <pattern> <seconds> <rest> <locations> <equipment> <primary> <n> <muscle>:<activation> x n
+ *
+ * Exercises are mapped by readSourceCatalog() in native/tools/build-catalog.js,
+ * which also writes the binary catalog; the solver keeps the first 50 muscles.
+ * IDs are the FNV-1a hashes of the string IDs (the solver's "hashed" exercise ID).
+ */
+
+const fs = require('fs');
+const path = require('path');
+const { readSourceCatalog } = require('../../../../native/tools/build-catalog.js');
+
+const MAX_MUSCLES = 50;
+const MASK_MUSCLES = 32;
+
+function main() {
+  const output = process.argv[2] || path.join(__dirname, 'catalog.txt');
+  const { muscles, exercises } = readSourceCatalog();
+
+  const recovery = muscles.slice(0, MASK_MUSCLES).map((m) => m.recoveryHours);
+  while (recovery.length < MASK_MUSCLES) recovery.push(48);
+
+  const lines = exercises.map((ex) => {
+    const activations = [];
+    for (let m = 0; m < MAX_MUSCLES; m++) {
+      if (ex.activations[m] > 0) activations.push(`${m}:${ex.activations[m]}`);
+    }
+    return [
+      ex.hash, ex.difficulty, ex.compound, ex.pattern, ex.seconds, ex.rest,
+      ex.locations, ex.equipment, ex.primary,
+      activations.length, ...activations,
+    ].join(' ');
+  });
+
+  const text = [
+    'musclemap-solver-catalog 1',
+    `recovery ${recovery.join(' ')}`,
+    `exercises ${lines.length}`,
+    ...lines,
+    '',
+  ].join('\n');
+
+  fs.writeFileSync(output, text);
+  console.log(`Wrote ${lines.length} exercises to ${output}`);
+}
+
+main();
@@ -0,0 +1,78 @@
+/**
+ * Static Scoring Microbenchmark
+ *
+ * Compares the vectorized score_static_kernel against one static_score
+ * call per exercise (the ScoreBatch path) over a synthetic catalog.
+ *
+ * Compile: gcc -O3 -std=c11 -D_GNU_SOURCE -Wall -Wextra -o score-bench score-bench.c -lm -lpthread
+ * Usage:   ./score-bench [exercise_count] [iterations]
+ */
+
+#define SOLVER_NO_NAPI
+#include "../src/constraint-solver.c"
+
+#include "bench-catalog.h"
+
+int main(int argc, char** argv) {
+    int32_t count = argc > 1 ? atoi(argv[1]) : 10000;
+    int32_t iterations = argc > 2 ? atoi(argv[2]) : 2000;
+    if (count <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s [exercise_count] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    Catalog* cat = synthetic_catalog(count, 0);
+    float* scalar = malloc((size_t)count * sizeof(float));
+    float* vector = malloc((size_t)count * sizeof(float));
+    if (!cat || !scalar || !vector) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    SolverRequest req = {0};
+    req.weights = (ScoringWeights){10.0f, 5.0f, -20.0f, -10.0f, 5.0f, 15.0f};
+    req.goals_mask = (1 << GOAL_STRENGTH) | (1 << GOAL_HYPERTROPHY);
+    req.fitness_level = 1;
+
+    // Scalar path: one static_score call per exercise
+    double sink = 0.0;
+    uint64_t start = now_us();
+    for (int32_t it = 0; it < iterations; it++) {
+        req.fitness_level = it % 3;
+        StaticTerms terms;
+        static_terms(&req, &terms);
+        for (int32_t i = 0; i < count; i++) {
+            scalar[i] = static_score(&terms, cat->movement_pattern[i], cat->is_compound[i], cat->difficulty[i]);
+        }
+        sink += scalar[it % count];
+    }
+    uint64_t scalar_us = now_us() - start;
+
+    // Vectorized path: resolve terms once per request, then the kernel
+    start = now_us();
+    for (int32_t it = 0; it < iterations; it++) {
+        req.fitness_level = it % 3;
+        StaticTerms terms;
+        static_terms(&req, &terms);
+        score_static_kernel(cat, &terms, 0, count, vector);
+        sink += vector[it % count];
+    }
+    uint64_t vector_us = now_us() - start;
+
+    int32_t mismatches = 0;
+    for (int32_t i = 0; i < count; i++) {
+        if (scalar[i] != vector[i]) mismatches++;
+    }
+
+    double total = (double)count * iterations;
+    printf("exercises=%d iterations=%d\n", count, iterations);
+    printf("scalar: %8.3f ns/exercise\n", (double)scalar_us * 1000.0 / total);
+    printf("kernel: %8.3f ns/exercise\n", (double)vector_us * 1000.0 / total);
+    printf("speedup: %.2fx  mismatches: %d  (checksum %.1f)\n",
+           (double)scalar_us / (double)(vector_us ? vector_us : 1), mismatches, sink);
+
+    free(vector);
+    free(scalar);
+    free(cat);
+    return mismatches != 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * Constraint Solver Benchmark
+ *
+ * Replays a randomized SolverRequest mix through solve() (uncached) on a
+ * real or synthetic catalog, outside Node. Reports p50/p90/p99 latency
+ * and solves per second per core.
+ *
+ * Compile: gcc -O3 -std=c11 -D_GNU_SOURCE -o solver-bench solver-bench.c -lm -lpthread
+ * Usage:   ./solver-bench [--catalog FILE | --synthetic N] [--requests N]
+ *                         [--threads N] [--seed N] [--optimize MICROS]
+ *
+ * Real catalogs come from convert-catalog.js or the binary catalog
+ * (native/tools/build-catalog.js); --synthetic defaults to 2000.
+ */
+
+#define SOLVER_NO_NAPI
+#include "../src/constraint-solver.c"
+
+#include "bench-catalog.h"
+
+#include <sched.h>
+
+#define WARMUP_SOLVES 200
+
+typedef struct {
+    const Catalog* cat;
+    const BenchRequest* requests;
+    int32_t request_count;
+    int32_t cpu;
+    uint64_t* latencies_ns;              // [request_count]
+    uint64_t elapsed_ns;
+    int64_t selected;
+} BenchThread;
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Replay the whole request mix on one thread (pinned when possible)
+ */
+static void* bench_thread(void* arg) {
+    BenchThread* bt = arg;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(bt->cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+
+    Arena* arena = thread_arena();
+    ArenaMark mark = arena_mark(arena);
+    int32_t* out_indices = malloc((size_t)(bt->cat->exercise_count + 1) * sizeof(int32_t));
+    int32_t* out_sets = malloc((size_t)(bt->cat->exercise_count + 1) * sizeof(int32_t));
+    int32_t* out_reps = malloc((size_t)(bt->cat->exercise_count + 1) * sizeof(int32_t));
+    if (!out_indices || !out_sets || !out_reps) {
+        free(out_indices);
+        free(out_sets);
+        free(out_reps);
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < WARMUP_SOLVES; i++) {
+        solve(bt->cat, &bt->requests[i % bt->request_count].request, out_indices, out_sets, out_reps, NULL,
+              bt->cat->exercise_count);
+        arena_release(arena, mark);
+    }
+
+    uint64_t start = bench_now_ns();
+    for (int32_t i = 0; i < bt->request_count; i++) {
+        uint64_t t0 = bench_now_ns();
+        bt->selected += solve(bt->cat, &bt->requests[i].request, out_indices, out_sets, out_reps, NULL,
+                              bt->cat->exercise_count);
+        arena_release(arena, mark);
+        bt->latencies_ns[i] = bench_now_ns() - t0;
+    }
+    bt->elapsed_ns = bench_now_ns() - start;
+
+    free(out_indices);
+    free(out_sets);
+    free(out_reps);
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const uint64_t* sorted, size_t count, double p) {
+    size_t rank = (size_t)(p * (double)(count - 1) + 0.5);
+    return (double)sorted[rank] / 1000.0;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--catalog FILE | --synthetic N] [--requests N] [--threads N] [--seed N] [--optimize MICROS]\n",
+            argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* catalog_path = NULL;
+    int32_t synthetic = 2000;
+    int32_t request_count = 20000;
+    int32_t thread_count = 1;
+    int32_t optimize_us = 0;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--catalog") == 0) catalog_path = argv[++i];
+        else if (strcmp(argv[i], "--synthetic") == 0) synthetic = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--requests") == 0) request_count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0) thread_count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--optimize") == 0) optimize_us = atoi(argv[++i]);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (synthetic <= 0 || request_count <= 0 || thread_count <= 0 || thread_count > EVAL_MAX_THREADS) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Catalog* cat = catalog_path ? load_catalog(catalog_path) : synthetic_catalog(synthetic, seed);
+    if (!cat) {
+        fprintf(stderr, "failed to build catalog\n");
+        return 1;
+    }
+
+    BenchRequest* requests = generate_requests(cat, request_count, seed, optimize_us);
+    BenchThread* threads = calloc((size_t)thread_count, sizeof(BenchThread));
+    uint64_t* latencies = malloc((size_t)thread_count * (size_t)request_count * sizeof(uint64_t));
+    pthread_t* handles = calloc((size_t)thread_count, sizeof(pthread_t));
+    if (!requests || !threads || !latencies || !handles) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int32_t t = 0; t < thread_count; t++) {
+        threads[t].cat = cat;
+        threads[t].requests = requests;
+        threads[t].request_count = request_count;
+        threads[t].cpu = (int32_t)(t % (cpus > 0 ? cpus : 1));
+        threads[t].latencies_ns = latencies + (size_t)t * request_count;
+        pthread_create(&handles[t], NULL, bench_thread, &threads[t]);
+    }
+
+    double per_core = 0.0;
+    int64_t selected = 0;
+    for (int32_t t = 0; t < thread_count; t++) {
+        pthread_join(handles[t], NULL);
+        if (threads[t].elapsed_ns > 0) {
+            per_core += (double)request_count * 1e9 / (double)threads[t].elapsed_ns;
+        }
+        selected += threads[t].selected;
+    }
+    per_core /= thread_count;
+
+    size_t samples = (size_t)thread_count * request_count;
+    qsort(latencies, samples, sizeof(uint64_t), compare_u64);
+
+    printf("catalog:   %s (%d exercises)\n", catalog_path ? catalog_path : "synthetic", cat->exercise_count);
+    printf("requests:  %d x %d thread(s), seed %u%s\n", request_count, thread_count, seed,
+           optimize_us > 0 ? ", optimize" : "");
+    printf("latency:   p50 %.1f us  p90 %.1f us  p99 %.1f us  max %.1f us\n",
+           percentile_us(latencies, samples, 0.50), percentile_us(latencies, samples, 0.90),
+           percentile_us(latencies, samples, 0.99), (double)latencies[samples - 1] / 1000.0);
+    printf("throughput: %.0f solves/s per core, %.0f solves/s total\n", per_core, per_core * thread_count);
+    printf("plan size: %.2f exercises on average\n", (double)selected / (double)samples);
+
+    free_requests(requests, request_count);
+    free(threads);
+    free(latencies);
+    free(handles);
+    catalog_file_close(&cat->file);
+    free(cat);
+    return 0;
+}
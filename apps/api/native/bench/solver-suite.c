@@ -0,0 +1,72 @@
+/**
+ * Constraint Solver Benchmark Suite
+ *
+ * The solver's entry in `make bench` (native/Makefile): solve() on
+ * synthetic catalogs through the shared harness in native/bench/bench.h,
+ * so results land in the same JSON format as the library suites. Use
+ * solver-bench.c for multi-threaded throughput and real catalogs.
+ *
+ * Compile: gcc -O3 -std=c11 -D_GNU_SOURCE -I../../../../native/bench -o solver-suite solver-suite.c -lm -lpthread
+ * Usage:   ./solver-suite [bench.h flags]
+ */
+
+#define SOLVER_NO_NAPI
+#include "../src/constraint-solver.c"
+
+#include "bench-catalog.h"
+#include "bench.h"
+
+#define SUITE_REQUESTS 512
+
+typedef struct {
+    const Catalog* cat;
+    const BenchRequest* requests;
+    int32_t* out_indices;
+    int32_t* out_sets;
+    int32_t* out_reps;
+    int32_t next;
+} SolverBench;
+
+static void bench_solve(void* ctx) {
+    SolverBench* s = ctx;
+    const BenchRequest* req = &s->requests[s->next++ % SUITE_REQUESTS];
+    Arena* arena = thread_arena();
+    ArenaMark mark = arena_mark(arena);
+    bench_sink = solve(s->cat, &req->request, s->out_indices, s->out_sets, s->out_reps, NULL,
+                       s->cat->exercise_count);
+    arena_release(arena, mark);
+}
+
+int main(int argc, char** argv) {
+    Bench b;
+    if (bench_init(&b, "solver", argc, argv) != 0) return 1;
+
+    static const int32_t sizes[] = {500, 2000};
+    char name[64];
+    for (size_t c = 0; c < sizeof(sizes) / sizeof(sizes[0]); c++) {
+        Catalog* cat = synthetic_catalog(sizes[c], 0);
+        BenchRequest* requests = cat ? generate_requests(cat, SUITE_REQUESTS, 0, 0) : NULL;
+        SolverBench s = {
+            .cat = cat,
+            .requests = requests,
+            .out_indices = malloc((size_t)(sizes[c] + 1) * sizeof(int32_t)),
+            .out_sets = malloc((size_t)(sizes[c] + 1) * sizeof(int32_t)),
+            .out_reps = malloc((size_t)(sizes[c] + 1) * sizeof(int32_t)),
+        };
+        if (!cat || !requests || !s.out_indices || !s.out_sets || !s.out_reps) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+
+        snprintf(name, sizeof(name), "solve_synthetic_%d", sizes[c]);
+        bench_run(&b, name, bench_solve, &s, 1.0);
+
+        free(s.out_indices);
+        free(s.out_sets);
+        free(s.out_reps);
+        free_requests(requests, SUITE_REQUESTS);
+        free(cat);
+    }
+
+    return bench_finish(&b);
+}
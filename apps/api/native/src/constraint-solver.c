@@ -4,22 +4,75 @@
  * High-performance constraint solver for workout prescription.
  * Uses N-API for Node.js integration.
  *
+ * Build with -DSOLVER_PROFILE to record per-phase timings and counters
+ * (see getSolverStats); without it the instrumentation compiles out.
+ * solve() also carries USDT probes at its phase boundaries
+ * (native/src/common/probes.h), free until a tracer attaches.
+ *
+ * Built with -DMUSCLEMAP_NATIVE_CAPTURE (linked against libnativecapture),
+ * solve requests are sampled into the native call capture for offline
+ * replay (native/src/capture/native_capture.h).
+ *
+ * Catalogs come from initExercises (JavaScript objects) or
+ * loadCatalogFile, which maps the shared binary catalog
+ * (native/src/common/catalog_format.h) and uses its columns in place.
+ *
  * Key optimizations:
- * - SIMD-friendly data layout
- * - Cache-optimized scoring loop
+ * - Structure-of-arrays catalog for scoring inputs
+ * - Vectorized static scoring kernel (AVX2 / AVX-512 clones on x86-64)
  * - Branch prediction hints
  * - Memory pooling to avoid allocations in hot path
  */
 
+#ifndef SOLVER_NO_NAPI
 #include <node_api.h>
+#endif
+#include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
 #include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "../../../../native/src/common/probes.h"
+#include "../../../../native/src/common/catalog_format.h"
+#include "../../../../native/src/common/cpu_dispatch.h"
+#include "../../../../native/src/capture/native_capture.h"
+
+// Binding helpers that standalone (SOLVER_NO_NAPI) drivers use only in
+// part: benches and tools/replay each call a different subset
+#ifdef SOLVER_NO_NAPI
+#define BINDING_HELPER __attribute__((unused))
+#else
+#define BINDING_HELPER
+#endif
 
-#define MAX_EXERCISES 500
 #define MAX_MUSCLES 50
 #define MAX_STRING_LEN 128
+#define MAX_LOCATIONS 32                 // One per bit of locations_mask
+#define MAX_EQUIPMENT 32                 // One per bit of equipment_required_mask
+#define MAX_CATALOG_EXERCISES (1 << 20)  // Upper bound on initExercises length
+#define ARENA_MIN_BLOCK (64 * 1024)     // Initial per-thread scratch arena size
+#define MASK_MUSCLES 32                  // Muscles representable in an int32 mask
+#define PATTERN_SLOTS 7                  // Movement patterns with goal preferences (push..isolation)
+#define MAX_PROGRAM_SESSIONS 14
+#define DEFAULT_RECOVERY_HOURS 48
+#define DEFAULT_VARIETY 5.0f             // Seeded noise amplitude (score points)
+#define MAX_GROUP_SIZE 4                 // Exercises per superset/circuit
+#define GROUP_TRANSITION_SECONDS 15      // Moving between exercises within a group round
+#define CACHE_CAPACITY 256               // Cached plans (LRU)
+#define CACHE_BUCKETS 512
+#define CACHE_MAX_RESULTS 64             // Longer plans are not cached
+#define CACHE_MAX_EXCLUSIONS 32          // Requests excluding more exercises are not cached
+#define EVAL_WEIGHT_FIELDS 6             // Floats per weight vector (ScoringWeights order)
+#define EVAL_REQUEST_FIELDS 8            // Int32 fields per packed evaluation request
+#define EVAL_MAX_THREADS 64
+#define EVAL_DEFAULT_THREADS 4           // Per call unless { threads } asks for more
+#define EVAL_CHUNK 16                    // Combinations claimed per worker fetch
 
 // Scoring weights
 typedef struct {
@@ -31,15 +84,12 @@ typedef struct {
     float muscle_coverage_gap;
 } ScoringWeights;
 
-// Exercise data structure (cache-optimized layout)
+// Exercise data structure (per-exercise fields used outside scoring)
+// Scoring inputs live in the catalog's structure-of-arrays columns
 typedef struct {
     int32_t id;                          // Exercise ID (hashed)
-    int32_t difficulty;                  // 1-5
-    int32_t is_compound;                 // 0 or 1
-    int32_t movement_pattern;            // enum: push=0, pull=1, squat=2, hinge=3, carry=4, core=5, isolation=6
     int32_t estimated_seconds;
     int32_t rest_seconds;
-    float activations[MAX_MUSCLES];      // Activation percentage for each muscle
     int32_t primary_muscles_mask;        // Bitmask of primary muscles
     int32_t locations_mask;              // Bitmask of valid locations
     int32_t equipment_required_mask;     // Bitmask of required equipment
@@ -47,28 +97,106 @@ typedef struct {
 
 // Request parameters
 typedef struct {
+    const uint64_t* excluded_exercises;  // Bitset over dense catalog indices (NULL = none)
     int32_t time_available_seconds;
     int32_t location;                    // enum: gym=0, home=1, park=2, hotel=3, office=4, travel=5
     int32_t equipment_mask;              // Bitmask of available equipment
     int32_t goals_mask;                  // Bitmask of goals
     int32_t fitness_level;               // 0=beginner, 1=intermediate, 2=advanced
-    int32_t excluded_exercises_mask[16]; // Bitmask for excluded exercises (up to 512)
     int32_t excluded_muscles_mask;       // Bitmask of excluded muscles
     int32_t recent_24h_muscles_mask;     // Muscles worked in last 24h
     int32_t recent_48h_muscles_mask;     // Muscles worked in last 48h
+    int32_t optimize_deadline_us;        // > 0 enables anytime plan optimization within this budget
+    int32_t pattern_quota[PATTERN_SLOTS]; // Max exercises per movement pattern per session (0 = no limit)
+    int32_t max_antagonist_imbalance;    // Max push/pull and squat/hinge count difference (0 = off)
+    uint32_t seed;                       // Non-zero adds reproducible per-exercise score noise
+    float variety;                       // Noise amplitude when seeded
+    int32_t max_group_size;              // > 1 pairs exercises into supersets/circuits (no anytime optimization)
     ScoringWeights weights;
 } SolverRequest;
 
+// Per-session prescription derived from goals
+typedef struct {
+    int32_t time_budget;                 // Seconds available after warmup/cooldown
+    int32_t sets;
+    int32_t reps;
+    float rest_multiplier;
+} SessionParams;
+
+// Per-request static scoring terms, resolved once so the kernel is branch-free
+typedef struct {
+    float pattern_bonus[PATTERN_SLOTS + 1]; // Goal alignment by movement pattern (last: unknown pattern)
+    float compound_bonus;                // Compound preference plus compound-goal alignment
+    float level_match;                   // Fitness match bonus (0 when the level is unknown)
+    float overreach_penalty;             // Per difficulty step above the level's range
+    int32_t min_difficulty;
+    int32_t max_difficulty;
+} StaticTerms;
+
+// Superset/circuit being built by select_session
+typedef struct {
+    uint64_t worked_mask;                // Union of the members' worked muscles
+    int32_t rest;                        // Rest between rounds (longest member rest)
+    int32_t size;
+} SessionGroup;
+
 // Scored exercise for sorting
 typedef struct {
-    int32_t index;
+    int32_t index;                       // Candidate position
+    int32_t exercise;                    // Catalog index (breaks score ties)
     float score;
 } ScoredExercise;
 
-// Global exercise cache (loaded once from JS)
-static Exercise g_exercises[MAX_EXERCISES];
-static int32_t g_exercise_count = 0;
-static int32_t g_initialized = 0;
+// Exercise catalog (built by InitExercises, immutable once published)
+// Solves hold a reference; a replaced catalog is freed by its last reader
+// Sized to the catalog and carved from a single allocation (catalog_create),
+// or pointing into a mapped catalog file (catalog_from_file)
+typedef struct {
+    _Atomic int32_t refcount;
+    uint32_t version;
+    int32_t exercise_count;
+    int32_t words;                       // 64-bit words per candidate bitset
+    Exercise* exercises;
+
+    // Scoring columns, one entry per exercise (structure-of-arrays)
+    int32_t* difficulty;                 // 1-5
+    int32_t* movement_pattern;           // enum: push=0, pull=1, squat=2, hinge=3, carry=4, core=5, isolation=6
+    int32_t* is_compound;                // 0 or 1
+    int32_t* exclusion_muscles_mask;     // Primary muscles plus muscles activated > 40%
+    uint64_t* active_muscles_mask;       // Muscles with any activation (all MAX_MUSCLES)
+    uint64_t* worked_muscles_mask;       // Primary plus muscles activated > 40% (all MAX_MUSCLES)
+
+    // Candidate index: rows of `words` words
+    // Bit i of a row is set when exercise i is valid at that location / needs that equipment
+    uint64_t* location_bits;             // [MAX_LOCATIONS][words]
+    uint64_t* equipment_bits;            // [MAX_EQUIPMENT][words]
+    int32_t equipment_used_mask;
+
+    // Exercise ID -> dense index + 1 (open addressing, 0 = empty)
+    int32_t* id_table;
+    uint32_t id_table_mask;              // Table size - 1 (power of two >= 2 * exercise_count)
+    uint32_t id_table_shift;             // 32 - log2(table size)
+
+    // Recovery window per muscle, used by multi-session programs
+    int32_t muscle_recovery_hours[MASK_MUSCLES];
+
+    // Backing file when the columns above live in a mapping (else not open)
+    CatalogFile file;
+} Catalog;
+
+// Mapped catalogs use the file's exercise records as-is
+_Static_assert(sizeof(Exercise) == sizeof(CatalogExercise) &&
+               offsetof(Exercise, estimated_seconds) == offsetof(CatalogExercise, estimated_seconds) &&
+               offsetof(Exercise, rest_seconds) == offsetof(CatalogExercise, rest_seconds) &&
+               offsetof(Exercise, primary_muscles_mask) == offsetof(CatalogExercise, primary_muscles_mask) &&
+               offsetof(Exercise, locations_mask) == offsetof(CatalogExercise, locations_mask) &&
+               offsetof(Exercise, equipment_required_mask) == offsetof(CatalogExercise, equipment_required_mask),
+               "Exercise must match the catalog file's exercise records");
+_Static_assert(MAX_LOCATIONS == CATALOG_BITSET_ROWS && MAX_EQUIPMENT == CATALOG_BITSET_ROWS,
+               "candidate bitset rows must match the catalog file");
+
+// Default scoring weights (overridable per request)
+static const ScoringWeights DEFAULT_WEIGHTS = {10.0f, 5.0f, -20.0f, -10.0f, 5.0f, 15.0f};
 
 // Difficulty ranges by fitness level
 static const int32_t DIFFICULTY_MIN[] = {1, 2, 3};
@@ -111,119 +239,784 @@ static const int32_t GOAL_PREFERRED_PATTERNS[] = {
 // Goal prefers compound
 static const int32_t GOAL_PREFER_COMPOUND[] = {1, 1, 0, 0, 1};
 
+// Antagonist movement pattern per pattern (-1 = none)
+static const int32_t PATTERN_ANTAGONIST[PATTERN_SLOTS] = {
+    PATTERN_PULL, PATTERN_PUSH, PATTERN_HINGE, PATTERN_SQUAT, -1, -1, -1
+};
+
+// Result of checking a candidate against the session's pattern counts
+enum PatternAdmission {
+    PATTERN_ADMIT = 0,
+    PATTERN_DEFER,                       // Would exceed the antagonist imbalance
+    PATTERN_REJECT                       // Pattern quota exhausted
+};
+
+// ============ Scratch Arena ============
+
 /**
- * Check if exercise passes hard filters
- * Returns 1 if valid, 0 if filtered out
+ * Per-thread bump arena for per-request scratch
+ *
+ * Every binding call marks the arena on entry and releases back to the
+ * mark on return, so after the first requests on a thread the memory is
+ * simply reused: no malloc on the hot path and no large stack frames on
+ * libuv threads. A request that outgrows the current block moves to a
+ * larger one; retired blocks are freed at the release.
+ *
+ * Marks nest: reading a request can run JS (a getter or Proxy) that calls
+ * back into the solver on the same thread, and the inner call releases
+ * only its own scratch, never the outer call's.
  */
-static inline int32_t __attribute__((hot))
-passes_hard_filters(const Exercise* ex, const SolverRequest* req) {
-    // Location check
-    if (!(ex->locations_mask & (1 << req->location))) {
-        return 0;
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;             // Retired blocks chain
+    size_t capacity;
+    size_t used;
+    _Alignas(64) uint8_t data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock* block;
+    ArenaBlock* retired;
+} Arena;
+
+typedef struct {
+    ArenaBlock* block;                   // Current block at the mark
+    size_t used;
+    ArenaBlock* retired;                 // Retired chain at the mark
+} ArenaMark;
+
+static _Thread_local Arena t_arena;
+static pthread_key_t g_arena_key;
+static pthread_once_t g_arena_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Free a thread's arena when the thread exits (worker_threads)
+ */
+static void arena_destroy(void* data) {
+    Arena* arena = data;
+    while (arena->retired) {
+        ArenaBlock* next = arena->retired->next;
+        free(arena->retired);
+        arena->retired = next;
     }
+    free(arena->block);
+    arena->block = NULL;
+}
 
-    // Equipment check (skip for gym location)
-    if (req->location != 0) { // Not gym
-        if ((ex->equipment_required_mask & ~req->equipment_mask) != 0) {
-            return 0;
+static void arena_key_create(void) {
+    pthread_key_create(&g_arena_key, arena_destroy);
+}
+
+/**
+ * Get the calling thread's arena
+ */
+static Arena* thread_arena(void) {
+    Arena* arena = &t_arena;
+    if (!arena->block) {
+        pthread_once(&g_arena_key_once, arena_key_create);
+        pthread_setspecific(g_arena_key, arena);
+    }
+    return arena;
+}
+
+/**
+ * Allocate zeroed scratch (64-byte aligned); NULL only if out of memory
+ */
+static void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + 63) & ~(size_t)63;
+
+    ArenaBlock* block = arena->block;
+    if (!block || block->capacity - block->used < size) {
+        size_t capacity = block ? block->capacity * 2 : ARENA_MIN_BLOCK;
+        while (capacity < size) capacity *= 2;
+
+        ArenaBlock* grown = aligned_alloc(64, (sizeof(ArenaBlock) + capacity + 63) & ~(size_t)63);
+        if (!grown) return NULL;
+        grown->capacity = capacity;
+        grown->used = 0;
+        grown->next = NULL;
+
+        if (block) {
+            block->next = arena->retired;
+            arena->retired = block;
         }
+        arena->block = block = grown;
     }
 
-    // Excluded exercises check (bitmask lookup)
-    int32_t bucket = ex->id / 32;
-    int32_t bit = ex->id % 32;
-    if (bucket < 16 && (req->excluded_exercises_mask[bucket] & (1 << bit))) {
-        return 0;
+    void* ptr = block->data + block->used;
+    block->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+/**
+ * Remember the arena's position (start of a binding call)
+ */
+static ArenaMark arena_mark(const Arena* arena) {
+    return (ArenaMark){arena->block, arena->block ? arena->block->used : 0, arena->retired};
+}
+
+/**
+ * Release the scratch allocated since a mark (end of a binding call)
+ */
+static void arena_release(Arena* arena, ArenaMark mark) {
+    // Blocks retired since the mark hold only this call's scratch, except
+    // the block current at the mark, which may still hold the caller's
+    while (arena->retired != mark.retired) {
+        ArenaBlock* next = arena->retired->next;
+        if (arena->retired != mark.block) {
+            free(arena->retired);
+        }
+        arena->retired = next;
     }
 
-    // Excluded muscles check
-    if ((ex->primary_muscles_mask & req->excluded_muscles_mask) != 0) {
-        return 0;
+    if (arena->block == mark.block) {
+        if (arena->block) {
+            arena->block->used = mark.used;
+        }
+        return;
     }
 
-    // Check activations for excluded muscles (> 40%)
-    for (int32_t i = 0; i < MAX_MUSCLES; i++) {
-        if ((req->excluded_muscles_mask & (1 << i)) && ex->activations[i] > 40.0f) {
-            return 0;
+    // Grown since the mark: keep the larger block, empty
+    arena->block->used = 0;
+    if (mark.used > 0) {
+        mark.block->next = arena->retired;
+        arena->retired = mark.block;
+    } else {
+        free(mark.block);
+    }
+}
+
+#define ARENA_ARRAY(arena, type, count) ((type*)arena_alloc((arena), sizeof(type) * (size_t)(count)))
+
+// ============ Profiling ============
+
+// Recorded series: phase durations (ns) then per-solve counts
+enum ProfileSeries {
+    PROFILE_MARSHAL = 0,                 // N-API request decoding and result building
+    PROFILE_FILTER,                      // Hard filtering (filter_candidates)
+    PROFILE_SCORE,                       // Base scoring (score_candidates)
+    PROFILE_SELECT,                      // Greedy selection and optional optimization
+    PROFILE_CANDIDATES,                  // Candidates passing the filters
+    PROFILE_ROUNDS,                      // Greedy selection rounds executed
+    PROFILE_SELECTED,                    // Exercises selected
+    PROFILE_SERIES_COUNT
+};
+
+#ifdef SOLVER_PROFILE
+
+#define PROFILE_BUCKETS 64               // log2 buckets: bucket b holds values in [2^(b-1), 2^b)
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum;
+    _Atomic uint64_t histogram[PROFILE_BUCKETS];
+} ProfileCounter;
+
+/**
+ * Per-thread counters
+ * Only the owning thread writes (relaxed load + store, no RMW); readers
+ * aggregate every registered thread. A thread's counts are folded into
+ * g_profile_retired when it exits.
+ */
+typedef struct ThreadProfile {
+    struct ThreadProfile* next;
+    struct ThreadProfile* prev;
+    ProfileCounter series[PROFILE_SERIES_COUNT];
+} ThreadProfile;
+
+static _Thread_local ThreadProfile* t_profile;
+static ThreadProfile* g_profiles;
+static ThreadProfile g_profile_retired;
+static pthread_mutex_t g_profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t g_profile_key;
+static pthread_once_t g_profile_key_once = PTHREAD_ONCE_INIT;
+
+static inline void profile_bump(_Atomic uint64_t* counter, uint64_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+/**
+ * Fold an exiting thread's counts into the retired totals
+ */
+static void profile_thread_exit(void* data) {
+    ThreadProfile* profile = data;
+
+    pthread_mutex_lock(&g_profile_lock);
+    for (int32_t s = 0; s < PROFILE_SERIES_COUNT; s++) {
+        ProfileCounter* from = &profile->series[s];
+        ProfileCounter* to = &g_profile_retired.series[s];
+        profile_bump(&to->count, atomic_load(&from->count));
+        profile_bump(&to->sum, atomic_load(&from->sum));
+        for (int32_t b = 0; b < PROFILE_BUCKETS; b++) {
+            profile_bump(&to->histogram[b], atomic_load(&from->histogram[b]));
         }
     }
+    if (profile->prev) profile->prev->next = profile->next;
+    else g_profiles = profile->next;
+    if (profile->next) profile->next->prev = profile->prev;
+    pthread_mutex_unlock(&g_profile_lock);
 
-    return 1;
+    free(profile);
+}
+
+static void profile_key_create(void) {
+    pthread_key_create(&g_profile_key, profile_thread_exit);
 }
 
 /**
- * Score a single exercise
- * Hot path - optimized for speed
+ * Get (registering on first use) the calling thread's counters
  */
-static inline float __attribute__((hot))
-score_exercise(
-    const Exercise* ex,
-    const SolverRequest* req,
-    int32_t current_coverage_mask
-) {
-    float score = 0.0f;
-
-    // Goal alignment
-    if (req->goals_mask != 0) {
-        for (int32_t goal = 0; goal < 5; goal++) {
-            if (req->goals_mask & (1 << goal)) {
-                // Check preferred patterns
-                if (GOAL_PREFERRED_PATTERNS[goal] & (1 << ex->movement_pattern)) {
-                    score += req->weights.goal_alignment;
-                }
-                // Compound preference
-                if (GOAL_PREFER_COMPOUND[goal] && ex->is_compound) {
-                    score += req->weights.goal_alignment * 0.5f;
-                }
+static ThreadProfile* thread_profile(void) {
+    if (!t_profile) {
+        ThreadProfile* profile = calloc(1, sizeof(ThreadProfile));
+        if (!profile) return NULL;
+
+        pthread_once(&g_profile_key_once, profile_key_create);
+        pthread_setspecific(g_profile_key, profile);
+
+        pthread_mutex_lock(&g_profile_lock);
+        profile->next = g_profiles;
+        if (g_profiles) g_profiles->prev = profile;
+        g_profiles = profile;
+        pthread_mutex_unlock(&g_profile_lock);
+
+        t_profile = profile;
+    }
+    return t_profile;
+}
+
+static inline uint64_t profile_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Record one value in a series
+ */
+static void profile_record(int32_t series, uint64_t value) {
+    ThreadProfile* profile = thread_profile();
+    if (!profile) return;
+
+    ProfileCounter* counter = &profile->series[series];
+    int32_t bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    if (bucket >= PROFILE_BUCKETS) bucket = PROFILE_BUCKETS - 1;
+
+    profile_bump(&counter->count, 1);
+    profile_bump(&counter->sum, value);
+    profile_bump(&counter->histogram[bucket], 1);
+}
+
+#define PROFILE_BEGIN(name) uint64_t profile_start_##name = profile_now_ns()
+#define PROFILE_END(name, series) profile_record((series), profile_now_ns() - profile_start_##name)
+#define PROFILE_VALUE(series, value) profile_record((series), (uint64_t)(value))
+
+#else
+
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END(name, series) ((void)0)
+#define PROFILE_VALUE(series, value) ((void)0)
+
+#endif // SOLVER_PROFILE
+
+// ============ Catalog ============
+
+/**
+ * Allocate an empty catalog sized for exercise_count exercises
+ * Exercises, scoring columns, bitset rows and the ID table share one
+ * allocation; each column starts on a cache line
+ */
+static Catalog* catalog_create(int32_t exercise_count) {
+    int32_t words = (exercise_count + 63) / 64;
+    uint32_t table_size = 64;
+    uint32_t table_bits = 6;
+    while (table_size < 2 * (uint32_t)exercise_count) {
+        table_size <<= 1;
+        table_bits++;
+    }
+
+    size_t header = (sizeof(Catalog) + 63) & ~(size_t)63;
+    size_t exercises = ((size_t)exercise_count * sizeof(Exercise) + 63) & ~(size_t)63;
+    size_t column = ((size_t)exercise_count * sizeof(int32_t) + 63) & ~(size_t)63;
+    size_t wide_column = ((size_t)exercise_count * sizeof(uint64_t) + 63) & ~(size_t)63;
+    size_t columns = 4 * column + 2 * wide_column;
+    size_t bits = (size_t)(MAX_LOCATIONS + MAX_EQUIPMENT) * (size_t)words * sizeof(uint64_t);
+    size_t table = (size_t)table_size * sizeof(int32_t);
+
+    uint8_t* mem = aligned_alloc(64, (header + exercises + columns + bits + table + 63) & ~(size_t)63);
+    if (!mem) return NULL;
+    memset(mem, 0, header + exercises + columns + bits + table);
+
+    Catalog* cat = (Catalog*)mem;
+    cat->words = words;
+    cat->exercises = (Exercise*)(mem + header);
+
+    uint8_t* col = mem + header + exercises;
+    cat->difficulty = (int32_t*)col;
+    cat->movement_pattern = (int32_t*)(col + column);
+    cat->is_compound = (int32_t*)(col + 2 * column);
+    cat->exclusion_muscles_mask = (int32_t*)(col + 3 * column);
+    cat->active_muscles_mask = (uint64_t*)(col + 4 * column);
+    cat->worked_muscles_mask = (uint64_t*)(col + 4 * column + wide_column);
+
+    cat->location_bits = (uint64_t*)(col + columns);
+    cat->equipment_bits = cat->location_bits + (size_t)MAX_LOCATIONS * (size_t)words;
+    cat->id_table = (int32_t*)(col + columns + bits);
+    cat->id_table_mask = table_size - 1;
+    cat->id_table_shift = 32 - table_bits;
+    return cat;
+}
+
+/**
+ * Slot for an exercise ID in the catalog's ID table
+ * Same Fibonacci hash as catalog files (catalog_id_slot), so a mapped
+ * file's table is used directly
+ */
+static inline uint32_t id_table_hash(const Catalog* cat, int32_t id) {
+    return ((uint32_t)id * 0x9E3779B1u) >> cat->id_table_shift;
+}
+
+/**
+ * Catalog over a mapped binary catalog file
+ * Only the Catalog header is allocated; every column, bitset row and the
+ * ID table point into the read-only mapping, which the catalog owns.
+ * Returns NULL with *error set to a CATALOG_ERR_* code on failure
+ */
+static Catalog* catalog_from_file(const char* path, int* error) {
+    CatalogFile file;
+    *error = catalog_file_open(path, &file);
+    if (*error != 0) return NULL;
+
+    // Masks must cover the muscles the scorer reads
+    const CatalogFileHeader* h = file.header;
+    if (h->mask_muscles != MAX_MUSCLES || h->exercise_count > MAX_CATALOG_EXERCISES) {
+        catalog_file_close(&file);
+        *error = CATALOG_ERR_VERSION;
+        return NULL;
+    }
+
+    size_t header = (sizeof(Catalog) + 63) & ~(size_t)63;
+    Catalog* cat = aligned_alloc(64, header);
+    if (!cat) {
+        catalog_file_close(&file);
+        *error = CATALOG_ERR_OPEN;
+        return NULL;
+    }
+    memset(cat, 0, sizeof(Catalog));
+
+    cat->exercise_count = (int32_t)h->exercise_count;
+    cat->words = (int32_t)h->bitset_words;
+    cat->exercises = (Exercise*)catalog_section(&file, CATALOG_SECTION_EXERCISES);
+    cat->difficulty = (int32_t*)catalog_section(&file, CATALOG_SECTION_DIFFICULTY);
+    cat->movement_pattern = (int32_t*)catalog_section(&file, CATALOG_SECTION_MOVEMENT_PATTERN);
+    cat->is_compound = (int32_t*)catalog_section(&file, CATALOG_SECTION_IS_COMPOUND);
+    cat->exclusion_muscles_mask = (int32_t*)catalog_section(&file, CATALOG_SECTION_EXCLUSION_MASK);
+    cat->active_muscles_mask = (uint64_t*)catalog_section(&file, CATALOG_SECTION_ACTIVE_MASK);
+    cat->worked_muscles_mask = (uint64_t*)catalog_section(&file, CATALOG_SECTION_WORKED_MASK);
+    cat->location_bits = (uint64_t*)catalog_section(&file, CATALOG_SECTION_LOCATION_BITS);
+    cat->equipment_bits = (uint64_t*)catalog_section(&file, CATALOG_SECTION_EQUIPMENT_BITS);
+    cat->equipment_used_mask = h->equipment_used_mask;
+    cat->id_table = (int32_t*)catalog_section(&file, CATALOG_SECTION_ID_TABLE);
+    cat->id_table_mask = h->id_table_size - 1;
+    cat->id_table_shift = 32 - catalog_table_bits(h->id_table_size);
+
+    const int32_t* recovery = catalog_section(&file, CATALOG_SECTION_MUSCLE_RECOVERY);
+    for (int32_t m = 0; m < MASK_MUSCLES; m++) {
+        cat->muscle_recovery_hours[m] = m < (int32_t)h->muscle_count ? recovery[m] : DEFAULT_RECOVERY_HOURS;
+    }
+
+    cat->file = file;
+    return cat;
+}
+
+/**
+ * Derive an exercise's muscle masks from its activation percentages
+ * Activations are only needed here; the catalog keeps the masks
+ */
+static void set_exercise_muscles(Catalog* cat, int32_t i, const float* activations) {
+    // Muscles that exclude this exercise: primary, or activated > 40%
+    uint32_t exclusion = (uint32_t)cat->exercises[i].primary_muscles_mask;
+    uint64_t worked = exclusion;
+    uint64_t active = 0;
+    for (int32_t m = 0; m < MAX_MUSCLES; m++) {
+        if (activations[m] > 40.0f) {
+            worked |= 1ULL << m;
+        }
+        if (activations[m] > 0.0f) {
+            active |= 1ULL << m;
+        }
+    }
+    cat->exclusion_muscles_mask[i] = (int32_t)(exclusion | (uint32_t)worked);
+    cat->active_muscles_mask[i] = active;
+    cat->worked_muscles_mask[i] = worked;
+}
+
+/**
+ * Build the candidate index for a catalog
+ * Precomputes per-location and per-equipment bitsets so request filtering
+ * is word-wise bit arithmetic
+ */
+static void build_candidate_index(Catalog* cat) {
+    cat->equipment_used_mask = 0;
+
+    for (int32_t i = 0; i < cat->exercise_count; i++) {
+        Exercise* ex = &cat->exercises[i];
+        uint64_t bit = 1ULL << (i % 64);
+        int32_t word = i / 64;
+
+        for (int32_t loc = 0; loc < MAX_LOCATIONS; loc++) {
+            if ((uint32_t)ex->locations_mask & (1U << loc)) {
+                cat->location_bits[(size_t)loc * cat->words + word] |= bit;
+            }
+        }
+
+        for (int32_t eq = 0; eq < MAX_EQUIPMENT; eq++) {
+            if ((uint32_t)ex->equipment_required_mask & (1U << eq)) {
+                cat->equipment_bits[(size_t)eq * cat->words + word] |= bit;
             }
         }
+        cat->equipment_used_mask |= ex->equipment_required_mask;
+
+        // ID lookup (hashed ids may repeat; each copy gets its own slot)
+        uint32_t slot = id_table_hash(cat, ex->id);
+        while (cat->id_table[slot] != 0) {
+            slot = (slot + 1) & cat->id_table_mask;
+        }
+        cat->id_table[slot] = i + 1;
+    }
+}
+
+/**
+ * Set the bits of every catalog index whose exercise has the given ID
+ */
+static BINDING_HELPER void exclude_exercise_id(const Catalog* cat, int32_t id, uint64_t* excluded) {
+    for (uint32_t slot = id_table_hash(cat, id); cat->id_table[slot] != 0;
+         slot = (slot + 1) & cat->id_table_mask) {
+        int32_t idx = cat->id_table[slot] - 1;
+        if (cat->exercises[idx].id == id) {
+            excluded[idx / 64] |= 1ULL << (idx % 64);
+        }
+    }
+}
+
+/**
+ * Check the per-request exclusions for a candidate
+ * Location, equipment and excluded exercises are already resolved as bitsets
+ * Returns 1 if valid, 0 if filtered out
+ */
+static inline int32_t __attribute__((hot))
+passes_request_exclusions(const Catalog* cat, int32_t idx, const SolverRequest* req) {
+    // Excluded muscles check (primary or heavily activated)
+    if ((cat->exclusion_muscles_mask[idx] & req->excluded_muscles_mask) != 0) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Collect exercises passing all hard filters
+ * Location, equipment and exercise exclusions are word-wise ANDs over bitsets
+ * Returns number of indices written to out_indices
+ */
+static int32_t __attribute__((hot))
+filter_candidates(const Catalog* cat, const SolverRequest* req, int32_t* out_indices) {
+    if (req->location < 0 || req->location >= MAX_LOCATIONS) {
+        return 0;
     }
 
-    // Compound preference (time efficient)
-    if (ex->is_compound) {
-        score += req->weights.compound_preference;
+    // Equipment check (skip for gym location)
+    uint32_t missing_equipment = 0;
+    if (req->location != 0) { // Not gym
+        missing_equipment = (uint32_t)cat->equipment_used_mask & ~(uint32_t)req->equipment_mask;
     }
 
-    // Recovery penalties - check activated muscles
-    for (int32_t i = 0; i < MAX_MUSCLES; i++) {
-        if (ex->activations[i] > 0.0f) {
-            if (req->recent_24h_muscles_mask & (1 << i)) {
-                score += req->weights.recovery_penalty_24h;
-            } else if (req->recent_48h_muscles_mask & (1 << i)) {
-                score += req->weights.recovery_penalty_48h;
+    int32_t words = cat->words;
+    const uint64_t* location_bits = cat->location_bits + (size_t)req->location * words;
+    int32_t count = 0;
+
+    for (int32_t w = 0; w < words; w++) {
+        uint64_t bits = location_bits[w];
+
+        for (uint32_t eq = missing_equipment; eq != 0 && bits != 0; eq &= eq - 1) {
+            bits &= ~cat->equipment_bits[(size_t)__builtin_ctz(eq) * words + w];
+        }
+        if (req->excluded_exercises) {
+            bits &= ~req->excluded_exercises[w];
+        }
+
+        while (bits != 0) {
+            int32_t idx = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (passes_request_exclusions(cat, idx, req)) {
+                out_indices[count++] = idx;
             }
         }
     }
 
-    // Fitness level match
-    if (req->fitness_level >= 0 && req->fitness_level <= 2) {
-        int32_t min_diff = DIFFICULTY_MIN[req->fitness_level];
-        int32_t max_diff = DIFFICULTY_MAX[req->fitness_level];
-        if (ex->difficulty >= min_diff && ex->difficulty <= max_diff) {
-            score += req->weights.fitness_level_match;
+    return count;
+}
+
+/**
+ * Resolve a request's goals and fitness level into flat scoring terms
+ */
+static void static_terms(const SolverRequest* req, StaticTerms* terms) {
+    memset(terms, 0, sizeof(StaticTerms));
+    terms->compound_bonus = req->weights.compound_preference;
+
+    for (int32_t goal = 0; goal < 5; goal++) {
+        if (!(req->goals_mask & (1 << goal))) continue;
+        for (int32_t pattern = 0; pattern < PATTERN_SLOTS; pattern++) {
+            if (GOAL_PREFERRED_PATTERNS[goal] & (1 << pattern)) {
+                terms->pattern_bonus[pattern] += req->weights.goal_alignment;
+            }
         }
-        // Penalty for too hard
-        if (ex->difficulty > max_diff) {
-            score -= (float)(ex->difficulty - max_diff) * 5.0f;
+        if (GOAL_PREFER_COMPOUND[goal]) {
+            terms->compound_bonus += req->weights.goal_alignment * 0.5f;
         }
     }
 
-    // Muscle coverage gap - prioritize uncovered muscles
-    for (int32_t i = 0; i < MAX_MUSCLES; i++) {
-        if (ex->activations[i] > 0.0f && !(current_coverage_mask & (1 << i))) {
-            score += req->weights.muscle_coverage_gap;
-        }
+    if (req->fitness_level >= 0 && req->fitness_level <= 2) {
+        terms->min_difficulty = DIFFICULTY_MIN[req->fitness_level];
+        terms->max_difficulty = DIFFICULTY_MAX[req->fitness_level];
+        terms->level_match = req->weights.fitness_level_match;
+        terms->overreach_penalty = 5.0f;
+    } else {
+        // No match and no penalty
+        terms->min_difficulty = 1;
+        terms->max_difficulty = 0;
     }
+}
 
+/**
+ * Static part of an exercise's score (goals, compound, fitness level)
+ * Independent of session history, so it can be shared across sessions.
+ * The one definition of the sum: the kernel below and one-off scores
+ * (ScoreBatch) both add the terms in this order, so they agree exactly
+ * for any weights, fractional ones included.
+ */
+static inline __attribute__((always_inline)) float
+static_score(const StaticTerms* terms, int32_t pattern, int32_t is_compound, int32_t difficulty) {
+    // Table lookup (a gather), with out-of-range patterns on the zero slot
+    uint32_t slot = (uint32_t)pattern;
+    slot = slot < PATTERN_SLOTS ? slot : PATTERN_SLOTS;
+    float score = terms->pattern_bonus[slot];
+
+    score += (float)is_compound * terms->compound_bonus;
+
+    // Comparisons as 0/1 factors keep the loop free of control flow
+    int32_t in_range = (difficulty >= terms->min_difficulty) & (difficulty <= terms->max_difficulty);
+    score += (float)in_range * terms->level_match;
+    int32_t overreach = difficulty - terms->max_difficulty;
+    overreach = overreach > 0 ? overreach : 0;
+    score -= (float)overreach * terms->overreach_penalty;
     return score;
 }
 
 /**
- * Comparison function for sorting scored exercises (descending)
+ * Vectorized static scores for catalog indices [begin, end)
+ *
+ * Branch-free over the structure-of-arrays columns so the loop compiles
+ * to 8 (AVX2) or 16 (AVX-512) exercises per iteration. Compiled once per
+ * ISA and picked at load time by native_isa_select(), so
+ * MUSCLEMAP_NATIVE_ISA narrows it like the native libraries' kernels.
+ */
+static inline __attribute__((always_inline)) void score_static_body(
+    const Catalog* cat,
+    const StaticTerms* terms,
+    int32_t begin,
+    int32_t end,
+    float* restrict out
+) {
+    const int32_t* restrict difficulty = cat->difficulty;
+    const int32_t* restrict movement_pattern = cat->movement_pattern;
+    const int32_t* restrict is_compound = cat->is_compound;
+    const StaticTerms local = *terms;
+
+    for (int32_t i = begin; i < end; i++) {
+        out[i - begin] = static_score(&local, movement_pattern[i], is_compound[i], difficulty[i]);
+    }
+}
+
+static void score_static_baseline(const Catalog* cat, const StaticTerms* terms, int32_t begin, int32_t end,
+                                  float* restrict out) {
+    score_static_body(cat, terms, begin, end, out);
+}
+
+#if NATIVE_DISPATCH_X86
+NATIVE_TARGET_AVX2
+static void score_static_avx2(const Catalog* cat, const StaticTerms* terms, int32_t begin, int32_t end,
+                              float* restrict out) {
+    score_static_body(cat, terms, begin, end, out);
+}
+
+NATIVE_TARGET_AVX512
+static void score_static_avx512(const Catalog* cat, const StaticTerms* terms, int32_t begin, int32_t end,
+                                float* restrict out) {
+    score_static_body(cat, terms, begin, end, out);
+}
+#endif
+
+typedef void (*ScoreStaticFn)(const Catalog*, const StaticTerms*, int32_t, int32_t, float* restrict);
+
+static ScoreStaticFn score_static_kernel = score_static_baseline;
+
+/**
+ * Pick the widest kernel variant for this CPU at load time
+ */
+__attribute__((constructor))
+static void solver_select_kernels(void) {
+#if NATIVE_DISPATCH_X86
+    NativeIsa isa = native_isa_select();
+    if (isa == NATIVE_ISA_AVX512) {
+        score_static_kernel = score_static_avx512;
+    } else if (isa == NATIVE_ISA_AVX2) {
+        score_static_kernel = score_static_avx2;
+    }
+#endif
+}
+
+/**
+ * Recovery penalties - activated muscles against recent history
+ * Recent-work masks are 32-bit, so only muscles below MASK_MUSCLES can match
+ */
+static inline float __attribute__((hot))
+score_recovery(uint64_t active_mask, const SolverRequest* req) {
+    uint32_t active = (uint32_t)active_mask;
+    uint32_t recent_24h = (uint32_t)req->recent_24h_muscles_mask;
+    uint32_t recent_48h = (uint32_t)req->recent_48h_muscles_mask & ~recent_24h;
+
+    return req->weights.recovery_penalty_24h * (float)__builtin_popcount(active & recent_24h) +
+           req->weights.recovery_penalty_48h * (float)__builtin_popcount(active & recent_48h);
+}
+
+/**
+ * Muscle coverage gap - prioritize uncovered muscles
+ */
+static inline float __attribute__((hot))
+score_coverage(uint64_t active_mask, const SolverRequest* req, uint64_t current_coverage_mask) {
+    uint64_t uncovered = active_mask & ~current_coverage_mask;
+    return req->weights.muscle_coverage_gap * (float)__builtin_popcountll(uncovered);
+}
+
+/**
+ * Score a single exercise; terms come from static_terms(req)
+ * Sums as solve does: static, then recovery, then coverage
+ */
+static inline float __attribute__((hot))
+score_exercise(
+    const Catalog* cat,
+    int32_t idx,
+    const SolverRequest* req,
+    const StaticTerms* terms,
+    uint64_t current_coverage_mask
+) {
+    uint64_t active = cat->active_muscles_mask[idx];
+    float score = static_score(terms, cat->movement_pattern[idx], cat->is_compound[idx], cat->difficulty[idx]);
+    return score + score_recovery(active, req) + score_coverage(active, req, current_coverage_mask);
+}
+
+/**
+ * SplitMix64 finalizer (seeded variety noise)
+ */
+static inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Seeded variety noise in [0, req->variety) for an exercise
+ * Keyed by exercise ID, so a seed gives the same plan across catalog reloads
+ */
+static inline float variety_noise(const Catalog* cat, int32_t idx, const SolverRequest* req) {
+    uint64_t h = splitmix64(((uint64_t)req->seed << 32) | (uint32_t)cat->exercises[idx].id);
+    return (float)(h >> 40) * (1.0f / 16777216.0f) * req->variety;
+}
+
+/**
+ * Base scores (static + recovery) for a filtered candidate list
+ * Static terms come from the vectorized kernel over the catalog span the
+ * candidates cover; static_scores receives them when non-NULL. Seeded
+ * requests add their variety noise to the static part
+ * Returns 0 if scratch could not be allocated
  */
-static int compare_scores(const void* a, const void* b) {
-    float diff = ((ScoredExercise*)b)->score - ((ScoredExercise*)a)->score;
-    return (diff > 0.0f) ? 1 : (diff < 0.0f) ? -1 : 0;
+static int32_t score_candidates(
+    const Catalog* cat,
+    const SolverRequest* req,
+    const int32_t* valid_indices,
+    int32_t valid_count,
+    float* static_scores,
+    float* base_scores
+) {
+    int32_t first = valid_indices[0];
+    int32_t last = valid_indices[valid_count - 1];
+
+    float* span = ARENA_ARRAY(thread_arena(), float, last - first + 1);
+    if (!span) {
+        return 0;
+    }
+
+    StaticTerms terms;
+    static_terms(req, &terms);
+    score_static_kernel(cat, &terms, first, last + 1, span);
+
+    for (int32_t p = 0; p < valid_count; p++) {
+        int32_t idx = valid_indices[p];
+        float static_score = span[idx - first];
+        if (req->seed != 0) static_score += variety_noise(cat, idx, req);
+        if (static_scores) static_scores[p] = static_score;
+        base_scores[p] = static_score + score_recovery(cat->active_muscles_mask[idx], req);
+    }
+    return 1;
+}
+
+/**
+ * Selection order: higher score first, ties to the lower catalog index
+ * Equal scores are common (scores are sums of a few weights), so the tie
+ * order decides plans and must not depend on how candidates are gathered
+ */
+static inline bool scored_before(const ScoredExercise* a, const ScoredExercise* b) {
+    return a->score > b->score || (a->score == b->score && a->exercise < b->exercise);
+}
+
+/**
+ * Restore the max-heap property below slot i
+ */
+static inline void scored_sift_down(ScoredExercise* heap, int32_t count, int32_t i) {
+    ScoredExercise item = heap[i];
+    for (;;) {
+        int32_t child = 2 * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && scored_before(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!scored_before(&heap[child], &item)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = item;
+}
+
+/**
+ * Arrange scored candidates as a max-heap in selection order (O(n))
+ */
+static void scored_heapify(ScoredExercise* heap, int32_t count) {
+    for (int32_t i = count / 2 - 1; i >= 0; i--) {
+        scored_sift_down(heap, count, i);
+    }
+}
+
+/**
+ * Remove and return the next candidate in selection order
+ */
+static inline ScoredExercise scored_pop(ScoredExercise* heap, int32_t* count) {
+    ScoredExercise top = heap[0];
+    heap[0] = heap[--*count];
+    scored_sift_down(heap, *count, 0);
+    return top;
 }
 
 /**
@@ -238,129 +1031,1736 @@ static inline int32_t estimate_time(const Exercise* ex, int32_t sets, int32_t re
 }
 
 /**
- * Main solver function
- * Returns indices of selected exercises
+ * Time an exercise adds when performed inside a superset/circuit
+ * Members alternate set by set: the group rests once per round (its
+ * longest member rest), so a member costs a short transition per set plus
+ * only the rest it adds beyond the group's current rest
+ */
+static inline int32_t grouped_time(
+    const Exercise* ex,
+    int32_t sets,
+    int32_t reps,
+    float rest_multiplier,
+    int32_t group_rest
+) {
+    int32_t rest_time = (int32_t)(ex->rest_seconds * rest_multiplier);
+    int32_t extra_rest = rest_time > group_rest ? rest_time - group_rest : 0;
+    return estimate_time(ex, sets, reps, rest_multiplier) - ((sets - 1) * rest_time) +
+           (sets * GROUP_TRANSITION_SECONDS) + ((sets - 1) * extra_rest);
+}
+
+/**
+ * Cheapest open group an exercise can join (its worked muscles disjoint
+ * from every member's), or -1 if straight sets are no more expensive
+ * time_needed holds the straight-set time on entry, the chosen time on return
+ */
+static int32_t join_group(
+    const SessionGroup* groups,
+    int32_t group_count,
+    int32_t max_group_size,
+    const Exercise* ex,
+    uint64_t worked_mask,
+    const SessionParams* params,
+    int32_t* time_needed
+) {
+    int32_t best = -1;
+    for (int32_t g = 0; g < group_count; g++) {
+        if (groups[g].size >= max_group_size || (groups[g].worked_mask & worked_mask) != 0) {
+            continue;
+        }
+        int32_t time = grouped_time(ex, params->sets, params->reps, params->rest_multiplier, groups[g].rest);
+        if (time < *time_needed) {
+            *time_needed = time;
+            best = g;
+        }
+    }
+    return best;
+}
+
+/**
+ * Derive time budget and prescription from the request's goals
+ */
+static void session_params(const SolverRequest* req, SessionParams* params) {
+    // Calculate time budget
+    int32_t warmup_cooldown = (req->time_available_seconds >= 1800) ? 300 : 120;
+    params->time_budget = req->time_available_seconds - warmup_cooldown;
+
+    // Rest multiplier from goals
+    params->rest_multiplier = 1.0f;
+    if (req->goals_mask & (1 << GOAL_STRENGTH)) params->rest_multiplier = 1.5f;
+    else if (req->goals_mask & (1 << GOAL_ENDURANCE)) params->rest_multiplier = 0.5f;
+    else if (req->goals_mask & (1 << GOAL_FAT_LOSS)) params->rest_multiplier = 0.6f;
+    else if (req->goals_mask & (1 << GOAL_MOBILITY)) params->rest_multiplier = 0.75f;
+
+    // Sets/reps from goals
+    params->sets = 3;
+    params->reps = 10;
+    if (req->goals_mask & (1 << GOAL_STRENGTH)) { params->sets = 5; params->reps = 4; }
+    else if (req->goals_mask & (1 << GOAL_HYPERTROPHY)) { params->sets = 4; params->reps = 10; }
+    else if (req->goals_mask & (1 << GOAL_ENDURANCE)) { params->sets = 2; params->reps = 20; }
+    else if (req->goals_mask & (1 << GOAL_FAT_LOSS)) { params->sets = 3; params->reps = 14; }
+}
+
+/**
+ * Xorshift32 PRNG for local search moves
+ */
+static inline uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * Monotonic clock in microseconds
+ */
+static inline uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * Movement pattern slot for balancing, or -1 for patterns outside the table
+ */
+static inline int32_t pattern_slot(const Catalog* cat, int32_t idx) {
+    int32_t pattern = cat->movement_pattern[idx];
+    return (uint32_t)pattern < PATTERN_SLOTS ? pattern : -1;
+}
+
+/**
+ * Whether a request constrains movement patterns at all
+ */
+static inline bool has_pattern_constraints(const SolverRequest* req) {
+    if (req->max_antagonist_imbalance > 0) return true;
+    for (int32_t pattern = 0; pattern < PATTERN_SLOTS; pattern++) {
+        if (req->pattern_quota[pattern] > 0) return true;
+    }
+    return false;
+}
+
+/**
+ * Check a candidate pattern against the session's counts so far
+ * Quotas are hard; a candidate that would push an antagonist pair past
+ * the allowed imbalance is deferred (used only if nothing else fits)
+ */
+static inline int32_t pattern_admission(const SolverRequest* req, const int32_t* counts, int32_t pattern) {
+    if (pattern < 0) {
+        return PATTERN_ADMIT;
+    }
+
+    int32_t quota = req->pattern_quota[pattern];
+    if (quota > 0 && counts[pattern] >= quota) {
+        return PATTERN_REJECT;
+    }
+
+    int32_t antagonist = PATTERN_ANTAGONIST[pattern];
+    if (req->max_antagonist_imbalance > 0 && antagonist >= 0 &&
+        counts[pattern] - counts[antagonist] >= req->max_antagonist_imbalance) {
+        return PATTERN_DEFER;
+    }
+    return PATTERN_ADMIT;
+}
+
+/**
+ * Whether replacing outgoing with incoming (either may be -1) keeps a plan
+ * within its pattern quotas and does not worsen an antagonist imbalance
+ * that already exceeds the limit
+ */
+static bool pattern_move_allowed(const SolverRequest* req, const int32_t* counts, int32_t incoming, int32_t outgoing) {
+    int32_t next[PATTERN_SLOTS];
+    memcpy(next, counts, sizeof(next));
+    if (incoming >= 0) next[incoming]++;
+    if (outgoing >= 0) next[outgoing]--;
+
+    if (incoming >= 0 && req->pattern_quota[incoming] > 0 && next[incoming] > req->pattern_quota[incoming]) {
+        return false;
+    }
+
+    if (req->max_antagonist_imbalance > 0) {
+        for (int32_t pattern = PATTERN_PUSH; pattern <= PATTERN_SQUAT; pattern += 2) {
+            int32_t antagonist = PATTERN_ANTAGONIST[pattern];
+            int32_t before = abs(counts[pattern] - counts[antagonist]);
+            int32_t after = abs(next[pattern] - next[antagonist]);
+            if (after > req->max_antagonist_imbalance && after > before) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Plan objective: base scores plus the coverage bonus for distinct muscles
+ * Matches the sum of the greedy loop's marginal scores for the same exercises
+ */
+static float plan_objective(
+    const int32_t* plan,
+    int32_t plan_len,
+    const float* base_scores,
+    const uint64_t* active_masks,
+    float coverage_weight
+) {
+    float total = 0.0f;
+    uint64_t coverage = 0;
+    for (int32_t i = 0; i < plan_len; i++) {
+        total += base_scores[plan[i]];
+        coverage |= active_masks[plan[i]];
+    }
+    return total + coverage_weight * (float)__builtin_popcountll(coverage);
+}
+
+/**
+ * Anytime plan optimization (simulated annealing over add/swap/drop moves)
+ *
+ * Starts from the greedy plan and searches for a higher plan_objective
+ * subject to the time budget until req->optimize_deadline_us elapses.
+ * The best plan found so far is written back to plan/plan_len, so result
+ * quality scales with the latency budget the caller grants.
+ *
+ * A seeded request seeds the move sequence from req->seed, so the same
+ * seed replays the same moves. The search is still cut off by the clock:
+ * a repeat call reproduces the plan only if it reaches the same iteration
+ * count before the deadline (e.g. the optimum is found early).
+ *
+ * plan holds positions into valid_indices; positions flagged in skip are
+ * never added.
+ */
+static void optimize_plan(
+    const Catalog* cat,
+    const SolverRequest* req,
+    const int32_t* valid_indices,
+    int32_t valid_count,
+    const float* base_scores,
+    const int32_t* times,
+    const uint8_t* skip,
+    int32_t time_budget,
+    int32_t max_results,
+    int32_t* plan,
+    int32_t* plan_len
+) {
+    if (valid_count == 0 || max_results <= 0) {
+        return;
+    }
+
+    uint64_t start = now_us();
+    uint64_t deadline = start + (uint64_t)req->optimize_deadline_us;
+
+    Arena* arena = thread_arena();
+    uint64_t* active_masks = ARENA_ARRAY(arena, uint64_t, valid_count);
+    uint8_t* in_plan = ARENA_ARRAY(arena, uint8_t, valid_count);
+    int32_t* current = ARENA_ARRAY(arena, int32_t, valid_count);
+    if (!active_masks || !in_plan || !current) {
+        return; // Keep the greedy plan
+    }
+
+    for (int32_t p = 0; p < valid_count; p++) {
+        active_masks[p] = cat->active_muscles_mask[valid_indices[p]];
+        in_plan[p] = skip ? skip[p] : 0;
+    }
+
+    const float coverage_weight = req->weights.muscle_coverage_gap;
+    const bool constrained = has_pattern_constraints(req);
+
+    int32_t current_len = *plan_len;
+    int32_t current_time = 0;
+    int32_t pattern_counts[PATTERN_SLOTS] = {0};
+    for (int32_t i = 0; i < current_len; i++) {
+        current[i] = plan[i];
+        in_plan[plan[i]] = 1;
+        current_time += times[plan[i]];
+
+        int32_t pattern = pattern_slot(cat, valid_indices[plan[i]]);
+        if (pattern >= 0) pattern_counts[pattern]++;
+    }
+    float current_obj = plan_objective(current, current_len, base_scores, active_masks, coverage_weight);
+    float best_obj = current_obj;
+
+    // Temperature on the scale of a single goal match, cooled linearly to zero
+    const float initial_temp = fabsf(req->weights.goal_alignment) + 1.0f;
+    float temp = initial_temp;
+    uint32_t rng = req->seed != 0 ? (uint32_t)splitmix64(req->seed) : 0x9E3779B9u ^ (uint32_t)start;
+    if (rng == 0) rng = 0x9E3779B9u;  // xorshift32 state must be non-zero
+
+    for (uint32_t iter = 0; ; iter++) {
+        if ((iter & 63) == 0) {
+            uint64_t now = now_us();
+            if (now >= deadline) break;
+            float elapsed = (float)(now - start) / (float)req->optimize_deadline_us;
+            temp = initial_temp * (1.0f - elapsed) + 1e-3f;
+        }
+
+        int32_t move = (int32_t)(xorshift32(&rng) % 3);
+        int32_t slot = -1;
+        int32_t incoming = -1;
+
+        // Random candidate not in the plan (bounded retries)
+        if (move != 2) {
+            for (int32_t tries = 0; tries < 4; tries++) {
+                int32_t p = (int32_t)(xorshift32(&rng) % (uint32_t)valid_count);
+                if (!in_plan[p]) {
+                    incoming = p;
+                    break;
+                }
+            }
+            if (incoming < 0) continue;
+        }
+
+        int32_t new_time = current_time;
+        if (move == 0) {
+            // Add
+            if (current_len >= max_results) continue;
+            new_time += times[incoming];
+        } else {
+            // Swap or drop
+            if (current_len == 0 || (move == 2 && current_len == 1)) continue;
+            slot = (int32_t)(xorshift32(&rng) % (uint32_t)current_len);
+            new_time -= times[current[slot]];
+            if (move == 1) new_time += times[incoming];
+        }
+        if (new_time > time_budget) continue;
+
+        int32_t incoming_pattern = incoming >= 0 ? pattern_slot(cat, valid_indices[incoming]) : -1;
+        int32_t outgoing_pattern = move != 0 ? pattern_slot(cat, valid_indices[current[slot]]) : -1;
+        if (constrained && !pattern_move_allowed(req, pattern_counts, incoming_pattern, outgoing_pattern)) {
+            continue;
+        }
+
+        // Apply tentatively
+        int32_t outgoing = -1;
+        if (move == 0) {
+            current[current_len++] = incoming;
+        } else if (move == 1) {
+            outgoing = current[slot];
+            current[slot] = incoming;
+        } else {
+            outgoing = current[slot];
+            current[slot] = current[--current_len];
+        }
+
+        float new_obj = plan_objective(current, current_len, base_scores, active_masks, coverage_weight);
+        float delta = new_obj - current_obj;
+        float threshold = (float)(xorshift32(&rng) >> 8) * (1.0f / 16777216.0f);
+
+        if (delta >= 0.0f || threshold < expf(delta / temp)) {
+            if (incoming >= 0) in_plan[incoming] = 1;
+            if (outgoing >= 0) in_plan[outgoing] = 0;
+            if (incoming_pattern >= 0) pattern_counts[incoming_pattern]++;
+            if (outgoing_pattern >= 0) pattern_counts[outgoing_pattern]--;
+            current_obj = new_obj;
+            current_time = new_time;
+
+            if (current_obj > best_obj) {
+                best_obj = current_obj;
+                *plan_len = current_len;
+                memcpy(plan, current, (size_t)current_len * sizeof(int32_t));
+            }
+        } else {
+            // Revert
+            if (move == 0) {
+                current_len--;
+            } else if (move == 1) {
+                current[slot] = outgoing;
+            } else {
+                current[current_len++] = current[slot];
+                current[slot] = outgoing;
+            }
+        }
+    }
+}
+
+/**
+ * Write a plan to out_indices in greedy presentation order
+ * Repeatedly emits the exercise with the highest marginal score (ties to
+ * the lower catalog index, as in selection)
+ */
+static void emit_plan_in_score_order(
+    const Catalog* cat,
+    const SolverRequest* req,
+    const int32_t* valid_indices,
+    const float* base_scores,
+    int32_t* plan,
+    int32_t plan_len,
+    int32_t* out_indices
+) {
+    uint64_t coverage_mask = 0;
+
+    for (int32_t out = 0; out < plan_len; out++) {
+        int32_t best = out;
+        float best_score = -INFINITY;
+        for (int32_t i = out; i < plan_len; i++) {
+            uint64_t active = cat->active_muscles_mask[valid_indices[plan[i]]];
+            float score = base_scores[plan[i]] + score_coverage(active, req, coverage_mask);
+            if (score > best_score || (score == best_score && valid_indices[plan[i]] < valid_indices[plan[best]])) {
+                best_score = score;
+                best = i;
+            }
+        }
+
+        int32_t chosen = plan[best];
+        plan[best] = plan[out];
+        plan[out] = chosen;
+
+        out_indices[out] = valid_indices[chosen];
+        coverage_mask |= cat->active_muscles_mask[valid_indices[chosen]];
+    }
+}
+
+/**
+ * Reorder a grouped plan so each superset/circuit's members are adjacent
+ * Groups keep the order they were opened in, members their selection order.
+ * Sets and reps are uniform within a session, so only indices move.
+ */
+static void emit_plan_by_group(
+    const SessionGroup* groups,
+    int32_t group_count,
+    const int32_t* member_group,
+    int32_t count,
+    int32_t* out_indices,
+    int32_t* out_groups
+) {
+    Arena* arena = thread_arena();
+    int32_t* start = ARENA_ARRAY(arena, int32_t, group_count);
+    int32_t* indices = ARENA_ARRAY(arena, int32_t, count);
+    if (!start || !indices) {
+        // Keep selection order; group ids still identify the members
+        for (int32_t i = 0; i < count && out_groups; i++) out_groups[i] = member_group[i];
+        return;
+    }
+
+    for (int32_t g = 0, offset = 0; g < group_count; g++) {
+        start[g] = offset;
+        offset += groups[g].size;
+    }
+    memcpy(indices, out_indices, (size_t)count * sizeof(int32_t));
+    for (int32_t i = 0; i < count; i++) {
+        int32_t pos = start[member_group[i]]++;
+        out_indices[pos] = indices[i];
+        if (out_groups) out_groups[pos] = member_group[i];
+    }
+}
+
+/**
+ * Select one session's exercises from a filtered candidate list
+ *
+ * base_scores holds static_score + score_recovery per candidate position;
+ * positions flagged in skip (may be NULL) are not eligible.
+ * With req->max_group_size > 1, an exercise whose worked muscles do not
+ * overlap an open group's may join it as a superset/circuit at the grouped
+ * time cost, and the freed time is filled in the same pass. out_groups
+ * (may be NULL) receives each exercise's group (its own position when
+ * ungrouped).
+ * Returns number of exercises written to the out arrays.
+ */
+static int32_t select_session(
+    const Catalog* cat,
+    const SolverRequest* req,
+    const SessionParams* params,
+    const int32_t* valid_indices,
+    int32_t valid_count,
+    const float* base_scores,
+    const uint8_t* skip,
+    int32_t* out_indices,
+    int32_t* out_sets,
+    int32_t* out_reps,
+    int32_t* out_groups,
+    int32_t max_results
+) {
+    int32_t time_remaining = params->time_budget;
+    const bool grouping = req->max_group_size > 1;
+    const int32_t max_group_size = req->max_group_size < MAX_GROUP_SIZE ? req->max_group_size : MAX_GROUP_SIZE;
+
+    Arena* arena = thread_arena();
+    uint8_t* taken = ARENA_ARRAY(arena, uint8_t, valid_count);
+    ScoredExercise* scored = ARENA_ARRAY(arena, ScoredExercise, valid_count);
+    if (!taken || !scored) {
+        return 0;
+    }
+
+    SessionGroup* groups = NULL;
+    int32_t* member_group = NULL;
+    int32_t group_count = 0;
+    if (grouping) {
+        groups = ARENA_ARRAY(arena, SessionGroup, max_results);
+        member_group = ARENA_ARRAY(arena, int32_t, max_results);
+        if (!groups || !member_group) {
+            return 0;
+        }
+    }
+
+    // Selection loop
+    if (skip) {
+        memcpy(taken, skip, (size_t)valid_count);
+    } else {
+        memset(taken, 0, (size_t)valid_count);
+    }
+    uint64_t coverage_mask = 0;
+    int32_t result_count = 0;
+    int32_t rounds = 0;
+    int32_t pattern_counts[PATTERN_SLOTS] = {0};
+
+    while (time_remaining > 60 && result_count < max_results) {
+        rounds++;
+
+        // Score remaining exercises
+        int32_t scored_count = 0;
+        for (int32_t p = 0; p < valid_count; p++) {
+            // Skip already selected
+            if (taken[p]) {
+                continue;
+            }
+
+            uint64_t active = cat->active_muscles_mask[valid_indices[p]];
+            scored[scored_count].index = p;
+            scored[scored_count].exercise = valid_indices[p];
+            scored[scored_count].score = base_scores[p] + score_coverage(active, req, coverage_mask);
+            scored_count++;
+        }
+
+        if (scored_count == 0) break;
+
+        // Try to fit exercises in descending score order, extracting lazily:
+        // usually the first one or two candidates fit, so a heap beats a sort
+        scored_heapify(scored, scored_count);
+
+        int32_t chosen = -1, chosen_time = 0, chosen_group = -1;
+        int32_t deferred = -1, deferred_time = 0, deferred_group = -1;
+        while (scored_count > 0) {
+            int32_t p = scored_pop(scored, &scored_count).index;
+            int32_t idx = valid_indices[p];
+
+            int32_t time_needed = estimate_time(&cat->exercises[idx], params->sets, params->reps, params->rest_multiplier);
+            int32_t group = -1;
+            if (grouping) {
+                group = join_group(groups, group_count, max_group_size, &cat->exercises[idx],
+                                   cat->worked_muscles_mask[idx], params, &time_needed);
+            }
+            if (time_needed > time_remaining) {
+                continue;
+            }
+
+            int32_t admission = pattern_admission(req, pattern_counts, pattern_slot(cat, idx));
+            if (admission == PATTERN_ADMIT) {
+                chosen = p;
+                chosen_time = time_needed;
+                chosen_group = group;
+                break;
+            }
+            if (admission == PATTERN_DEFER && deferred < 0) {
+                deferred = p;
+                deferred_time = time_needed;
+                deferred_group = group;
+            }
+        }
+
+        // Exceed the antagonist imbalance only when nothing else fits
+        if (chosen < 0) {
+            chosen = deferred;
+            chosen_time = deferred_time;
+            chosen_group = deferred_group;
+        }
+        if (chosen < 0) break;
+
+        // Select this exercise
+        int32_t idx = valid_indices[chosen];
+        taken[chosen] = 1;
+
+        // Update coverage and pattern counts
+        coverage_mask |= cat->active_muscles_mask[idx];
+        int32_t pattern = pattern_slot(cat, idx);
+        if (pattern >= 0) pattern_counts[pattern]++;
+
+        // Join the chosen group or open a new one
+        if (grouping) {
+            if (chosen_group < 0) {
+                chosen_group = group_count++;
+            }
+            SessionGroup* group = &groups[chosen_group];
+            int32_t rest = (int32_t)(cat->exercises[idx].rest_seconds * params->rest_multiplier);
+            group->worked_mask |= cat->worked_muscles_mask[idx];
+            if (rest > group->rest) group->rest = rest;
+            group->size++;
+            member_group[result_count] = chosen_group;
+        }
+
+        // Output result
+        out_indices[result_count] = idx;
+        out_sets[result_count] = params->sets;
+        out_reps[result_count] = params->reps;
+        if (out_groups) out_groups[result_count] = result_count;
+        result_count++;
+
+        time_remaining -= chosen_time;
+    }
+    PROFILE_VALUE(PROFILE_ROUNDS, rounds);
+    (void)rounds;
+
+    if (grouping) {
+        emit_plan_by_group(groups, group_count, member_group, result_count, out_indices, out_groups);
+        return result_count;
+    }
+
+    // Anytime optimization seeded with the greedy plan
+    if (req->optimize_deadline_us > 0 && result_count > 0) {
+        int32_t* times = ARENA_ARRAY(arena, int32_t, valid_count);
+        int32_t* position_of = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+        int32_t* plan = ARENA_ARRAY(arena, int32_t, valid_count);
+        if (!times || !position_of || !plan) {
+            return result_count; // Keep the greedy plan
+        }
+
+        for (int32_t p = 0; p < valid_count; p++) {
+            times[p] = estimate_time(&cat->exercises[valid_indices[p]], params->sets, params->reps, params->rest_multiplier);
+            position_of[valid_indices[p]] = p;
+        }
+        for (int32_t i = 0; i < result_count; i++) {
+            plan[i] = position_of[out_indices[i]];
+        }
+
+        optimize_plan(cat, req, valid_indices, valid_count, base_scores, times, skip,
+                      params->time_budget, max_results, plan, &result_count);
+        emit_plan_in_score_order(cat, req, valid_indices, base_scores, plan, result_count, out_indices);
+
+        for (int32_t i = 0; i < result_count; i++) {
+            out_sets[i] = params->sets;
+            out_reps[i] = params->reps;
+            if (out_groups) out_groups[i] = i;
+        }
+    }
+
+    return result_count;
+}
+
+/**
+ * Main solver function
+ * Returns indices of selected exercises
+ */
+static int32_t solve(
+    const Catalog* cat,
+    const SolverRequest* req,
+    int32_t* out_indices,
+    int32_t* out_sets,
+    int32_t* out_reps,
+    int32_t* out_groups,
+    int32_t max_results
+) {
+    if (cat->exercise_count == 0) {
+        return 0;
+    }
+    NATIVE_PROBE2(solve__start, cat->exercise_count, req->time_available_seconds);
+
+    Arena* arena = thread_arena();
+    int32_t* valid_indices = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    if (!valid_indices) {
+        NATIVE_PROBE1(solve__end, 0);
+        return 0;
+    }
+
+    // Filter exercises
+    PROFILE_BEGIN(filter);
+    int32_t valid_count = filter_candidates(cat, req, valid_indices);
+    PROFILE_END(filter, PROFILE_FILTER);
+    PROFILE_VALUE(PROFILE_CANDIDATES, valid_count);
+    NATIVE_PROBE1(solve__filtered, valid_count);
+
+    if (valid_count == 0) {
+        NATIVE_PROBE1(solve__end, 0);
+        return 0;
+    }
+
+    SessionParams params;
+    session_params(req, &params);
+
+    PROFILE_BEGIN(score);
+    float* base_scores = ARENA_ARRAY(arena, float, valid_count);
+    if (!base_scores || !score_candidates(cat, req, valid_indices, valid_count, NULL, base_scores)) {
+        NATIVE_PROBE1(solve__end, 0);
+        return 0;
+    }
+    PROFILE_END(score, PROFILE_SCORE);
+    NATIVE_PROBE1(solve__scored, valid_count);
+
+    PROFILE_BEGIN(select);
+    int32_t count = select_session(cat, req, &params, valid_indices, valid_count, base_scores, NULL,
+                                   out_indices, out_sets, out_reps, out_groups, max_results);
+    PROFILE_END(select, PROFILE_SELECT);
+    PROFILE_VALUE(PROFILE_SELECTED, count);
+    NATIVE_PROBE1(solve__end, count);
+
+    return count;
+}
+
+/**
+ * Derive a session's recovery masks from the program so far
+ *
+ * A muscle worked h hours before the session, with recovery window R, is
+ * treated as recent-24h while more than 24h of recovery remain and as
+ * recent-48h while any recovery remains. The request's own recent masks
+ * count as work 12h and 36h before day 0, and apply verbatim on day 0.
+ */
+static void program_recovery_masks(
+    const Catalog* cat,
+    const SolverRequest* req,
+    const int32_t* session_days,
+    const int32_t* worked_masks,
+    int32_t session,
+    SolverRequest* day_req
+) {
+    int32_t day = session_days[session];
+    uint32_t recent_24h = 0;
+    uint32_t recent_48h = 0;
+
+    for (int32_t m = 0; m < MASK_MUSCLES; m++) {
+        uint32_t bit = 1U << m;
+        int32_t hours_since = INT32_MAX;
+
+        for (int32_t s = 0; s < session; s++) {
+            if ((uint32_t)worked_masks[s] & bit) {
+                hours_since = (day - session_days[s]) * 24;
+            }
+        }
+        if (hours_since == INT32_MAX) {
+            if ((uint32_t)req->recent_24h_muscles_mask & bit) hours_since = day * 24 + 12;
+            else if ((uint32_t)req->recent_48h_muscles_mask & bit) hours_since = day * 24 + 36;
+            else continue;
+        }
+
+        int32_t remaining = cat->muscle_recovery_hours[m] - hours_since;
+        if (remaining > 24) {
+            recent_24h |= bit;
+        } else if (remaining > 0) {
+            recent_48h |= bit;
+        }
+    }
+
+    if (day == 0) {
+        recent_24h |= (uint32_t)req->recent_24h_muscles_mask;
+        recent_48h |= (uint32_t)req->recent_48h_muscles_mask;
+    }
+
+    day_req->recent_24h_muscles_mask = (int32_t)recent_24h;
+    day_req->recent_48h_muscles_mask = (int32_t)(recent_48h & ~recent_24h);
+}
+
+/**
+ * Multi-session program solver (e.g. a weekly split)
+ *
+ * Plans one session per entry of session_days (day offsets, ascending) in
+ * a single pass: candidates are filtered and statically scored once, then
+ * each session re-scores only recovery against the muscles worked earlier
+ * in the program. Exercises are not repeated within a program.
+ *
+ * Results are packed session by session; out_counts[s] receives the number
+ * of exercises in session s. Returns the total number of exercises.
+ */
+static BINDING_HELPER int32_t solve_program(
+    const Catalog* cat,
+    const SolverRequest* req,
+    const int32_t* session_days,
+    int32_t session_count,
+    int32_t* out_counts,
+    int32_t* out_indices,
+    int32_t* out_sets,
+    int32_t* out_reps,
+    int32_t* out_groups
+) {
+    memset(out_counts, 0, (size_t)session_count * sizeof(int32_t));
+    if (cat->exercise_count == 0) {
+        return 0;
+    }
+
+    Arena* arena = thread_arena();
+    int32_t* valid_indices = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    if (!valid_indices) {
+        return 0;
+    }
+
+    PROFILE_BEGIN(filter);
+    int32_t valid_count = filter_candidates(cat, req, valid_indices);
+    PROFILE_END(filter, PROFILE_FILTER);
+    PROFILE_VALUE(PROFILE_CANDIDATES, valid_count);
+
+    if (valid_count == 0) {
+        return 0;
+    }
+
+    SessionParams params;
+    session_params(req, &params);
+
+    float* static_scores = ARENA_ARRAY(arena, float, valid_count);
+    int32_t* position_of = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    uint8_t* used = ARENA_ARRAY(arena, uint8_t, valid_count);
+    float* base_scores = ARENA_ARRAY(arena, float, valid_count);
+    if (!static_scores || !position_of || !used || !base_scores) {
+        return 0;
+    }
+
+    // Static scores shared by every session
+    PROFILE_BEGIN(score);
+    if (!score_candidates(cat, req, valid_indices, valid_count, static_scores, base_scores)) {
+        return 0;
+    }
+    PROFILE_END(score, PROFILE_SCORE);
+
+    for (int32_t p = 0; p < valid_count; p++) {
+        position_of[valid_indices[p]] = p;
+    }
+
+    int32_t worked_masks[MAX_PROGRAM_SESSIONS] = {0};
+    int32_t total = 0;
+
+    for (int32_t s = 0; s < session_count; s++) {
+        SolverRequest day_req = *req;
+        program_recovery_masks(cat, req, session_days, worked_masks, s, &day_req);
+
+        for (int32_t p = 0; p < valid_count; p++) {
+            base_scores[p] = static_scores[p] + score_recovery(cat->active_muscles_mask[valid_indices[p]], &day_req);
+        }
+
+        PROFILE_BEGIN(select);
+        int32_t count = select_session(cat, &day_req, &params, valid_indices, valid_count, base_scores, used,
+                                       out_indices + total, out_sets + total, out_reps + total,
+                                       out_groups ? out_groups + total : NULL, cat->exercise_count - total);
+        PROFILE_END(select, PROFILE_SELECT);
+        PROFILE_VALUE(PROFILE_SELECTED, count);
+
+        for (int32_t i = 0; i < count; i++) {
+            int32_t idx = out_indices[total + i];
+            used[position_of[idx]] = 1;
+            worked_masks[s] |= cat->exclusion_muscles_mask[idx];
+        }
+
+        out_counts[s] = count;
+        total += count;
+    }
+
+    return total;
+}
+
+// ============ Weight Evaluation ============
+
+/**
+ * Plan quality for one (weight vector, request) combination
+ */
+typedef struct {
+    float time_utilization;              // Prescribed time / session time budget
+    int32_t coverage;                    // Distinct muscles activated
+    int32_t exercise_count;
+} PlanMetrics;
+
+/**
+ * Offline evaluation of many weight vectors against many requests
+ *
+ * Requests are packed EVAL_REQUEST_FIELDS int32s each, in the order
+ * timeAvailableSeconds, location, equipmentMask, goalsMask, fitnessLevel,
+ * excludedMusclesMask, recent24hMusclesMask, recent48hMusclesMask.
+ * Weight vectors are EVAL_WEIGHT_FIELDS floats each in ScoringWeights
+ * order. Every combination is solved uncached; workers claim chunks of
+ * combinations from a shared counter.
+ */
+typedef struct {
+    const Catalog* cat;
+    const float* weights;                // [weight_count][EVAL_WEIGHT_FIELDS]
+    int32_t weight_count;
+    const int32_t* requests;             // [request_count][EVAL_REQUEST_FIELDS]
+    int32_t request_count;
+    PlanMetrics* metrics;                // [weight_count][request_count]
+    _Atomic int64_t next;                // Next unclaimed combination
+    _Atomic int32_t failed;              // EvaluationStatus; workers stop once set
+} WeightEvaluation;
+
+typedef enum {
+    EVAL_OK = 0,
+    EVAL_OUT_OF_MEMORY,
+    EVAL_THREAD_FAILED                   // pthread_create refused a worker
+} EvaluationStatus;
+
+/**
+ * Expand a packed request and weight vector into a SolverRequest
+ */
+static void unpack_evaluation_request(const int32_t* packed, const float* weights, SolverRequest* req) {
+    memset(req, 0, sizeof(SolverRequest));
+    req->time_available_seconds = packed[0];
+    req->location = packed[1];
+    req->equipment_mask = packed[2];
+    req->goals_mask = packed[3];
+    req->fitness_level = packed[4];
+    req->excluded_muscles_mask = packed[5];
+    req->recent_24h_muscles_mask = packed[6];
+    req->recent_48h_muscles_mask = packed[7];
+    req->weights = (ScoringWeights){weights[0], weights[1], weights[2], weights[3], weights[4], weights[5]};
+}
+
+/**
+ * Solve one request and measure the resulting plan
+ * Returns 0 if scratch could not be allocated
+ */
+static int32_t evaluate_plan(const Catalog* cat, const SolverRequest* req, PlanMetrics* metrics) {
+    Arena* arena = thread_arena();
+    ArenaMark mark = arena_mark(arena);
+    int32_t* out_indices = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_sets = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_reps = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    if (!out_indices || !out_sets || !out_reps) {
+        arena_release(arena, mark);
+        return 0;
+    }
+
+    int32_t count = solve(cat, req, out_indices, out_sets, out_reps, NULL, cat->exercise_count);
+
+    SessionParams params;
+    session_params(req, &params);
+
+    int32_t used_time = 0;
+    uint64_t coverage = 0;
+    for (int32_t i = 0; i < count; i++) {
+        int32_t idx = out_indices[i];
+        used_time += estimate_time(&cat->exercises[idx], params.sets, params.reps, params.rest_multiplier);
+        coverage |= cat->active_muscles_mask[idx];
+    }
+
+    metrics->time_utilization = params.time_budget > 0 ? (float)used_time / (float)params.time_budget : 0.0f;
+    metrics->coverage = __builtin_popcountll(coverage);
+    metrics->exercise_count = count;
+
+    arena_release(arena, mark);
+    return 1;
+}
+
+/**
+ * Evaluation worker: claim and solve chunks of combinations until none remain
+ */
+static void* evaluation_worker(void* arg) {
+    WeightEvaluation* eval = arg;
+    int64_t total = (int64_t)eval->weight_count * eval->request_count;
+
+    for (;;) {
+        int64_t begin = atomic_fetch_add_explicit(&eval->next, EVAL_CHUNK, memory_order_relaxed);
+        if (begin >= total || atomic_load_explicit(&eval->failed, memory_order_relaxed)) break;
+        int64_t end = begin + EVAL_CHUNK < total ? begin + EVAL_CHUNK : total;
+
+        for (int64_t combo = begin; combo < end; combo++) {
+            int32_t w = (int32_t)(combo / eval->request_count);
+            int32_t r = (int32_t)(combo % eval->request_count);
+
+            SolverRequest req;
+            unpack_evaluation_request(eval->requests + (size_t)r * EVAL_REQUEST_FIELDS,
+                                      eval->weights + (size_t)w * EVAL_WEIGHT_FIELDS, &req);
+            if (!evaluate_plan(eval->cat, &req, &eval->metrics[combo])) {
+                atomic_store_explicit(&eval->failed, EVAL_OUT_OF_MEMORY, memory_order_relaxed);
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Process-wide budget of evaluation worker threads
+ *
+ * Every evaluation runs on its libuv worker and borrows at most
+ * thread_count - 1 more threads from this budget, so concurrent
+ * evaluateWeights calls together never start more workers than there are
+ * online CPUs. A call that finds the budget spent runs on fewer threads
+ * (its own at least) rather than waiting.
+ */
+static pthread_mutex_t g_eval_lock = PTHREAD_MUTEX_INITIALIZER;
+static int32_t g_eval_helpers;                 // Worker threads currently borrowed
+
+static int32_t online_cpus(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) return 1;
+    return cpus > EVAL_MAX_THREADS ? EVAL_MAX_THREADS : (int32_t)cpus;
+}
+
+static int32_t reserve_evaluation_helpers(int32_t wanted) {
+    int32_t limit = online_cpus();
+    pthread_mutex_lock(&g_eval_lock);
+    int32_t available = limit - g_eval_helpers;
+    int32_t granted = wanted < available ? wanted : available;
+    if (granted < 0) granted = 0;
+    g_eval_helpers += granted;
+    pthread_mutex_unlock(&g_eval_lock);
+    return granted;
+}
+
+static void release_evaluation_helpers(int32_t count) {
+    pthread_mutex_lock(&g_eval_lock);
+    g_eval_helpers -= count;
+    pthread_mutex_unlock(&g_eval_lock);
+}
+
+/**
+ * Run an evaluation on up to thread_count threads (the caller's included)
+ * Returns EVAL_THREAD_FAILED if a worker thread cannot be started; the
+ * workers already running are stopped and joined first
+ */
+static BINDING_HELPER EvaluationStatus run_weight_evaluation(WeightEvaluation* eval, int32_t thread_count) {
+    pthread_t threads[EVAL_MAX_THREADS];
+    int32_t helpers = reserve_evaluation_helpers(thread_count - 1);
+    int32_t started = 0;
+
+    atomic_init(&eval->next, 0);
+    atomic_init(&eval->failed, EVAL_OK);
+
+    for (int32_t t = 0; t < helpers; t++) {
+        if (pthread_create(&threads[started], NULL, evaluation_worker, eval) != 0) {
+            atomic_store(&eval->failed, EVAL_THREAD_FAILED);
+            break;
+        }
+        started++;
+    }
+    if (started == helpers) {
+        evaluation_worker(eval);
+    }
+
+    for (int32_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    release_evaluation_helpers(helpers);
+    return (EvaluationStatus)atomic_load(&eval->failed);
+}
+
+/**
+ * Default evaluation parallelism: one thread per online CPU, at most
+ * EVAL_DEFAULT_THREADS
+ */
+static BINDING_HELPER int32_t default_evaluation_threads(void) {
+    int32_t cpus = online_cpus();
+    return cpus > EVAL_DEFAULT_THREADS ? EVAL_DEFAULT_THREADS : cpus;
+}
+
+// ============ Result Cache ============
+
+/**
+ * Canonical cache key: request scalars plus the sorted excluded indices
+ */
+typedef struct {
+    SolverRequest request;               // excluded_exercises pointer cleared
+    int32_t excluded_count;
+    int32_t excluded[CACHE_MAX_EXCLUSIONS];
+} CacheKey;
+
+/**
+ * Cache entry: canonical request, catalog version and the resulting plan
+ * Entries form an LRU list (prev/next) and per-bucket hash chains
+ */
+typedef struct {
+    uint64_t hash;
+    uint32_t catalog_version;
+    CacheKey key;
+    int32_t count;
+    int32_t indices[CACHE_MAX_RESULTS];
+    int32_t sets[CACHE_MAX_RESULTS];
+    int32_t reps[CACHE_MAX_RESULTS];
+    int32_t groups[CACHE_MAX_RESULTS];
+    int32_t prev;                        // LRU neighbours (-1 = none)
+    int32_t next;
+    int32_t bucket_next;                 // Hash chain (-1 = end)
+} CacheEntry;
+
+typedef struct {
+    CacheEntry entries[CACHE_CAPACITY];
+    int32_t buckets[CACHE_BUCKETS];
+    int32_t head;                        // Most recently used
+    int32_t tail;                        // Least recently used
+    int32_t size;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint32_t catalog_version;            // Version of the published catalog
+    pthread_mutex_t lock;
+} ResultCache;
+
+/**
+ * Reset cache contents (caller holds cache->lock)
+ */
+static void cache_clear_locked(ResultCache* cache) {
+    for (int32_t b = 0; b < CACHE_BUCKETS; b++) {
+        cache->buckets[b] = -1;
+    }
+    cache->head = -1;
+    cache->tail = -1;
+    cache->size = 0;
+}
+
+/**
+ * Build the canonical cache key for a request
+ * Normalizes fields that cannot affect the result so equivalent requests
+ * share an entry. Returns 0 if the request is not cacheable.
+ */
+static int32_t cache_canonical_key(
+    const Catalog* cat,
+    const SolverRequest* req,
+    CacheKey* key,
+    uint64_t* hash
+) {
+    // Anytime optimization is time-dependent, so its output is not reproducible
+    if (req->optimize_deadline_us > 0) {
+        return 0;
+    }
+
+    memset(key, 0, sizeof(CacheKey));
+    memcpy(&key->request, req, sizeof(SolverRequest));
+    key->request.excluded_exercises = NULL;
+    if (key->request.location == 0) {
+        key->request.equipment_mask = 0; // Equipment is not checked at the gym
+    }
+    key->request.recent_48h_muscles_mask &= ~key->request.recent_24h_muscles_mask;
+
+    if (req->excluded_exercises) {
+        int32_t words = (cat->exercise_count + 63) / 64;
+        for (int32_t w = 0; w < words; w++) {
+            for (uint64_t bits = req->excluded_exercises[w]; bits != 0; bits &= bits - 1) {
+                if (key->excluded_count == CACHE_MAX_EXCLUSIONS) {
+                    return 0;
+                }
+                key->excluded[key->excluded_count++] = w * 64 + __builtin_ctzll(bits);
+            }
+        }
+    }
+
+    // FNV-1a over the canonical key words
+    const uint32_t* words = (const uint32_t*)key;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < sizeof(CacheKey) / sizeof(uint32_t); i++) {
+        h ^= words[i];
+        h *= 0x100000001b3ULL;
+    }
+    *hash = h;
+    return 1;
+}
+
+/**
+ * Unlink an entry from the LRU list (caller holds cache->lock)
+ */
+static void cache_lru_unlink(ResultCache* cache, int32_t e) {
+    CacheEntry* entry = &cache->entries[e];
+    if (entry->prev >= 0) cache->entries[entry->prev].next = entry->next;
+    else cache->head = entry->next;
+    if (entry->next >= 0) cache->entries[entry->next].prev = entry->prev;
+    else cache->tail = entry->prev;
+}
+
+/**
+ * Insert an entry at the LRU head (caller holds cache->lock)
+ */
+static void cache_lru_push_front(ResultCache* cache, int32_t e) {
+    CacheEntry* entry = &cache->entries[e];
+    entry->prev = -1;
+    entry->next = cache->head;
+    if (cache->head >= 0) cache->entries[cache->head].prev = e;
+    cache->head = e;
+    if (cache->tail < 0) cache->tail = e;
+}
+
+/**
+ * Look up a plan; on hit copies it out and returns 1
+ */
+static int32_t cache_lookup(
+    ResultCache* cache,
+    const CacheKey* key,
+    uint64_t hash,
+    uint32_t catalog_version,
+    int32_t* out_indices,
+    int32_t* out_sets,
+    int32_t* out_reps,
+    int32_t* out_groups,
+    int32_t max_results,
+    int32_t* out_count
+) {
+    pthread_mutex_lock(&cache->lock);
+
+    for (int32_t e = cache->buckets[hash % CACHE_BUCKETS]; e >= 0; e = cache->entries[e].bucket_next) {
+        CacheEntry* entry = &cache->entries[e];
+        if (entry->hash == hash &&
+            entry->catalog_version == catalog_version &&
+            entry->count <= max_results &&
+            memcmp(&entry->key, key, sizeof(CacheKey)) == 0) {
+            memcpy(out_indices, entry->indices, (size_t)entry->count * sizeof(int32_t));
+            memcpy(out_sets, entry->sets, (size_t)entry->count * sizeof(int32_t));
+            memcpy(out_reps, entry->reps, (size_t)entry->count * sizeof(int32_t));
+            memcpy(out_groups, entry->groups, (size_t)entry->count * sizeof(int32_t));
+            *out_count = entry->count;
+
+            cache_lru_unlink(cache, e);
+            cache_lru_push_front(cache, e);
+            cache->hits++;
+            pthread_mutex_unlock(&cache->lock);
+            return 1;
+        }
+    }
+
+    cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+/**
+ * Store a plan, evicting the least recently used entry when full
+ * Plans computed against an older catalog version are dropped
+ */
+static void cache_store(
+    ResultCache* cache,
+    const CacheKey* key,
+    uint64_t hash,
+    uint32_t catalog_version,
+    const int32_t* indices,
+    const int32_t* sets,
+    const int32_t* reps,
+    const int32_t* groups,
+    int32_t count
+) {
+    if (count > CACHE_MAX_RESULTS) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    if (catalog_version != cache->catalog_version) {
+        pthread_mutex_unlock(&cache->lock);
+        return;
+    }
+
+    // Another solve may have stored the same key meanwhile
+    int32_t bucket = (int32_t)(hash % CACHE_BUCKETS);
+    for (int32_t e = cache->buckets[bucket]; e >= 0; e = cache->entries[e].bucket_next) {
+        CacheEntry* entry = &cache->entries[e];
+        if (entry->hash == hash && memcmp(&entry->key, key, sizeof(CacheKey)) == 0) {
+            pthread_mutex_unlock(&cache->lock);
+            return;
+        }
+    }
+
+    int32_t e;
+    if (cache->size < CACHE_CAPACITY) {
+        e = cache->size++;
+    } else {
+        // Evict LRU tail and unchain it from its bucket
+        e = cache->tail;
+        cache_lru_unlink(cache, e);
+        int32_t* link = &cache->buckets[cache->entries[e].hash % CACHE_BUCKETS];
+        while (*link != e) {
+            link = &cache->entries[*link].bucket_next;
+        }
+        *link = cache->entries[e].bucket_next;
+        cache->evictions++;
+    }
+
+    CacheEntry* entry = &cache->entries[e];
+    entry->hash = hash;
+    entry->catalog_version = catalog_version;
+    entry->key = *key;
+    entry->count = count;
+    memcpy(entry->indices, indices, (size_t)count * sizeof(int32_t));
+    memcpy(entry->sets, sets, (size_t)count * sizeof(int32_t));
+    memcpy(entry->reps, reps, (size_t)count * sizeof(int32_t));
+    memcpy(entry->groups, groups, (size_t)count * sizeof(int32_t));
+
+    entry->bucket_next = cache->buckets[bucket];
+    cache->buckets[bucket] = e;
+    cache_lru_push_front(cache, e);
+
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Invalidate all cached plans (called when a new catalog is published)
+ */
+static void cache_invalidate(ResultCache* cache, uint32_t catalog_version) {
+    pthread_mutex_lock(&cache->lock);
+    cache->catalog_version = catalog_version;
+    cache_clear_locked(cache);
+    pthread_mutex_unlock(&cache->lock);
+}
+
+_Static_assert(PATTERN_SLOTS == 7 && sizeof(ScoringWeights) == 6 * sizeof(float),
+               "NativeCaptureSolve mirrors SolverRequest");
+
+/**
+ * Narrow a request field to a capture byte, saturating (and flagging the
+ * record truncated) when it does not fit
+ */
+static int8_t capture_int8(NativeCaptureRecord* capture, int32_t value) {
+    if (value < INT8_MIN || value > INT8_MAX) {
+        capture->flags |= NATIVE_CAPTURE_TRUNCATED;
+        return value < 0 ? INT8_MIN : INT8_MAX;
+    }
+    return (int8_t)value;
+}
+
+/**
+ * Fill a capture record with a solve request
+ */
+static void capture_request(NativeCaptureRecord* capture, const Catalog* cat, const SolverRequest* req) {
+    NativeCaptureSolve* args = (NativeCaptureSolve*)capture->args;
+    args->time_available_seconds = req->time_available_seconds;
+    args->equipment_mask = req->equipment_mask;
+    args->goals_mask = req->goals_mask;
+    args->excluded_muscles_mask = req->excluded_muscles_mask;
+    args->recent_24h_muscles_mask = req->recent_24h_muscles_mask;
+    args->recent_48h_muscles_mask = req->recent_48h_muscles_mask;
+    args->optimize_deadline_us = req->optimize_deadline_us;
+    args->seed = req->seed;
+    args->variety = req->variety;
+    memcpy(args->weights, &req->weights, sizeof(args->weights));
+    args->catalog_exercises = cat->exercise_count;
+    args->location = capture_int8(capture, req->location);
+    args->fitness_level = capture_int8(capture, req->fitness_level);
+    args->max_group_size = capture_int8(capture, req->max_group_size);
+    args->max_antagonist_imbalance = capture_int8(capture, req->max_antagonist_imbalance);
+    for (int p = 0; p < PATTERN_SLOTS; p++) {
+        args->pattern_quota[p] = capture_int8(capture, req->pattern_quota[p]);
+    }
+
+    if (req->excluded_exercises) {
+        for (int32_t w = 0; w < cat->words; w++) {
+            for (uint64_t bits = req->excluded_exercises[w]; bits != 0; bits &= bits - 1) {
+                if (args->excluded_count < NATIVE_CAPTURE_SOLVE_EXCLUDED) {
+                    args->excluded[args->excluded_count] = w * 64 + __builtin_ctzll(bits);
+                } else {
+                    capture->flags |= NATIVE_CAPTURE_TRUNCATED;
+                }
+                args->excluded_count++;
+            }
+        }
+    }
+}
+
+/**
+ * Solve through the result cache (out_groups is required)
+ */
+static BINDING_HELPER int32_t solve_cached(
+    ResultCache* cache,
+    const Catalog* cat,
+    const SolverRequest* req,
+    int32_t* out_indices,
+    int32_t* out_sets,
+    int32_t* out_reps,
+    int32_t* out_groups,
+    int32_t max_results
+) {
+    NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_SOLVE);
+    if (capture) {
+        capture_request(capture, cat, req);
+    }
+
+    CacheKey key;
+    uint64_t hash;
+    if (!cache_canonical_key(cat, req, &key, &hash)) {
+        return solve(cat, req, out_indices, out_sets, out_reps, out_groups, max_results);
+    }
+
+    int32_t count;
+    if (cache_lookup(cache, &key, hash, cat->version, out_indices, out_sets, out_reps, out_groups,
+                     max_results, &count)) {
+        if (capture) {
+            capture->flags |= NATIVE_CAPTURE_CACHE_HIT;
+        }
+        return count;
+    }
+
+    count = solve(cat, req, out_indices, out_sets, out_reps, out_groups, max_results);
+    cache_store(cache, &key, hash, cat->version, out_indices, out_sets, out_reps, out_groups, count);
+    return count;
+}
+
+// ============ Solver Instance ============
+
+/**
+ * Per-addon-instance state (napi_set_instance_data)
+ *
+ * The published catalog pointer is swapped under catalog_lock, which only
+ * guards the pointer and reference count hand-off; solves run on their own
+ * reference without holding any lock, so a reload never pauses solving.
+ */
+typedef struct {
+    Catalog* catalog;
+    pthread_mutex_t catalog_lock;
+    uint32_t next_version;
+    ResultCache cache;
+} SolverInstance;
+
+/**
+ * Take a reference to the published catalog (NULL if none)
+ */
+static BINDING_HELPER Catalog* catalog_acquire(SolverInstance* inst) {
+    pthread_mutex_lock(&inst->catalog_lock);
+    Catalog* cat = inst->catalog;
+    if (cat) {
+        atomic_fetch_add_explicit(&cat->refcount, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&inst->catalog_lock);
+    return cat;
+}
+
+/**
+ * Drop a catalog reference, freeing it with the last one
+ */
+static void catalog_release(Catalog* cat) {
+    if (cat && atomic_fetch_sub_explicit(&cat->refcount, 1, memory_order_acq_rel) == 1) {
+        catalog_file_close(&cat->file);
+        free(cat);
+    }
+}
+
+/**
+ * Publish a fully built catalog and retire the previous one
+ * Solves already running keep using the old catalog until they finish
+ */
+static BINDING_HELPER void catalog_publish(SolverInstance* inst, Catalog* cat) {
+    atomic_init(&cat->refcount, 1);      // Reference held by the instance
+
+    pthread_mutex_lock(&inst->catalog_lock);
+    cat->version = ++inst->next_version;
+    Catalog* old = inst->catalog;
+    inst->catalog = cat;
+    pthread_mutex_unlock(&inst->catalog_lock);
+
+    cache_invalidate(&inst->cache, cat->version);
+    catalog_release(old);
+}
+
+/**
+ * Create instance state
+ */
+static BINDING_HELPER SolverInstance* instance_create(void) {
+    SolverInstance* inst = calloc(1, sizeof(SolverInstance));
+    if (!inst) return NULL;
+
+    pthread_mutex_init(&inst->catalog_lock, NULL);
+    pthread_mutex_init(&inst->cache.lock, NULL);
+    cache_clear_locked(&inst->cache);
+    return inst;
+}
+
+#ifndef SOLVER_NO_NAPI
+
+/**
+ * Instance finalizer (environment teardown)
+ */
+static void instance_finalize(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)hint;
+    SolverInstance* inst = data;
+
+    catalog_release(inst->catalog);
+    pthread_mutex_destroy(&inst->catalog_lock);
+    pthread_mutex_destroy(&inst->cache.lock);
+    free(inst);
+}
+
+/**
+ * Fetch the instance and a catalog reference for a binding call
+ * Throws and returns NULL if no catalog has been loaded
+ */
+static Catalog* acquire_initialized_catalog(napi_env env, SolverInstance** out_inst) {
+    SolverInstance* inst = NULL;
+    napi_get_instance_data(env, (void**)&inst);
+    *out_inst = inst;
+
+    Catalog* cat = inst ? catalog_acquire(inst) : NULL;
+    if (!cat || cat->exercise_count == 0) {
+        catalog_release(cat);
+        napi_throw_error(env, NULL, "Exercises not initialized. Call initExercises first.");
+        return NULL;
+    }
+    return cat;
+}
+
+// ============ N-API Bindings ============
+
+/**
+ * Read optional scoring weight overrides from a JavaScript object
+ * Missing properties keep their current values
+ */
+static void read_weights(napi_env env, napi_value obj, ScoringWeights* weights) {
+    napi_valuetype type;
+    napi_typeof(env, obj, &type);
+    if (type != napi_object) {
+        return;
+    }
+
+    static const char* const names[EVAL_WEIGHT_FIELDS] = {
+        "goalAlignment", "compoundPreference", "recoveryPenalty24h",
+        "recoveryPenalty48h", "fitnessLevelMatch", "muscleCoverageGap"
+    };
+    float* fields[EVAL_WEIGHT_FIELDS] = {
+        &weights->goal_alignment, &weights->compound_preference, &weights->recovery_penalty_24h,
+        &weights->recovery_penalty_48h, &weights->fitness_level_match, &weights->muscle_coverage_gap
+    };
+
+    for (int32_t i = 0; i < EVAL_WEIGHT_FIELDS; i++) {
+        napi_value val;
+        double value;
+        napi_get_named_property(env, obj, names[i], &val);
+        if (napi_get_value_double(env, val, &value) == napi_ok) {
+            *fields[i] = (float)value;
+        }
+    }
+}
+
+/**
+ * Copy a numeric array or Int32Array/Float32Array/Float64Array to doubles
+ * Returns NULL for other values; *length receives the element count
  */
-static int32_t solve(
-    const SolverRequest* req,
-    int32_t* out_indices,
-    int32_t* out_sets,
-    int32_t* out_reps,
-    int32_t max_results
-) {
-    if (g_exercise_count == 0) {
-        return 0;
-    }
-
-    // Filter exercises
-    int32_t valid_indices[MAX_EXERCISES];
-    int32_t valid_count = 0;
+static double* read_numeric_array(napi_env env, napi_value value, size_t* length) {
+    *length = 0;
+
+    bool is_typed = false, is_array = false;
+    napi_is_typedarray(env, value, &is_typed);
+    napi_is_array(env, value, &is_array);
+
+    if (is_typed) {
+        napi_typedarray_type type;
+        size_t len;
+        void* data;
+        napi_get_typedarray_info(env, value, &type, &len, &data, NULL, NULL);
+        if (type != napi_int32_array && type != napi_float32_array && type != napi_float64_array) {
+            return NULL;
+        }
 
-    for (int32_t i = 0; i < g_exercise_count; i++) {
-        if (passes_hard_filters(&g_exercises[i], req)) {
-            valid_indices[valid_count++] = i;
+        double* out = malloc((len ? len : 1) * sizeof(double));
+        if (!out) return NULL;
+        for (size_t i = 0; i < len; i++) {
+            out[i] = type == napi_int32_array ? (double)((const int32_t*)data)[i]
+                   : type == napi_float32_array ? (double)((const float*)data)[i]
+                   : ((const double*)data)[i];
         }
+        *length = len;
+        return out;
     }
 
-    if (valid_count == 0) {
-        return 0;
+    if (is_array) {
+        uint32_t len;
+        napi_get_array_length(env, value, &len);
+
+        double* out = malloc((len ? len : 1) * sizeof(double));
+        if (!out) return NULL;
+        for (uint32_t i = 0; i < len; i++) {
+            napi_value elem;
+            napi_get_element(env, value, i, &elem);
+            out[i] = 0.0;
+            napi_get_value_double(env, elem, &out[i]);
+        }
+        *length = len;
+        return out;
     }
 
-    // Calculate time budget
-    int32_t warmup_cooldown = (req->time_available_seconds >= 1800) ? 300 : 120;
-    int32_t time_remaining = req->time_available_seconds - warmup_cooldown;
+    return NULL;
+}
 
-    // Rest multiplier from goals
-    float rest_multiplier = 1.0f;
-    if (req->goals_mask & (1 << GOAL_STRENGTH)) rest_multiplier = 1.5f;
-    else if (req->goals_mask & (1 << GOAL_ENDURANCE)) rest_multiplier = 0.5f;
-    else if (req->goals_mask & (1 << GOAL_FAT_LOSS)) rest_multiplier = 0.6f;
-    else if (req->goals_mask & (1 << GOAL_MOBILITY)) rest_multiplier = 0.75f;
+/**
+ * Read a SolverRequest from a JavaScript request object
+ * Missing properties leave the zero/default values in place
+ *
+ * Excluded exercises come from excludedExerciseIds (Int32Array or array of
+ * exercise IDs) and the legacy 16-word excludedExercisesMask; both are
+ * mapped through the catalog's ID table into excluded_bits, which must
+ * hold cat->words words.
+ *
+ * patternQuotas caps exercises per movement pattern (push, pull, squat,
+ * hinge, carry, core, isolation; 0 = no limit) and maxAntagonistImbalance
+ * bounds the push/pull and squat/hinge count difference per session.
+ * A non-zero seed adds reproducible noise of up to `variety` points
+ * (default DEFAULT_VARIETY) per exercise, so plans vary by seed.
+ *
+ * @return false with a RangeError pending if maxGroupSize exceeds
+ *         MAX_GROUP_SIZE
+ */
+static bool read_request(
+    napi_env env,
+    napi_value obj,
+    const Catalog* cat,
+    SolverRequest* req,
+    uint64_t* excluded_bits
+) {
+    memset(req, 0, sizeof(SolverRequest));
+    req->weights = DEFAULT_WEIGHTS;
 
-    // Sets/reps from goals
-    int32_t base_sets = 3, base_reps = 10;
-    if (req->goals_mask & (1 << GOAL_STRENGTH)) { base_sets = 5; base_reps = 4; }
-    else if (req->goals_mask & (1 << GOAL_HYPERTROPHY)) { base_sets = 4; base_reps = 10; }
-    else if (req->goals_mask & (1 << GOAL_ENDURANCE)) { base_sets = 2; base_reps = 20; }
-    else if (req->goals_mask & (1 << GOAL_FAT_LOSS)) { base_sets = 3; base_reps = 14; }
+    napi_value val;
 
-    // Selection loop
-    int32_t selected_mask[16] = {0};
-    int32_t coverage_mask = 0;
-    int32_t result_count = 0;
+    napi_get_named_property(env, obj, "timeAvailableSeconds", &val);
+    napi_get_value_int32(env, val, &req->time_available_seconds);
 
-    ScoredExercise scored[MAX_EXERCISES];
+    napi_get_named_property(env, obj, "location", &val);
+    napi_get_value_int32(env, val, &req->location);
 
-    while (time_remaining > 60 && result_count < max_results) {
-        // Score remaining exercises
-        int32_t scored_count = 0;
-        for (int32_t i = 0; i < valid_count; i++) {
-            int32_t idx = valid_indices[i];
-            int32_t bucket = idx / 32;
-            int32_t bit = idx % 32;
+    napi_get_named_property(env, obj, "equipmentMask", &val);
+    napi_get_value_int32(env, val, &req->equipment_mask);
 
-            // Skip already selected
-            if (selected_mask[bucket] & (1 << bit)) {
-                continue;
-            }
+    napi_get_named_property(env, obj, "goalsMask", &val);
+    napi_get_value_int32(env, val, &req->goals_mask);
 
-            scored[scored_count].index = idx;
-            scored[scored_count].score = score_exercise(&g_exercises[idx], req, coverage_mask);
-            scored_count++;
-        }
+    napi_get_named_property(env, obj, "fitnessLevel", &val);
+    napi_get_value_int32(env, val, &req->fitness_level);
 
-        if (scored_count == 0) break;
+    napi_get_named_property(env, obj, "excludedMusclesMask", &val);
+    napi_get_value_int32(env, val, &req->excluded_muscles_mask);
 
-        // Sort by score descending
-        qsort(scored, scored_count, sizeof(ScoredExercise), compare_scores);
+    napi_get_named_property(env, obj, "recent24hMusclesMask", &val);
+    napi_get_value_int32(env, val, &req->recent_24h_muscles_mask);
 
-        // Try to fit exercises
-        int32_t found = 0;
-        for (int32_t i = 0; i < scored_count && !found; i++) {
-            int32_t idx = scored[i].index;
-            const Exercise* ex = &g_exercises[idx];
+    napi_get_named_property(env, obj, "recent48hMusclesMask", &val);
+    napi_get_value_int32(env, val, &req->recent_48h_muscles_mask);
 
-            int32_t time_needed = estimate_time(ex, base_sets, base_reps, rest_multiplier);
+    // Optional anytime optimization budget (microseconds)
+    napi_get_named_property(env, obj, "optimizeMicros", &val);
+    napi_get_value_int32(env, val, &req->optimize_deadline_us);
 
-            if (time_needed <= time_remaining) {
-                // Select this exercise
-                int32_t bucket = idx / 32;
-                int32_t bit = idx % 32;
-                selected_mask[bucket] |= (1 << bit);
+    // Optional scoring weight overrides
+    napi_get_named_property(env, obj, "weights", &val);
+    read_weights(env, val, &req->weights);
 
-                // Update coverage
-                for (int32_t m = 0; m < MAX_MUSCLES; m++) {
-                    if (ex->activations[m] > 0.0f) {
-                        coverage_mask |= (1 << m);
-                    }
-                }
+    // Optional seeded variety: same seed, same plan (with optimizeMicros,
+    // the same annealing moves, cut off by the deadline)
+    napi_get_named_property(env, obj, "seed", &val);
+    napi_get_value_uint32(env, val, &req->seed);
+    req->variety = DEFAULT_VARIETY;
+    napi_get_named_property(env, obj, "variety", &val);
+    double variety;
+    if (napi_get_value_double(env, val, &variety) == napi_ok && variety >= 0.0) {
+        req->variety = (float)variety;
+    }
+
+    // Optional movement pattern balancing
+    napi_get_named_property(env, obj, "maxAntagonistImbalance", &val);
+    napi_get_value_int32(env, val, &req->max_antagonist_imbalance);
+    if (req->max_antagonist_imbalance < 0) req->max_antagonist_imbalance = 0;
+
+    // Optional supersets (2) or circuits (3+)
+    napi_get_named_property(env, obj, "maxGroupSize", &val);
+    napi_get_value_int32(env, val, &req->max_group_size);
+    if (req->max_group_size < 0) req->max_group_size = 0;
+    if (req->max_group_size > MAX_GROUP_SIZE) {
+        char message[64];
+        snprintf(message, sizeof(message), "maxGroupSize must be at most %d", MAX_GROUP_SIZE);
+        napi_throw_range_error(env, NULL, message);
+        return false;
+    }
 
-                // Output result
-                out_indices[result_count] = idx;
-                out_sets[result_count] = base_sets;
-                out_reps[result_count] = base_reps;
-                result_count++;
+    napi_get_named_property(env, obj, "patternQuotas", &val);
+    size_t quota_len;
+    double* quotas = read_numeric_array(env, val, &quota_len);
+    if (quotas) {
+        for (size_t p = 0; p < quota_len && p < PATTERN_SLOTS; p++) {
+            req->pattern_quota[p] = quotas[p] > 0.0 ? (int32_t)quotas[p] : 0;
+        }
+        free(quotas);
+    }
 
-                time_remaining -= time_needed;
-                found = 1;
+    memset(excluded_bits, 0, (size_t)cat->words * sizeof(uint64_t));
+    bool any_excluded = false;
+
+    // Excluded exercise IDs (Int32Array fast path)
+    napi_value excluded_ids;
+    napi_get_named_property(env, obj, "excludedExerciseIds", &excluded_ids);
+    bool is_typed = false, is_ids_array = false;
+    napi_is_typedarray(env, excluded_ids, &is_typed);
+    if (is_typed) {
+        napi_typedarray_type type;
+        size_t id_len;
+        void* data;
+        napi_get_typedarray_info(env, excluded_ids, &type, &id_len, &data, NULL, NULL);
+        if (type == napi_int32_array) {
+            const int32_t* ids = data;
+            for (size_t i = 0; i < id_len; i++) {
+                exclude_exercise_id(cat, ids[i], excluded_bits);
+            }
+            any_excluded = id_len > 0;
+        }
+    } else {
+        napi_is_array(env, excluded_ids, &is_ids_array);
+    }
+    if (is_ids_array) {
+        uint32_t id_len;
+        napi_get_array_length(env, excluded_ids, &id_len);
+        for (uint32_t i = 0; i < id_len; i++) {
+            napi_value id_val;
+            int32_t id;
+            napi_get_element(env, excluded_ids, i, &id_val);
+            if (napi_get_value_int32(env, id_val, &id) == napi_ok) {
+                exclude_exercise_id(cat, id, excluded_bits);
+                any_excluded = true;
             }
         }
+    }
 
-        if (!found) break;
+    // Legacy excluded exercises mask array (bit id % 32 of word id / 32)
+    napi_value excluded_arr;
+    napi_get_named_property(env, obj, "excludedExercisesMask", &excluded_arr);
+    bool is_excluded_array;
+    napi_is_array(env, excluded_arr, &is_excluded_array);
+    if (is_excluded_array) {
+        uint32_t ex_len;
+        napi_get_array_length(env, excluded_arr, &ex_len);
+        if (ex_len > 16) ex_len = 16;
+        for (uint32_t i = 0; i < ex_len; i++) {
+            napi_value ex_val;
+            int32_t mask = 0;
+            napi_get_element(env, excluded_arr, i, &ex_val);
+            napi_get_value_int32(env, ex_val, &mask);
+            for (uint32_t bits = (uint32_t)mask; bits != 0; bits &= bits - 1) {
+                exclude_exercise_id(cat, (int32_t)(i * 32) + __builtin_ctz(bits), excluded_bits);
+                any_excluded = true;
+            }
+        }
     }
 
-    return result_count;
+    req->excluded_exercises = any_excluded ? excluded_bits : NULL;
+    return true;
 }
 
-// ============ N-API Bindings ============
+/**
+ * Convert solver output to a JavaScript array of {index, sets, reps}
+ * Grouped plans (groups != NULL) also carry each exercise's group
+ */
+static napi_value create_plan_array(
+    napi_env env,
+    const int32_t* indices,
+    const int32_t* sets,
+    const int32_t* reps,
+    const int32_t* groups,
+    int32_t count
+) {
+    napi_value result;
+    napi_create_array_with_length(env, count, &result);
+
+    for (int32_t i = 0; i < count; i++) {
+        napi_value item;
+        napi_create_object(env, &item);
+
+        napi_value idx_val, sets_val, reps_val;
+        napi_create_int32(env, indices[i], &idx_val);
+        napi_create_int32(env, sets[i], &sets_val);
+        napi_create_int32(env, reps[i], &reps_val);
+
+        napi_set_named_property(env, item, "index", idx_val);
+        napi_set_named_property(env, item, "sets", sets_val);
+        napi_set_named_property(env, item, "reps", reps_val);
+
+        if (groups) {
+            napi_value group_val;
+            napi_create_int32(env, groups[i], &group_val);
+            napi_set_named_property(env, item, "group", group_val);
+        }
+
+        napi_set_element(env, result, i, item);
+    }
+
+    return result;
+}
 
 /**
  * Initialize exercises from JavaScript array
+ * Optional second argument: per-muscle recovery windows in hours
  * Called once at startup
  */
 static napi_value InitExercises(napi_env env, napi_callback_info info) {
-    size_t argc = 1;
-    napi_value args[1];
+    size_t argc = 2;
+    napi_value args[2];
     napi_get_cb_info(env, info, &argc, args, NULL, NULL);
 
     if (argc < 1) {
@@ -375,18 +2775,29 @@ static napi_value InitExercises(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
+    SolverInstance* inst = NULL;
+    napi_get_instance_data(env, (void**)&inst);
+
     uint32_t length;
     napi_get_array_length(env, args[0], &length);
-    if (length > MAX_EXERCISES) length = MAX_EXERCISES;
+    if (length > MAX_CATALOG_EXERCISES) {
+        napi_throw_range_error(env, NULL, "Too many exercises");
+        return NULL;
+    }
 
-    g_exercise_count = 0;
+    // Build the new catalog privately, then publish it in one swap
+    Catalog* cat = catalog_create((int32_t)length);
+    if (!cat) {
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
 
     for (uint32_t i = 0; i < length; i++) {
         napi_value elem;
         napi_get_element(env, args[0], i, &elem);
 
-        Exercise* ex = &g_exercises[g_exercise_count];
-        memset(ex, 0, sizeof(Exercise));
+        int32_t idx = cat->exercise_count;
+        Exercise* ex = &cat->exercises[idx];
 
         // Get properties
         napi_value val;
@@ -395,15 +2806,15 @@ static napi_value InitExercises(napi_env env, napi_callback_info info) {
         napi_get_value_int32(env, val, &ex->id);
 
         napi_get_named_property(env, elem, "difficulty", &val);
-        napi_get_value_int32(env, val, &ex->difficulty);
+        napi_get_value_int32(env, val, &cat->difficulty[idx]);
 
         napi_get_named_property(env, elem, "isCompound", &val);
-        bool is_compound;
+        bool is_compound = false;
         napi_get_value_bool(env, val, &is_compound);
-        ex->is_compound = is_compound ? 1 : 0;
+        cat->is_compound[idx] = is_compound ? 1 : 0;
 
         napi_get_named_property(env, elem, "movementPattern", &val);
-        napi_get_value_int32(env, val, &ex->movement_pattern);
+        napi_get_value_int32(env, val, &cat->movement_pattern[idx]);
 
         napi_get_named_property(env, elem, "estimatedSeconds", &val);
         napi_get_value_int32(env, val, &ex->estimated_seconds);
@@ -420,7 +2831,8 @@ static napi_value InitExercises(napi_env env, napi_callback_info info) {
         napi_get_named_property(env, elem, "primaryMusclesMask", &val);
         napi_get_value_int32(env, val, &ex->primary_muscles_mask);
 
-        // Get activations array
+        // Get activations array (reduced to muscle masks)
+        float muscle_activations[MAX_MUSCLES] = {0};
         napi_value activations;
         napi_get_named_property(env, elem, "activations", &activations);
         bool has_activations;
@@ -434,29 +2846,82 @@ static napi_value InitExercises(napi_env env, napi_callback_info info) {
                 napi_get_element(env, activations, j, &act_val);
                 double act;
                 napi_get_value_double(env, act_val, &act);
-                ex->activations[j] = (float)act;
+                muscle_activations[j] = (float)act;
             }
         }
+        set_exercise_muscles(cat, idx, muscle_activations);
+
+        cat->exercise_count++;
+    }
+
+    build_candidate_index(cat);
 
-        g_exercise_count++;
+    // Muscle recovery windows
+    for (int32_t m = 0; m < MASK_MUSCLES; m++) {
+        cat->muscle_recovery_hours[m] = DEFAULT_RECOVERY_HOURS;
+    }
+    bool has_recovery = false;
+    if (argc >= 2) {
+        napi_is_array(env, args[1], &has_recovery);
+    }
+    if (has_recovery) {
+        uint32_t rec_len;
+        napi_get_array_length(env, args[1], &rec_len);
+        if (rec_len > MASK_MUSCLES) rec_len = MASK_MUSCLES;
+        for (uint32_t m = 0; m < rec_len; m++) {
+            napi_value rec_val;
+            napi_get_element(env, args[1], m, &rec_val);
+            napi_get_value_int32(env, rec_val, &cat->muscle_recovery_hours[m]);
+        }
     }
 
-    g_initialized = 1;
+    int32_t exercise_count = cat->exercise_count;
+    catalog_publish(inst, cat);
 
     napi_value result;
-    napi_create_int32(env, g_exercise_count, &result);
+    napi_create_int32(env, exercise_count, &result);
     return result;
 }
 
 /**
- * Solve constraints and return selected exercises
+ * Load a binary catalog file (native/src/common/catalog_format.h)
+ * Maps the file and publishes it like initExercises, without copying;
+ * recovery windows come from the file's muscle metadata
  */
-static napi_value Solve(napi_env env, napi_callback_info info) {
-    if (!g_initialized || g_exercise_count == 0) {
-        napi_throw_error(env, NULL, "Exercises not initialized. Call initExercises first.");
+static napi_value LoadCatalogFile(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    char path[4096];
+    size_t path_len;
+    if (argc < 1 || napi_get_value_string_utf8(env, args[0], path, sizeof(path), &path_len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected catalog path");
+        return NULL;
+    }
+
+    SolverInstance* inst = NULL;
+    napi_get_instance_data(env, (void**)&inst);
+
+    int error = 0;
+    Catalog* cat = catalog_from_file(path, &error);
+    if (!cat) {
+        napi_throw_error(env, NULL, catalog_error_string(error));
         return NULL;
     }
 
+    int32_t exercise_count = cat->exercise_count;
+    catalog_publish(inst, cat);
+
+    napi_value result;
+    napi_create_int32(env, exercise_count, &result);
+    return result;
+}
+
+/**
+ * Solve constraints and return selected exercises
+ */
+static napi_value Solve(napi_env env, napi_callback_info info) {
     size_t argc = 1;
     napi_value args[1];
     napi_get_cb_info(env, info, &argc, args, NULL, NULL);
@@ -466,78 +2931,141 @@ static napi_value Solve(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
-    SolverRequest req = {0};
-    req.weights = (ScoringWeights){10.0f, 5.0f, -20.0f, -10.0f, 5.0f, 15.0f};
+    SolverInstance* inst;
+    Catalog* cat = acquire_initialized_catalog(env, &inst);
+    if (!cat) {
+        return NULL;
+    }
 
-    napi_value val;
+    Arena* arena = thread_arena();
+    ArenaMark mark = arena_mark(arena);
+    uint64_t* excluded_bits = ARENA_ARRAY(arena, uint64_t, cat->words);
+    int32_t* out_indices = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_sets = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_reps = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_groups = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    if (!excluded_bits || !out_indices || !out_sets || !out_reps || !out_groups) {
+        arena_release(arena, mark);
+        catalog_release(cat);
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
 
-    napi_get_named_property(env, args[0], "timeAvailableSeconds", &val);
-    napi_get_value_int32(env, val, &req.time_available_seconds);
+    PROFILE_BEGIN(decode);
+    SolverRequest req;
+    if (!read_request(env, args[0], cat, &req, excluded_bits)) {
+        arena_release(arena, mark);
+        catalog_release(cat);
+        return NULL;
+    }
+    PROFILE_END(decode, PROFILE_MARSHAL);
 
-    napi_get_named_property(env, args[0], "location", &val);
-    napi_get_value_int32(env, val, &req.location);
+    // Solve
+    int32_t count = solve_cached(&inst->cache, cat, &req, out_indices, out_sets, out_reps, out_groups,
+                                 cat->exercise_count);
+    catalog_release(cat);
+
+    PROFILE_BEGIN(encode);
+    const int32_t* groups = req.max_group_size > 1 ? out_groups : NULL;
+    napi_value result = create_plan_array(env, out_indices, out_sets, out_reps, groups, count);
+    PROFILE_END(encode, PROFILE_MARSHAL);
+    arena_release(arena, mark);
+    return result;
+}
 
-    napi_get_named_property(env, args[0], "equipmentMask", &val);
-    napi_get_value_int32(env, val, &req.equipment_mask);
+/**
+ * Solve a multi-session program (e.g. a weekly split) in one call
+ * args[0] = request object, args[1] = array of session day offsets
+ * Returns [{ day, exercises: [{ index, sets, reps, group? }] }]
+ */
+static napi_value SolveProgram(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
 
-    napi_get_named_property(env, args[0], "goalsMask", &val);
-    napi_get_value_int32(env, val, &req.goals_mask);
+    bool is_array = false;
+    if (argc >= 2) {
+        napi_is_array(env, args[1], &is_array);
+    }
+    if (!is_array) {
+        napi_throw_error(env, NULL, "Expected request object and array of session days");
+        return NULL;
+    }
 
-    napi_get_named_property(env, args[0], "fitnessLevel", &val);
-    napi_get_value_int32(env, val, &req.fitness_level);
+    uint32_t day_len;
+    napi_get_array_length(env, args[1], &day_len);
+    if (day_len > MAX_PROGRAM_SESSIONS) {
+        napi_throw_range_error(env, NULL, "Too many sessions");
+        return NULL;
+    }
 
-    napi_get_named_property(env, args[0], "excludedMusclesMask", &val);
-    napi_get_value_int32(env, val, &req.excluded_muscles_mask);
+    int32_t session_days[MAX_PROGRAM_SESSIONS];
+    for (uint32_t i = 0; i < day_len; i++) {
+        napi_value day_val;
+        napi_get_element(env, args[1], i, &day_val);
+        session_days[i] = 0;
+        napi_get_value_int32(env, day_val, &session_days[i]);
+        if (session_days[i] < 0 || (i > 0 && session_days[i] < session_days[i - 1])) {
+            napi_throw_range_error(env, NULL, "Session days must be non-negative and ascending");
+            return NULL;
+        }
+    }
 
-    napi_get_named_property(env, args[0], "recent24hMusclesMask", &val);
-    napi_get_value_int32(env, val, &req.recent_24h_muscles_mask);
+    SolverInstance* inst;
+    Catalog* cat = acquire_initialized_catalog(env, &inst);
+    if (!cat) {
+        return NULL;
+    }
 
-    napi_get_named_property(env, args[0], "recent48hMusclesMask", &val);
-    napi_get_value_int32(env, val, &req.recent_48h_muscles_mask);
+    Arena* arena = thread_arena();
+    ArenaMark mark = arena_mark(arena);
+    uint64_t* excluded_bits = ARENA_ARRAY(arena, uint64_t, cat->words);
+    int32_t* out_indices = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_sets = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_reps = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    int32_t* out_groups = ARENA_ARRAY(arena, int32_t, cat->exercise_count);
+    if (!excluded_bits || !out_indices || !out_sets || !out_reps || !out_groups) {
+        arena_release(arena, mark);
+        catalog_release(cat);
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
 
-    // Get excluded exercises mask array
-    napi_value excluded_arr;
-    napi_get_named_property(env, args[0], "excludedExercisesMask", &excluded_arr);
-    bool is_excluded_array;
-    napi_is_array(env, excluded_arr, &is_excluded_array);
-    if (is_excluded_array) {
-        uint32_t ex_len;
-        napi_get_array_length(env, excluded_arr, &ex_len);
-        if (ex_len > 16) ex_len = 16;
-        for (uint32_t i = 0; i < ex_len; i++) {
-            napi_value ex_val;
-            napi_get_element(env, excluded_arr, i, &ex_val);
-            napi_get_value_int32(env, ex_val, &req.excluded_exercises_mask[i]);
-        }
+    PROFILE_BEGIN(decode);
+    SolverRequest req;
+    if (!read_request(env, args[0], cat, &req, excluded_bits)) {
+        arena_release(arena, mark);
+        catalog_release(cat);
+        return NULL;
     }
+    PROFILE_END(decode, PROFILE_MARSHAL);
 
-    // Solve
-    int32_t out_indices[MAX_EXERCISES];
-    int32_t out_sets[MAX_EXERCISES];
-    int32_t out_reps[MAX_EXERCISES];
+    int32_t out_counts[MAX_PROGRAM_SESSIONS];
 
-    int32_t count = solve(&req, out_indices, out_sets, out_reps, MAX_EXERCISES);
+    solve_program(cat, &req, session_days, (int32_t)day_len, out_counts, out_indices, out_sets, out_reps, out_groups);
+    catalog_release(cat);
 
-    // Build result array
+    PROFILE_BEGIN(encode);
     napi_value result;
-    napi_create_array_with_length(env, count, &result);
-
-    for (int32_t i = 0; i < count; i++) {
-        napi_value item;
-        napi_create_object(env, &item);
+    napi_create_array_with_length(env, day_len, &result);
 
-        napi_value idx_val, sets_val, reps_val;
-        napi_create_int32(env, out_indices[i], &idx_val);
-        napi_create_int32(env, out_sets[i], &sets_val);
-        napi_create_int32(env, out_reps[i], &reps_val);
+    int32_t offset = 0;
+    for (uint32_t i = 0; i < day_len; i++) {
+        napi_value session, day_val, exercises;
+        napi_create_object(env, &session);
+        napi_create_int32(env, session_days[i], &day_val);
+        exercises = create_plan_array(env, out_indices + offset, out_sets + offset, out_reps + offset,
+                                      req.max_group_size > 1 ? out_groups + offset : NULL, out_counts[i]);
 
-        napi_set_named_property(env, item, "index", idx_val);
-        napi_set_named_property(env, item, "sets", sets_val);
-        napi_set_named_property(env, item, "reps", reps_val);
+        napi_set_named_property(env, session, "day", day_val);
+        napi_set_named_property(env, session, "exercises", exercises);
+        napi_set_element(env, result, i, session);
 
-        napi_set_element(env, result, i, item);
+        offset += out_counts[i];
     }
+    PROFILE_END(encode, PROFILE_MARSHAL);
 
+    arena_release(arena, mark);
     return result;
 }
 
@@ -545,20 +3073,21 @@ static napi_value Solve(napi_env env, napi_callback_info info) {
  * Score a batch of exercises (for debugging/benchmarking)
  */
 static napi_value ScoreBatch(napi_env env, napi_callback_info info) {
-    if (!g_initialized) {
-        napi_throw_error(env, NULL, "Not initialized");
-        return NULL;
-    }
-
     size_t argc = 2;
     napi_value args[2];
     napi_get_cb_info(env, info, &argc, args, NULL, NULL);
 
+    SolverInstance* inst;
+    Catalog* cat = acquire_initialized_catalog(env, &inst);
+    if (!cat) {
+        return NULL;
+    }
+
     // args[0] = array of exercise indices
     // args[1] = request object
 
     SolverRequest req = {0};
-    req.weights = (ScoringWeights){10.0f, 5.0f, -20.0f, -10.0f, 5.0f, 15.0f};
+    req.weights = DEFAULT_WEIGHTS;
 
     napi_value val;
     napi_get_named_property(env, args[1], "goalsMask", &val);
@@ -573,12 +3102,18 @@ static napi_value ScoreBatch(napi_env env, napi_callback_info info) {
     napi_get_named_property(env, args[1], "recent48hMusclesMask", &val);
     napi_get_value_int32(env, val, &req.recent_48h_muscles_mask);
 
+    napi_get_named_property(env, args[1], "weights", &val);
+    read_weights(env, val, &req.weights);
+
     uint32_t length;
     napi_get_array_length(env, args[0], &length);
 
     napi_value result;
     napi_create_array_with_length(env, length, &result);
 
+    StaticTerms terms;
+    static_terms(&req, &terms);
+
     for (uint32_t i = 0; i < length; i++) {
         napi_value idx_val;
         napi_get_element(env, args[0], i, &idx_val);
@@ -587,8 +3122,8 @@ static napi_value ScoreBatch(napi_env env, napi_callback_info info) {
         napi_get_value_int32(env, idx_val, &idx);
 
         float score = 0.0f;
-        if (idx >= 0 && idx < g_exercise_count) {
-            score = score_exercise(&g_exercises[idx], &req, 0);
+        if (idx >= 0 && idx < cat->exercise_count) {
+            score = score_exercise(cat, idx, &req, &terms, 0);
         }
 
         napi_value score_val;
@@ -596,6 +3131,293 @@ static napi_value ScoreBatch(napi_env env, napi_callback_info info) {
         napi_set_element(env, result, i, score_val);
     }
 
+    catalog_release(cat);
+    return result;
+}
+
+/**
+ * Async state for EvaluateWeights
+ * Owns copies of the inputs so JS may reuse its buffers immediately
+ */
+typedef struct {
+    WeightEvaluation eval;
+    Catalog* cat;                        // Reference held until completion
+    float* weights;
+    int32_t* requests;
+    int32_t thread_count;
+    EvaluationStatus status;
+    napi_deferred deferred;
+    napi_async_work work;
+} EvaluateWork;
+
+static void evaluate_weights_execute(napi_env env, void* data) {
+    (void)env;
+    EvaluateWork* job = data;
+    job->status = run_weight_evaluation(&job->eval, job->thread_count);
+}
+
+static void evaluate_weights_complete(napi_env env, napi_status status, void* data) {
+    EvaluateWork* job = data;
+    WeightEvaluation* eval = &job->eval;
+
+    if (status != napi_ok || job->status != EVAL_OK) {
+        const char* text = status != napi_ok ? "Evaluation cancelled"
+                         : job->status == EVAL_THREAD_FAILED ? "Cannot start evaluation threads"
+                         : "Out of memory";
+        napi_value message, error;
+        napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &error);
+        napi_reject_deferred(env, job->deferred, error);
+    } else {
+        napi_value result;
+        napi_create_array_with_length(env, eval->weight_count, &result);
+
+        // Aggregate in request order so results are independent of scheduling
+        for (int32_t w = 0; w < eval->weight_count; w++) {
+            const PlanMetrics* metrics = eval->metrics + (size_t)w * eval->request_count;
+            double utilization = 0.0, coverage = 0.0, exercises = 0.0;
+            int32_t empty = 0;
+            for (int32_t r = 0; r < eval->request_count; r++) {
+                utilization += metrics[r].time_utilization;
+                coverage += metrics[r].coverage;
+                exercises += metrics[r].exercise_count;
+                if (metrics[r].exercise_count == 0) empty++;
+            }
+            double n = eval->request_count > 0 ? (double)eval->request_count : 1.0;
+
+            napi_value entry, val;
+            napi_create_object(env, &entry);
+            napi_create_double(env, utilization / n, &val);
+            napi_set_named_property(env, entry, "timeUtilization", val);
+            napi_create_double(env, coverage / n, &val);
+            napi_set_named_property(env, entry, "coverage", val);
+            napi_create_double(env, exercises / n, &val);
+            napi_set_named_property(env, entry, "exercises", val);
+            napi_create_int32(env, empty, &val);
+            napi_set_named_property(env, entry, "emptyPlans", val);
+            napi_set_element(env, result, w, entry);
+        }
+        napi_resolve_deferred(env, job->deferred, result);
+    }
+
+    napi_delete_async_work(env, job->work);
+    catalog_release(job->cat);
+    free(eval->metrics);
+    free(job->weights);
+    free(job->requests);
+    free(job);
+}
+
+/**
+ * Evaluate many scoring-weight vectors against many requests (offline tuning)
+ * args[0] = weight matrix, EVAL_WEIGHT_FIELDS numbers per vector
+ *           (goalAlignment, compoundPreference, recoveryPenalty24h,
+ *           recoveryPenalty48h, fitnessLevelMatch, muscleCoverageGap)
+ * args[1] = packed requests (Int32Array), EVAL_REQUEST_FIELDS per request
+ * args[2] = optional { threads }: at most EVAL_DEFAULT_THREADS by default; all
+ *           calls share one worker thread per online CPU
+ * Returns Promise<[{ timeUtilization, coverage, exercises, emptyPlans }]>,
+ * one entry per weight vector, averaged over the requests
+ */
+static napi_value EvaluateWeights(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 2) {
+        napi_throw_error(env, NULL, "Expected weight matrix and packed requests");
+        return NULL;
+    }
+
+    size_t weight_len, request_len;
+    double* weight_values = read_numeric_array(env, args[0], &weight_len);
+    double* request_values = read_numeric_array(env, args[1], &request_len);
+    if (!weight_values || !request_values) {
+        free(weight_values);
+        free(request_values);
+        napi_throw_type_error(env, NULL, "Expected numeric arrays");
+        return NULL;
+    }
+    if (weight_len == 0 || weight_len % EVAL_WEIGHT_FIELDS != 0 ||
+        request_len % EVAL_REQUEST_FIELDS != 0 ||
+        weight_len / EVAL_WEIGHT_FIELDS > INT32_MAX || request_len / EVAL_REQUEST_FIELDS > INT32_MAX) {
+        free(weight_values);
+        free(request_values);
+        napi_throw_range_error(env, NULL, "Weight matrix or request array has the wrong length");
+        return NULL;
+    }
+
+    int32_t thread_count = default_evaluation_threads();
+    if (argc >= 3) {
+        napi_valuetype type;
+        napi_typeof(env, args[2], &type);
+        if (type == napi_object) {
+            napi_value val;
+            int32_t threads;
+            napi_get_named_property(env, args[2], "threads", &val);
+            if (napi_get_value_int32(env, val, &threads) == napi_ok && threads > 0) {
+                thread_count = threads > EVAL_MAX_THREADS ? EVAL_MAX_THREADS : threads;
+            }
+        }
+    }
+
+    SolverInstance* inst;
+    Catalog* cat = acquire_initialized_catalog(env, &inst);
+    if (!cat) {
+        free(weight_values);
+        free(request_values);
+        return NULL;
+    }
+
+    EvaluateWork* job = calloc(1, sizeof(EvaluateWork));
+    int32_t weight_count = (int32_t)(weight_len / EVAL_WEIGHT_FIELDS);
+    int32_t request_count = (int32_t)(request_len / EVAL_REQUEST_FIELDS);
+    if (job) {
+        job->weights = malloc(weight_len * sizeof(float));
+        job->requests = malloc((request_len ? request_len : 1) * sizeof(int32_t));
+        job->eval.metrics = calloc((size_t)weight_count * (size_t)(request_count ? request_count : 1), sizeof(PlanMetrics));
+    }
+    if (!job || !job->weights || !job->requests || !job->eval.metrics) {
+        if (job) {
+            free(job->weights);
+            free(job->requests);
+            free(job->eval.metrics);
+            free(job);
+        }
+        free(weight_values);
+        free(request_values);
+        catalog_release(cat);
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < weight_len; i++) job->weights[i] = (float)weight_values[i];
+    for (size_t i = 0; i < request_len; i++) job->requests[i] = (int32_t)request_values[i];
+    free(weight_values);
+    free(request_values);
+
+    job->cat = cat;
+    job->thread_count = thread_count;
+    job->eval.cat = cat;
+    job->eval.weights = job->weights;
+    job->eval.weight_count = weight_count;
+    job->eval.requests = job->requests;
+    job->eval.request_count = request_count;
+
+    napi_value promise, name;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "evaluateWeights", NAPI_AUTO_LENGTH, &name);
+    napi_create_async_work(env, NULL, name, evaluate_weights_execute, evaluate_weights_complete, job, &job->work);
+    napi_queue_async_work(env, job->work);
+
+    return promise;
+}
+
+/**
+ * Get result cache statistics
+ * Returns { hits, misses, evictions, entries, capacity }
+ */
+static napi_value GetCacheStats(napi_env env, napi_callback_info info) {
+    (void)info;
+
+    SolverInstance* inst = NULL;
+    napi_get_instance_data(env, (void**)&inst);
+    ResultCache* cache = &inst->cache;
+
+    pthread_mutex_lock(&cache->lock);
+    double hits = (double)cache->hits;
+    double misses = (double)cache->misses;
+    double evictions = (double)cache->evictions;
+    int32_t entries = cache->size;
+    pthread_mutex_unlock(&cache->lock);
+
+    napi_value result, val;
+    napi_create_object(env, &result);
+
+    napi_create_double(env, hits, &val);
+    napi_set_named_property(env, result, "hits", val);
+    napi_create_double(env, misses, &val);
+    napi_set_named_property(env, result, "misses", val);
+    napi_create_double(env, evictions, &val);
+    napi_set_named_property(env, result, "evictions", val);
+    napi_create_int32(env, entries, &val);
+    napi_set_named_property(env, result, "entries", val);
+    napi_create_int32(env, CACHE_CAPACITY, &val);
+    napi_set_named_property(env, result, "capacity", val);
+
+    return result;
+}
+
+/**
+ * Get profiling statistics aggregated over all threads
+ * Returns { enabled: false } unless built with -DSOLVER_PROFILE, else
+ * { enabled: true, threads, series: { name: { count, sum, histogram } } }
+ * Phase series (marshal, filter, score, select) are in nanoseconds;
+ * histogram[b] counts values in [2^(b-1), 2^b), trimmed after the last
+ * non-empty bucket
+ */
+static napi_value GetSolverStats(napi_env env, napi_callback_info info) {
+    (void)info;
+
+    napi_value result, val;
+    napi_create_object(env, &result);
+
+#ifdef SOLVER_PROFILE
+    static const char* const names[PROFILE_SERIES_COUNT] = {
+        "marshal", "filter", "score", "select", "candidates", "rounds", "selected"
+    };
+
+    uint64_t count[PROFILE_SERIES_COUNT] = {0};
+    uint64_t sum[PROFILE_SERIES_COUNT] = {0};
+    uint64_t histogram[PROFILE_SERIES_COUNT][PROFILE_BUCKETS] = {{0}};
+    int32_t threads = 0;
+
+    pthread_mutex_lock(&g_profile_lock);
+    for (ThreadProfile* profile = &g_profile_retired; profile;
+         profile = profile == &g_profile_retired ? g_profiles : profile->next) {
+        if (profile != &g_profile_retired) threads++;
+        for (int32_t s = 0; s < PROFILE_SERIES_COUNT; s++) {
+            const ProfileCounter* counter = &profile->series[s];
+            count[s] += atomic_load_explicit(&counter->count, memory_order_relaxed);
+            sum[s] += atomic_load_explicit(&counter->sum, memory_order_relaxed);
+            for (int32_t b = 0; b < PROFILE_BUCKETS; b++) {
+                histogram[s][b] += atomic_load_explicit(&counter->histogram[b], memory_order_relaxed);
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_profile_lock);
+
+    napi_get_boolean(env, true, &val);
+    napi_set_named_property(env, result, "enabled", val);
+    napi_create_int32(env, threads, &val);
+    napi_set_named_property(env, result, "threads", val);
+
+    napi_value series;
+    napi_create_object(env, &series);
+    for (int32_t s = 0; s < PROFILE_SERIES_COUNT; s++) {
+        int32_t used = PROFILE_BUCKETS;
+        while (used > 0 && histogram[s][used - 1] == 0) used--;
+
+        napi_value entry, buckets;
+        napi_create_object(env, &entry);
+        napi_create_double(env, (double)count[s], &val);
+        napi_set_named_property(env, entry, "count", val);
+        napi_create_double(env, (double)sum[s], &val);
+        napi_set_named_property(env, entry, "sum", val);
+        napi_create_array_with_length(env, (size_t)used, &buckets);
+        for (int32_t b = 0; b < used; b++) {
+            napi_create_double(env, (double)histogram[s][b], &val);
+            napi_set_element(env, buckets, (uint32_t)b, val);
+        }
+        napi_set_named_property(env, entry, "histogram", buckets);
+        napi_set_named_property(env, series, names[s], entry);
+    }
+    napi_set_named_property(env, result, "series", series);
+#else
+    napi_get_boolean(env, false, &val);
+    napi_set_named_property(env, result, "enabled", val);
+#endif
+
     return result;
 }
 
@@ -603,8 +3425,17 @@ static napi_value ScoreBatch(napi_env env, napi_callback_info info) {
  * Get exercise count (for testing)
  */
 static napi_value GetExerciseCount(napi_env env, napi_callback_info info) {
+    (void)info;
+
+    SolverInstance* inst = NULL;
+    napi_get_instance_data(env, (void**)&inst);
+
+    Catalog* cat = catalog_acquire(inst);
+    int32_t count = cat ? cat->exercise_count : 0;
+    catalog_release(cat);
+
     napi_value result;
-    napi_create_int32(env, g_exercise_count, &result);
+    napi_create_int32(env, count, &result);
     return result;
 }
 
@@ -612,17 +3443,39 @@ static napi_value GetExerciseCount(napi_env env, napi_callback_info info) {
  * Module initialization
  */
 static napi_value Init(napi_env env, napi_value exports) {
+    SolverInstance* inst = instance_create();
+    if (!inst) {
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+    napi_set_instance_data(env, inst, instance_finalize, NULL);
+
     napi_value fn;
 
     napi_create_function(env, NULL, 0, InitExercises, NULL, &fn);
     napi_set_named_property(env, exports, "initExercises", fn);
 
+    napi_create_function(env, NULL, 0, LoadCatalogFile, NULL, &fn);
+    napi_set_named_property(env, exports, "loadCatalogFile", fn);
+
     napi_create_function(env, NULL, 0, Solve, NULL, &fn);
     napi_set_named_property(env, exports, "solve", fn);
 
+    napi_create_function(env, NULL, 0, SolveProgram, NULL, &fn);
+    napi_set_named_property(env, exports, "solveProgram", fn);
+
     napi_create_function(env, NULL, 0, ScoreBatch, NULL, &fn);
     napi_set_named_property(env, exports, "scoreBatch", fn);
 
+    napi_create_function(env, NULL, 0, EvaluateWeights, NULL, &fn);
+    napi_set_named_property(env, exports, "evaluateWeights", fn);
+
+    napi_create_function(env, NULL, 0, GetCacheStats, NULL, &fn);
+    napi_set_named_property(env, exports, "getCacheStats", fn);
+
+    napi_create_function(env, NULL, 0, GetSolverStats, NULL, &fn);
+    napi_set_named_property(env, exports, "getSolverStats", fn);
+
     napi_create_function(env, NULL, 0, GetExerciseCount, NULL, &fn);
     napi_set_named_property(env, exports, "getExerciseCount", fn);
 
@@ -630,3 +3483,5 @@ static napi_value Init(napi_env env, napi_value exports) {
 }
 
 NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
+
+#endif // SOLVER_NO_NAPI
@@ -0,0 +1,525 @@
+#!/usr/bin/env node
+/**
+ * N-API binding tests for the constraint solver
+ *
+ * Usage: node test/binding-test.js (from apps/api/native; or `npm test`)
+ *
+ * Compiles src/constraint-solver.c against the running node's headers into
+ * build/test/solver.node, loads the exercise catalog built by
+ * native/tools/build-catalog.js, and checks the binding's behaviour:
+ *
+ * - a request whose getters or Object.prototype setters call back into
+ *   solve()/solveProgram() on the same thread plans exactly like the plain
+ *   request (each call releases only its own scratch arena)
+ * - maxGroupSize above the solver's MAX_GROUP_SIZE is a RangeError
+ * - the result cache: hits for repeated and equivalent requests, a miss
+ *   for any change to a keyed field, LRU eviction, invalidation on reload
+ * - patternQuotas and maxAntagonistImbalance hold in every session
+ * - a seed reproduces its plan from scratch; other seeds vary it
+ * - supersets/circuits: adjacent members, bounded size, disjoint muscles
+ * - solveProgram sessions: one per day, no repeats, day 0 plans like solve()
+ * - concurrent evaluateWeights() calls, whatever threads they ask for,
+ *   agree with a single-threaded evaluation, and with solve() per request
+ * - the regression set: the requests in test/regression/requests.json
+ *   (solve, or solveProgram when they list days) still produce the plans
+ *   in test/regression/plans.json. After an intended plan change, rewrite
+ *   the plans with `node test/binding-test.js --update-regression` and
+ *   review the diff.
+ */
+
+const assert = require('assert');
+const { execFileSync } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { readSourceCatalog, buildCatalog } = require('../../../../native/tools/build-catalog.js');
+
+const ROOT = path.resolve(__dirname, '..');
+const ADDON = path.join(ROOT, 'build', 'test', 'solver.node');
+const REGRESSION_REQUESTS = path.join(__dirname, 'regression', 'requests.json');
+const REGRESSION_PLANS = path.join(__dirname, 'regression', 'plans.json');
+
+// Solver limits (constraint-solver.c)
+const PATTERN_SLOTS = 7;
+const MAX_MUSCLES = 50;
+
+function buildAddon() {
+  const include = path.join(path.dirname(process.execPath), '..', 'include', 'node');
+  fs.mkdirSync(path.dirname(ADDON), { recursive: true });
+  execFileSync(process.env.CC || 'cc', [
+    '-O2', '-std=c11', '-D_GNU_SOURCE', '-Wall', '-Wextra', '-fPIC', '-shared',
+    '-DNODE_GYP_MODULE_NAME=solver', `-I${include}`,
+    '-o', ADDON, path.join(ROOT, 'src', 'constraint-solver.c'), '-lm', '-lpthread',
+  ], { stdio: 'inherit' });
+  return require(ADDON);
+}
+
+function loadCatalog(solver) {
+  const catalog = readSourceCatalog();
+  const file = path.join(os.tmpdir(), `solver-test-${process.pid}.bin`);
+  fs.writeFileSync(file, buildCatalog(catalog));
+  try {
+    solver.loadCatalogFile(file);
+  } finally {
+    fs.unlinkSync(file);
+  }
+  return catalog;
+}
+
+const BASE = {
+  timeAvailableSeconds: 2700,
+  location: 0,
+  equipmentMask: -1,
+  goalsMask: -1,
+  fitnessLevel: 1,
+  maxGroupSize: 2,
+};
+
+let failures = 0;
+
+function check(name, fn) {
+  try {
+    fn();
+    console.log(`ok   ${name}`);
+  } catch (err) {
+    failures++;
+    console.log(`FAIL ${name}\n     ${err.message.split('\n').slice(0, 12).join('\n     ')}`);
+  }
+}
+
+/**
+ * Request object whose `property` getter runs reenter() before answering
+ */
+function reentrantRequest(plain, property, reenter) {
+  const request = { ...plain };
+  const value = request[property];
+  delete request[property];
+  Object.defineProperty(request, property, {
+    enumerable: true,
+    get() {
+      reenter();
+      return value;
+    },
+  });
+  return request;
+}
+
+function testReentry(solver, catalog) {
+  // Exclude the plain plan's first picks so lost exclusions would show
+  const first = solver.solve(BASE);
+  const ids = first.slice(0, 3).map((e) => catalog.exercises[e.index].hash | 0);
+  const plain = { ...BASE, excludedExerciseIds: ids };
+  const expected = solver.solve(plain);
+  const expectedProgram = solver.solveProgram(plain, [0, 2, 4]);
+  const nested = () => {
+    for (let i = 0; i < 4; i++) {
+      solver.solve({ ...BASE, timeAvailableSeconds: 3600 + i * 600 });
+      solver.solveProgram(BASE, [0, 1, 2, 3, 4, 5, 6]);
+    }
+  };
+
+  for (const property of ['timeAvailableSeconds', 'weights', 'excludedExercisesMask']) {
+    check(`solve with a re-entrant ${property} getter`, () => {
+      assert.deepStrictEqual(solver.solve(reentrantRequest(plain, property, nested)), expected);
+    });
+    check(`solveProgram with a re-entrant ${property} getter`, () => {
+      assert.deepStrictEqual(solver.solveProgram(reentrantRequest(plain, property, nested), [0, 2, 4]),
+        expectedProgram);
+    });
+  }
+
+  // Encoding the result sets properties on fresh objects, which runs
+  // setters inherited from Object.prototype
+  check('solve with a re-entrant Object.prototype setter', () => {
+    let depth = 0;
+    Object.defineProperty(Object.prototype, 'reps', {
+      configurable: true,
+      set(value) {
+        Object.defineProperty(this, 'reps', { value, enumerable: true, writable: true, configurable: true });
+        if (depth++ === 0) nested();
+        depth--;
+      },
+    });
+    try {
+      const plan = solver.solve(plain);
+      assert.deepStrictEqual(plan.map((e) => ({ ...e })), expected);
+    } finally {
+      delete Object.prototype.reps;
+    }
+  });
+}
+
+function testValidation(solver) {
+  check('maxGroupSize above the limit is a RangeError', () => {
+    assert.throws(() => solver.solve({ ...BASE, maxGroupSize: 5 }),
+      { name: 'RangeError', message: 'maxGroupSize must be at most 4' });
+    assert.ok(solver.solve({ ...BASE, maxGroupSize: 4 }).length > 0);
+  });
+}
+
+async function checkAsync(name, fn) {
+  try {
+    await fn();
+    console.log(`ok   ${name}`);
+  } catch (err) {
+    failures++;
+    console.log(`FAIL ${name}\n     ${err.message.split('\n').slice(0, 12).join('\n     ')}`);
+  }
+}
+
+async function testEvaluateWeights(solver, catalog) {
+  const weights = [];
+  for (let w = 0; w < 6; w++) weights.push(1.0, 0.5 + w * 0.25, 0.8, 0.3, 0.6, 0.4 + w * 0.1);
+  const requests = [];
+  for (let r = 0; r < 40; r++) {
+    requests.push(900 + r * 90, r % 3, -1, r % 2 ? 0xff : -1, r % 3, 0, r % 5 ? 0 : 0x3, 0);
+  }
+  const packed = Int32Array.from(requests);
+
+  await checkAsync('concurrent evaluateWeights match a single-threaded run', async () => {
+    const expected = await solver.evaluateWeights(weights, packed, { threads: 1 });
+    const results = await Promise.all([1, 2, 4, 64, undefined, 64].map((threads) =>
+      solver.evaluateWeights(weights, packed, threads === undefined ? undefined : { threads })));
+    for (const result of results) assert.deepStrictEqual(result, expected);
+  });
+
+  await checkAsync('evaluateWeights metrics match solve() of each request', async () => {
+    const fields = ['goalAlignment', 'compoundPreference', 'recoveryPenalty24h', 'recoveryPenalty48h',
+      'fitnessLevelMatch', 'muscleCoverageGap'];
+    const results = await solver.evaluateWeights(weights, packed);
+    results.forEach((result, w) => {
+      const vector = weights.slice(w * 6, w * 6 + 6);
+      const weightObject = Object.fromEntries(fields.map((field, i) => [field, vector[i]]));
+      let exercises = 0, coverage = 0, empty = 0;
+      for (let r = 0; r < packed.length; r += 8) {
+        const [time, location, equipment, goals, level, excluded, recent24h, recent48h] = packed.slice(r, r + 8);
+        const plan = solver.solve({
+          timeAvailableSeconds: time, location, equipmentMask: equipment, goalsMask: goals, fitnessLevel: level,
+          excludedMusclesMask: excluded, recent24hMusclesMask: recent24h, recent48hMusclesMask: recent48h,
+          weights: weightObject,
+        });
+        const active = new Set(plan.flatMap((e) => Object.entries(catalog.exercises[e.index].activations)
+          .filter(([muscle, value]) => Number(muscle) < MAX_MUSCLES && value > 0).map(([muscle]) => muscle)));
+        exercises += plan.length;
+        coverage += active.size;
+        if (plan.length === 0) empty++;
+      }
+      const n = packed.length / 8;
+      assert.strictEqual(result.exercises, exercises / n);
+      assert.strictEqual(result.coverage, coverage / n);
+      assert.strictEqual(result.emptyPlans, empty);
+    });
+  });
+}
+
+/**
+ * Exercises per movement pattern (catalog pattern numbers, push..isolation)
+ */
+function patternCounts(catalog, plan) {
+  const counts = new Array(PATTERN_SLOTS).fill(0);
+  for (const e of plan) counts[catalog.exercises[e.index].pattern]++;
+  return counts;
+}
+
+function antagonistImbalance(counts) {
+  return Math.max(Math.abs(counts[0] - counts[1]), Math.abs(counts[2] - counts[3]));
+}
+
+/**
+ * Muscles an exercise works (primary, or activated above 40%), as the
+ * solver's worked mask
+ */
+function workedMask(exercise) {
+  let mask = BigInt(exercise.primary >>> 0);
+  for (const [muscle, value] of Object.entries(exercise.activations)) {
+    if (Number(muscle) < MAX_MUSCLES && value > 40) mask |= 1n << BigInt(muscle);
+  }
+  return mask;
+}
+
+/**
+ * Requests across locations, goals, levels and durations
+ */
+function requestMatrix(extra) {
+  const requests = [];
+  for (const location of [0, 1]) {
+    for (const goalsMask of [1, 2, 4, 8, 16]) {
+      for (const fitnessLevel of [0, 1, 2]) {
+        for (const timeAvailableSeconds of [1200, 2700, 4500]) {
+          requests.push({ ...BASE, location, goalsMask, fitnessLevel, timeAvailableSeconds, ...extra });
+        }
+      }
+    }
+  }
+  return requests;
+}
+
+function cacheDelta(solver, fn) {
+  const before = solver.getCacheStats();
+  const result = fn();
+  const after = solver.getCacheStats();
+  return { result, hits: after.hits - before.hits, misses: after.misses - before.misses };
+}
+
+function testCache(solver, catalog) {
+  check('a repeated request is a cache hit with the same plan', () => {
+    const request = { ...BASE, timeAvailableSeconds: 2701 };
+    const first = cacheDelta(solver, () => solver.solve(request));
+    const second = cacheDelta(solver, () => solver.solve(request));
+    assert.deepStrictEqual([first.misses, first.hits, second.misses, second.hits], [1, 0, 0, 1]);
+    assert.deepStrictEqual(second.result, first.result);
+  });
+
+  check('equivalent requests share a cache entry', () => {
+    const ids = catalog.exercises.slice(0, 3).map((e) => e.hash | 0);
+    const request = { ...BASE, timeAvailableSeconds: 2702, excludedExerciseIds: ids };
+    const first = cacheDelta(solver, () => solver.solve(request));
+    // Exclusion order and duplicates do not matter, nor equipment at the gym
+    const reordered = cacheDelta(solver, () =>
+      solver.solve({ ...request, excludedExerciseIds: [ids[2], ids[0], ids[1], ids[0]] }));
+    const equipment = cacheDelta(solver, () => solver.solve({ ...request, equipmentMask: 0 }));
+    assert.strictEqual(first.misses, 1);
+    assert.deepStrictEqual([reordered.hits, equipment.hits], [1, 1]);
+    assert.deepStrictEqual(reordered.result, first.result);
+    assert.deepStrictEqual(equipment.result, first.result);
+  });
+
+  check('every keyed field separates cache entries, and a reload invalidates them', () => {
+    const request = { ...BASE, timeAvailableSeconds: 2703 };
+    const variants = [
+      request,
+      { ...request, seed: 17 },
+      { ...request, seed: 17, variety: 12 },
+      { ...request, patternQuotas: [1, 1, 1, 1, 0, 0, 0] },
+      { ...request, maxAntagonistImbalance: 1 },
+      { ...request, maxGroupSize: 3 },
+      { ...request, weights: { goalAlignment: 2, muscleCoverageGap: 30 } },
+      { ...request, recent24hMusclesMask: 0x3 },
+    ];
+    const solveAll = () => variants.map((variant) => cacheDelta(solver, () => solver.solve(variant)));
+    solver.solve(request);
+    const cached = solveAll();
+    assert.deepStrictEqual(cached.map((v) => v.misses), [0, 1, 1, 1, 1, 1, 1, 1]);
+
+    loadCatalog(solver);
+    const reloaded = solveAll();
+    assert.deepStrictEqual(reloaded.map((v) => v.misses), variants.map(() => 1));
+    assert.deepStrictEqual(reloaded.map((v) => v.result), cached.map((v) => v.result));
+  });
+
+  check('optimizeMicros requests bypass the cache', () => {
+    const optimized = cacheDelta(solver, () => solver.solve({ ...BASE, optimizeMicros: 200 }));
+    assert.deepStrictEqual([optimized.hits, optimized.misses], [0, 0]);
+    assert.ok(optimized.result.length > 0);
+  });
+
+  check('the cache evicts the least recently used plan', () => {
+    const { capacity, evictions } = solver.getCacheStats();
+    const kept = { ...BASE, timeAvailableSeconds: 2704 };
+    const dropped = { ...BASE, timeAvailableSeconds: 2705 };
+    solver.solve(kept);
+    solver.solve(dropped);
+    for (let i = 0; i < capacity; i++) {
+      solver.solve({ ...BASE, timeAvailableSeconds: 6000 + i });
+      if (i % 16 === 0) solver.solve(kept);
+    }
+    assert.ok(solver.getCacheStats().evictions > evictions);
+    assert.strictEqual(cacheDelta(solver, () => solver.solve(kept)).hits, 1);
+    assert.strictEqual(cacheDelta(solver, () => solver.solve(dropped)).misses, 1);
+  });
+}
+
+function testPatternConstraints(solver, catalog) {
+  const quotas = [1, 1, 1, 1, 0, 1, 0];
+
+  check('patternQuotas hold in every plan and session', () => {
+    let tighter = 0;
+    for (const request of requestMatrix({ patternQuotas: quotas })) {
+      const counts = patternCounts(catalog, solver.solve(request));
+      counts.forEach((count, pattern) => assert.ok(quotas[pattern] === 0 || count <= quotas[pattern],
+        `${count} of pattern ${pattern} with a quota of ${quotas[pattern]}`));
+      const free = patternCounts(catalog, solver.solve({ ...request, patternQuotas: undefined }));
+      if (free.some((count, pattern) => quotas[pattern] > 0 && count > quotas[pattern])) tighter++;
+    }
+    assert.ok(tighter > 0, 'no unconstrained plan exceeds the quotas');
+
+    const entries = JSON.parse(fs.readFileSync(REGRESSION_REQUESTS, 'utf8'));
+    for (const { request, days } of entries.filter((e) => e.request.patternQuotas)) {
+      const sessions = days ? solver.solveProgram(request, days).map((s) => s.exercises) : [solver.solve(request)];
+      for (const plan of sessions) {
+        patternCounts(catalog, plan).forEach((count, pattern) => {
+          const quota = request.patternQuotas[pattern];
+          assert.ok(!(quota > 0) || count <= quota, `${count} of pattern ${pattern} with a quota of ${quota}`);
+        });
+      }
+    }
+  });
+
+  check('maxAntagonistImbalance holds when both sides have candidates', () => {
+    let tighter = 0;
+    for (const request of requestMatrix({ maxAntagonistImbalance: 1 })) {
+      const plan = solver.solve(request);
+      assert.ok(antagonistImbalance(patternCounts(catalog, plan)) <= 1,
+        `imbalance ${antagonistImbalance(patternCounts(catalog, plan))} for ${JSON.stringify(request)}`);
+      const free = solver.solve({ ...request, maxAntagonistImbalance: 0 });
+      if (antagonistImbalance(patternCounts(catalog, free)) > 1) tighter++;
+    }
+    assert.ok(tighter > 0, 'no unconstrained plan exceeds the imbalance');
+  });
+
+  check('zero quotas and imbalance plan like an unconstrained request', () => {
+    for (const request of requestMatrix({})) {
+      assert.deepStrictEqual(solver.solve({ ...request, patternQuotas: [0, 0, 0, 0, 0, 0, 0],
+        maxAntagonistImbalance: 0 }), solver.solve(request));
+    }
+  });
+}
+
+function testSeeds(solver) {
+  const request = { ...BASE, timeAvailableSeconds: 3000 };
+
+  check('a seed reproduces its plan from scratch', () => {
+    const seeds = [1, 2, 99, 123456789, 0xffffffff];
+    const plans = seeds.map((seed) => solver.solve({ ...request, seed }));
+    const programs = seeds.map((seed) => solver.solveProgram({ ...request, seed }, [0, 2, 4]));
+    loadCatalog(solver); // Drops cached plans, so these are solved again
+    seeds.forEach((seed, i) => {
+      const again = cacheDelta(solver, () => solver.solve({ ...request, seed }));
+      assert.strictEqual(again.misses, 1);
+      assert.deepStrictEqual(again.result, plans[i]);
+      assert.deepStrictEqual(solver.solveProgram({ ...request, seed }, [0, 2, 4]), programs[i]);
+    });
+  });
+
+  check('different seeds vary the plan', () => {
+    const plans = new Set();
+    for (let seed = 1; seed <= 8; seed++) plans.add(JSON.stringify(solver.solve({ ...request, seed })));
+    assert.ok(plans.size >= 4, `${plans.size} distinct plans from 8 seeds`);
+  });
+
+  check('seed 0, or a seed with variety 0, plans like an unseeded request', () => {
+    const plain = solver.solve(request);
+    assert.deepStrictEqual(solver.solve({ ...request, seed: 0 }), plain);
+    assert.deepStrictEqual(solver.solve({ ...request, seed: 42, variety: 0 }), plain);
+  });
+}
+
+function testGroups(solver, catalog) {
+  check('grouped plans: adjacent members, bounded size, disjoint worked muscles', () => {
+    let shared = 0;
+    for (const maxGroupSize of [2, 3, 4]) {
+      for (const request of requestMatrix({ maxGroupSize })) {
+        const plan = solver.solve(request);
+        const seen = new Set();
+        for (let i = 0; i < plan.length;) {
+          const group = plan[i].group;
+          assert.ok(Number.isInteger(group) && !seen.has(group), `group ${group} is split or missing`);
+          seen.add(group);
+          let end = i;
+          while (end < plan.length && plan[end].group === group) end++;
+          assert.ok(end - i <= maxGroupSize, `group of ${end - i} with maxGroupSize ${maxGroupSize}`);
+          if (end - i > 1) shared++;
+          let worked = 0n;
+          for (let m = i; m < end; m++) {
+            const mask = workedMask(catalog.exercises[plan[m].index]);
+            assert.strictEqual(worked & mask, 0n, `group ${group} members work the same muscle`);
+            worked |= mask;
+          }
+          i = end;
+        }
+      }
+    }
+    assert.ok(shared > 0, 'no plan grouped any exercises');
+  });
+
+  check('ungrouped plans carry no group', () => {
+    for (const maxGroupSize of [0, 1]) {
+      assert.ok(solver.solve({ ...BASE, maxGroupSize }).every((e) => !('group' in e)));
+    }
+    const program = solver.solveProgram({ ...BASE, maxGroupSize: 2 }, [0, 2]);
+    assert.ok(program.every((session) => session.exercises.every((e) => Number.isInteger(e.group))));
+  });
+}
+
+function testProgram(solver) {
+  check('solveProgram: a session per day, no repeats, day 0 plans like solve()', () => {
+    for (const request of requestMatrix({})) {
+      const days = [0, 1, 3, 4, 6];
+      const program = solver.solveProgram(request, days);
+      assert.deepStrictEqual(program.map((session) => session.day), days);
+      const indices = program.flatMap((session) => session.exercises.map((e) => e.index));
+      assert.strictEqual(new Set(indices).size, indices.length, 'an exercise repeats across sessions');
+      assert.deepStrictEqual(program[0].exercises, solver.solve(request));
+    }
+  });
+
+  check('solveProgram rejects bad session days', () => {
+    assert.throws(() => solver.solveProgram(BASE, [2, 1]),
+      { name: 'RangeError', message: 'Session days must be non-negative and ascending' });
+    assert.throws(() => solver.solveProgram(BASE, [-1]), { name: 'RangeError' });
+    assert.throws(() => solver.solveProgram(BASE, Array.from({ length: 15 }, (_, i) => i)),
+      { name: 'RangeError', message: 'Too many sessions' });
+    assert.deepStrictEqual(solver.solveProgram(BASE, []), []);
+  });
+}
+
+/**
+ * Plan as catalog exercise IDs: "ID setsxreps", plus "gN" when grouped
+ */
+function describePlan(catalog, plan) {
+  return plan.map((e) => `${catalog.exercises[e.index].id} ${e.sets}x${e.reps}` +
+    (e.group === undefined ? '' : ` g${e.group}`));
+}
+
+function runRegressionEntry(solver, catalog, entry) {
+  if (!entry.days) return describePlan(catalog, solver.solve(entry.request));
+  return solver.solveProgram(entry.request, entry.days)
+    .map((session) => ({ day: session.day, plan: describePlan(catalog, session.exercises) }));
+}
+
+function testRegression(solver, catalog) {
+  const entries = JSON.parse(fs.readFileSync(REGRESSION_REQUESTS, 'utf8'));
+  const plans = entries.map((entry) => runRegressionEntry(solver, catalog, entry));
+  if (process.argv.includes('--update-regression')) {
+    fs.writeFileSync(REGRESSION_PLANS, `[\n${plans.map((p) => `  ${JSON.stringify(p)}`).join(',\n')}\n]\n`);
+    console.log(`wrote ${plans.length} plans to ${path.relative(ROOT, REGRESSION_PLANS)}`);
+    return;
+  }
+
+  check(`regression set (${entries.length} requests) plans unchanged`, () => {
+    const expected = JSON.parse(fs.readFileSync(REGRESSION_PLANS, 'utf8'));
+    assert.strictEqual(plans.length, expected.length);
+    const changed = [];
+    plans.forEach((plan, i) => {
+      try {
+        assert.deepStrictEqual(plan, expected[i]);
+      } catch (err) {
+        changed.push(i);
+      }
+    });
+    if (changed.length > 0) {
+      assert.fail(`${changed.length} request(s) plan differently: ${changed.slice(0, 20).join(', ')}`);
+    }
+  });
+}
+
+async function main() {
+  const solver = buildAddon();
+  const catalog = loadCatalog(solver);
+  testReentry(solver, catalog);
+  testValidation(solver);
+  testRegression(solver, catalog);
+  testCache(solver, catalog);
+  testPatternConstraints(solver, catalog);
+  testSeeds(solver);
+  testGroups(solver, catalog);
+  testProgram(solver);
+  await testEvaluateWeights(solver, catalog);
+  if (failures > 0) {
+    console.log(`${failures} binding test(s) failed`);
+    process.exit(1);
+  }
+  console.log('All binding tests passed');
+}
+
+main();
@@ -0,0 +1,112 @@
+/**
+ * Scoring consistency test (run by `npm test`)
+ *
+ * scoreBatch scores one exercise at a time with score_exercise, while
+ * solve ranks candidates with the static kernel plus recovery and
+ * coverage. With fractional weights the two only agree if they add the
+ * same terms in the same order, so this checks them bit for bit over a
+ * synthetic catalog, for every kernel variant this CPU can run.
+ *
+ * Compile: see the "test" script in package.json
+ */
+
+#define SOLVER_NO_NAPI
+#include "../src/constraint-solver.c"
+
+#include "../bench/bench-catalog.h"
+
+#define EXERCISES 5000
+#define REQUESTS 400
+
+static uint32_t xorshift(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* Fractional weight in [-scale, scale) with a non-terminating binary expansion */
+static float fractional(uint32_t* rng, float scale) {
+    return ((float)(xorshift(rng) % 20000) / 10000.0f - 1.0f) * scale + 0.1f;
+}
+
+/**
+ * Compare solve's candidate scores against score_exercise for one kernel
+ * Returns the number of candidates whose scores differ
+ */
+static int32_t check_kernel(const Catalog* cat, ScoreStaticFn kernel, const char* name) {
+    int32_t* candidates = malloc((size_t)cat->exercise_count * sizeof(int32_t));
+    float* base = malloc((size_t)cat->exercise_count * sizeof(float));
+    if (!candidates || !base) return 1;
+
+    score_static_kernel = kernel;
+    uint32_t rng = 2024;
+    int32_t mismatches = 0;
+    for (int32_t r = 0; r < REQUESTS; r++) {
+        SolverRequest req = {0};
+        req.location = 0;
+        req.goals_mask = (int32_t)(xorshift(&rng) & 0x1f);
+        req.fitness_level = (int32_t)(xorshift(&rng) % 5) - 1;
+        req.recent_24h_muscles_mask = (int32_t)xorshift(&rng);
+        req.recent_48h_muscles_mask = (int32_t)xorshift(&rng);
+        req.weights = (ScoringWeights){
+            fractional(&rng, 12.0f), fractional(&rng, 6.0f), fractional(&rng, 20.0f),
+            fractional(&rng, 10.0f), fractional(&rng, 6.0f), fractional(&rng, 15.0f),
+        };
+
+        int32_t count = filter_candidates(cat, &req, candidates);
+        if (count == 0 || !score_candidates(cat, &req, candidates, count, NULL, base)) {
+            printf("FAIL %s: request %d has no scored candidates\n", name, r);
+            mismatches++;
+            continue;
+        }
+
+        StaticTerms terms;
+        static_terms(&req, &terms);
+        for (int32_t p = 0; p < count; p++) {
+            int32_t idx = candidates[p];
+            uint64_t active = cat->active_muscles_mask[idx];
+            float ranked = base[p] + score_coverage(active, &req, 0);
+            float batch = score_exercise(cat, idx, &req, &terms, 0);
+            if (memcmp(&ranked, &batch, sizeof(float)) != 0) {
+                if (mismatches < 5) {
+                    printf("FAIL %s: exercise %d scores %.9g in solve, %.9g in scoreBatch\n", name, idx,
+                           ranked, batch);
+                }
+                mismatches++;
+            }
+        }
+    }
+
+    free(candidates);
+    free(base);
+    return mismatches;
+}
+
+int main(void) {
+    Catalog* cat = synthetic_catalog(EXERCISES, 7);
+    if (!cat) {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    int32_t failures = check_kernel(cat, score_static_baseline, "baseline");
+#if NATIVE_DISPATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        failures += check_kernel(cat, score_static_avx2, "avx2");
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) {
+        failures += check_kernel(cat, score_static_avx512, "avx512");
+    }
+#endif
+
+    free(cat);
+    if (failures != 0) {
+        printf("%d score(s) differ between solve and scoreBatch\n", failures);
+        return 1;
+    }
+    printf("Scoring: solve and scoreBatch agree for fractional weights\n");
+    return 0;
+}
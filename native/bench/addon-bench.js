@@ -0,0 +1,105 @@
+#!/usr/bin/env node
+/**
+ * N-API addon vs ffi-napi call overhead
+ *
+ * Usage: node bench/addon-bench.js [iterations] (default: 200000)
+ *
+ * Times the same library calls through the compiled addon
+ * (build/Release/musclemap_native.node), through ffi-napi against the
+ * Makefile's shared libraries (lib/*.so; skipped unless ffi-napi and
+ * ref-napi are installed by hand, they are not package dependencies) and
+ * through the addon's TypedArray batch variants. Reports
+ * nanoseconds per call, or per element for batches.
+ *
+ * Build first: npm run build:addon && make release
+ */
+
+const path = require('path');
+
+const ROOT = path.resolve(__dirname, '..');
+const ITERATIONS = Number(process.argv[2]) || 200000;
+const BATCH = 1024;
+
+function loadFfi() {
+  let ffi, ref;
+  try {
+    ffi = require('ffi-napi');
+    ref = require('ref-napi');
+  } catch {
+    return null;
+  }
+  const lib = (name) => path.join(ROOT, 'lib', name);
+  const geo = ffi.Library(lib('libgeo'), {
+    geohash_encode: ['int', ['double', 'double', 'int', 'char *']],
+    haversine_meters: ['double', ['double', 'double', 'double', 'double']],
+  });
+  const ratelimit = ffi.Library(lib('libratelimit'), {
+    ratelimit_create: ['pointer', ['size_t', 'uint32']],
+    ratelimit_check: ['int', ['pointer', 'uint64', 'uint32']],
+  });
+  return { geo, ratelimit, ref };
+}
+
+/**
+ * Run fn `iterations` times after a short warmup; returns ns per call
+ */
+function time(fn, iterations) {
+  for (let i = 0; i < Math.min(iterations, 10000); i++) fn(i);
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < iterations; i++) fn(i);
+  return Number(process.hrtime.bigint() - start) / iterations;
+}
+
+function report(name, addonNs, ffiNs, batchNs) {
+  const cell = (ns) => (ns == null ? '-' : ns.toFixed(1)).padStart(10);
+  console.log(`${name.padEnd(18)}${cell(addonNs)}${cell(ffiNs)}${cell(batchNs)}`);
+}
+
+function main() {
+  const addon = require(path.join(ROOT, 'build', 'Release', 'musclemap_native.node'));
+  const ffi = loadFfi();
+
+  const coords = new Float64Array(BATCH * 2);
+  for (let i = 0; i < BATCH; i++) {
+    coords[2 * i] = -60 + ((i * 37) % 120);
+    coords[2 * i + 1] = -170 + ((i * 53) % 340);
+  }
+  const ids = new BigUint64Array(BATCH);
+  for (let i = 0; i < BATCH; i++) ids[i] = BigInt(i);
+  const distances = new Float64Array(BATCH);
+  const verdicts = new Int8Array(BATCH);
+  const batchIterations = Math.max(1, Math.floor(ITERATIONS / BATCH));
+
+  console.log(`iterations: ${ITERATIONS}, batch size: ${BATCH}${ffi ? '' : ' (ffi-napi not installed)'}`);
+  console.log(`${'ns/call'.padEnd(18)}${'addon'.padStart(10)}${'ffi'.padStart(10)}${'batch'.padStart(10)}`);
+
+  report(
+    'haversineMeters',
+    time((i) => addon.haversineMeters(40.7, -74.0, coords[(i % BATCH) * 2], coords[(i % BATCH) * 2 + 1]), ITERATIONS),
+    ffi && time((i) => ffi.geo.haversine_meters(40.7, -74.0, coords[(i % BATCH) * 2], coords[(i % BATCH) * 2 + 1]), ITERATIONS),
+    time(() => addon.haversineBatch(40.7, -74.0, coords, distances), batchIterations) / BATCH,
+  );
+
+  const hash = ffi && Buffer.alloc(13);
+  report(
+    'geohashEncode',
+    time((i) => addon.geohashEncode(coords[(i % BATCH) * 2], coords[(i % BATCH) * 2 + 1], 9), ITERATIONS),
+    ffi && time((i) => {
+      const len = ffi.geo.geohash_encode(coords[(i % BATCH) * 2], coords[(i % BATCH) * 2 + 1], 9, hash);
+      return hash.toString('ascii', 0, len);
+    }, ITERATIONS),
+    time(() => addon.geohashEncodeBatch(coords, 9), batchIterations) / BATCH,
+  );
+
+  const limiter = addon.ratelimitCreate(BATCH * 2, 0xffffffff);
+  const ffiLimiter = ffi && ffi.ratelimit.ratelimit_create(BATCH * 2, 0xffffffff);
+  report(
+    'ratelimitCheck',
+    time((i) => addon.ratelimitCheck(limiter, i % BATCH), ITERATIONS),
+    ffi && time((i) => ffi.ratelimit.ratelimit_check(ffiLimiter, i % BATCH, 1), ITERATIONS),
+    time(() => addon.ratelimitCheckBatch(limiter, ids, 1, verdicts), batchIterations) / BATCH,
+  );
+  addon.ratelimitDestroy(limiter);
+}
+
+main();
@@ -0,0 +1,271 @@
+/**
+ * Native Benchmark Harness
+ *
+ * Header-only harness shared by the `make bench` suites (native/bench and
+ * the solver suite in apps/api/native/bench):
+ * - Warmup samples, then timed samples; each sample repeats the body
+ *   enough times to last at least --min-sample-us, so tiny functions are
+ *   timed above clock resolution
+ * - Nanosecond (CLOCK_MONOTONIC) and cycle (TSC on x86) timers
+ * - Each sample yields its mean time per operation; min / p50 / p90 /
+ *   p99 are taken over those sample means, alongside the overall mean.
+ *   They are not per-call latency percentiles: one slow call is averaged
+ *   into its sample, so tails read low for cheap bodies
+ * - Optional CPU pinning of the benchmark thread
+ * - Results printed as a table and written as JSON (--json FILE), read by
+ *   bench/compare.js
+ *
+ * Usage in a suite:
+ *   Bench b;
+ *   if (bench_init(&b, "geo", argc, argv) != 0) return 1;
+ *   bench_run(&b, "haversine_meters", fn, ctx, 1.0);
+ *   return bench_finish(&b);
+ *
+ * Common flags: --reps N --warmup N --min-sample-us N --cpu N --filter STR --json FILE
+ *
+ * tools/replay.c uses only the timers, so the suite entry points are
+ * marked unused.
+ */
+
+#ifndef MUSCLEMAP_BENCH_H
+#define MUSCLEMAP_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+#define BENCH_MAX_RESULTS 64
+#define BENCH_MAX_REPS 100000
+
+/* Benchmark body; one call performs ops_per_call operations */
+typedef void (*BenchFn)(void* ctx);
+
+/* Per-operation times; min and percentiles are over per-sample means */
+typedef struct {
+    char name[64];
+    double ops_per_sample;
+    int32_t samples;
+    double min_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double mean_ns;
+    double p50_cycles;                   /* TSC cycles per op (0 without a TSC) */
+} BenchResult;
+
+typedef struct {
+    const char* suite;
+    int32_t warmup;                      /* Untimed samples */
+    int32_t reps;                        /* Timed samples */
+    int32_t min_sample_us;               /* Lower bound on one sample's duration */
+    int32_t cpu;                         /* Pin to this CPU, or -1 */
+    const char* filter;                  /* Only run benchmarks containing this */
+    const char* json_path;
+    BenchResult results[BENCH_MAX_RESULTS];
+    int32_t count;
+} Bench;
+
+/* Keeps benchmark results observable */
+static volatile double bench_sink;
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t bench_cycles(void) {
+#if BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int bench_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double bench_percentile(const double* sorted, int32_t count, double p) {
+    int32_t rank = (int32_t)(p * (double)(count - 1) + 0.5);
+    return sorted[rank];
+}
+
+static void bench_usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--reps N] [--warmup N] [--min-sample-us N] [--cpu N] [--filter STR] [--json FILE]\n",
+            argv0);
+}
+
+/**
+ * Parse the common flags and pin the thread if asked
+ * @return 0 on success, -1 on bad arguments (usage printed)
+ */
+static __attribute__((unused)) int bench_init(Bench* b, const char* suite, int argc, char** argv) {
+    memset(b, 0, sizeof(*b));
+    b->suite = suite;
+    b->warmup = 20;
+    b->reps = 200;
+    b->min_sample_us = 20;
+    b->cpu = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            bench_usage(argv[0]);
+            return -1;
+        }
+        if (strcmp(argv[i], "--reps") == 0) b->reps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0) b->warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-sample-us") == 0) b->min_sample_us = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cpu") == 0) b->cpu = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0) b->filter = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0) b->json_path = argv[++i];
+        else {
+            bench_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (b->reps <= 0 || b->reps > BENCH_MAX_REPS || b->warmup < 0 || b->min_sample_us < 0) {
+        bench_usage(argv[0]);
+        return -1;
+    }
+
+#ifdef __linux__
+    if (b->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(b->cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            perror("sched_setaffinity");
+        }
+    }
+#endif
+
+    printf("%s: ns (cycles) per op, averaged within each sample; min and percentiles over samples\n", suite);
+    printf("%-32s %10s %10s %10s %10s %10s\n", "", "min", "p50", "p90", "p99", "p50 cyc");
+    return 0;
+}
+
+/**
+ * Time fn; ops_per_call scales results to per-operation figures
+ */
+static __attribute__((unused)) void bench_run(Bench* b, const char* name, BenchFn fn, void* ctx, double ops_per_call) {
+    if (b->filter && !strstr(name, b->filter)) return;
+    if (b->count >= BENCH_MAX_RESULTS) {
+        fprintf(stderr, "%s: too many benchmarks, skipping %s\n", b->suite, name);
+        return;
+    }
+
+    /* Calibrate: repeat the body until one sample lasts min_sample_us */
+    int64_t calls = 1;
+    uint64_t target_ns = (uint64_t)b->min_sample_us * 1000u;
+    for (;;) {
+        uint64_t t0 = bench_now_ns();
+        for (int64_t c = 0; c < calls; c++) fn(ctx);
+        if (bench_now_ns() - t0 >= target_ns || calls >= (1 << 24)) break;
+        calls *= 2;
+    }
+
+    for (int32_t w = 0; w < b->warmup; w++) {
+        for (int64_t c = 0; c < calls; c++) fn(ctx);
+    }
+
+    double* ns = malloc((size_t)b->reps * sizeof(double));
+    double* cycles = malloc((size_t)b->reps * sizeof(double));
+    if (!ns || !cycles) {
+        free(ns);
+        free(cycles);
+        fprintf(stderr, "%s: out of memory\n", b->suite);
+        return;
+    }
+
+    double ops = (double)calls * ops_per_call;
+    double sum = 0.0;
+    for (int32_t r = 0; r < b->reps; r++) {
+        uint64_t c0 = bench_cycles();
+        uint64_t t0 = bench_now_ns();
+        for (int64_t c = 0; c < calls; c++) fn(ctx);
+        uint64_t t1 = bench_now_ns();
+        uint64_t c1 = bench_cycles();
+        ns[r] = (double)(t1 - t0) / ops;
+        cycles[r] = (double)(c1 - c0) / ops;
+        sum += ns[r];
+    }
+
+    qsort(ns, (size_t)b->reps, sizeof(double), bench_compare_double);
+    qsort(cycles, (size_t)b->reps, sizeof(double), bench_compare_double);
+
+    BenchResult* res = &b->results[b->count++];
+    snprintf(res->name, sizeof(res->name), "%s", name);
+    res->ops_per_sample = ops;
+    res->samples = b->reps;
+    res->min_ns = ns[0];
+    res->p50_ns = bench_percentile(ns, b->reps, 0.50);
+    res->p90_ns = bench_percentile(ns, b->reps, 0.90);
+    res->p99_ns = bench_percentile(ns, b->reps, 0.99);
+    res->mean_ns = sum / b->reps;
+    res->p50_cycles = bench_percentile(cycles, b->reps, 0.50);
+
+    printf("  %-30s %10.1f %10.1f %10.1f %10.1f %10.1f\n", res->name, res->min_ns, res->p50_ns, res->p90_ns,
+           res->p99_ns, res->p50_cycles);
+    fflush(stdout);
+
+    free(ns);
+    free(cycles);
+}
+
+/**
+ * Write the JSON report (if asked)
+ * @return 0 on success, 1 if the report could not be written
+ */
+static __attribute__((unused)) int bench_finish(Bench* b) {
+    if (!b->json_path) return 0;
+
+    FILE* out = fopen(b->json_path, "w");
+    if (!out) {
+        perror(b->json_path);
+        return 1;
+    }
+
+    long cpus = 1;
+#ifdef __linux__
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    fprintf(out, "{\n  \"suite\": \"%s\",\n  \"timestamp\": %lld,\n", b->suite, (long long)time(NULL));
+    fprintf(out, "  \"config\": {\"warmup\": %d, \"reps\": %d, \"minSampleUs\": %d, \"cpu\": %d, \"cpus\": %ld},\n",
+            b->warmup, b->reps, b->min_sample_us, b->cpu, cpus);
+    fprintf(out, "  \"statistic\": \"ns (cycles) per op, averaged within each sample; "
+                 "min and percentiles are over the samples, not over single calls\",\n");
+    fprintf(out, "  \"results\": [\n");
+    for (int32_t i = 0; i < b->count; i++) {
+        const BenchResult* r = &b->results[i];
+        fprintf(out,
+                "    {\"name\": \"%s\", \"samples\": %d, \"opsPerSample\": %.0f, \"sampleMinNs\": %.3f, "
+                "\"sampleP50Ns\": %.3f, \"sampleP90Ns\": %.3f, \"sampleP99Ns\": %.3f, \"meanNs\": %.3f, "
+                "\"sampleP50Cycles\": %.3f}%s\n",
+                r->name, r->samples, r->ops_per_sample, r->min_ns, r->p50_ns, r->p90_ns, r->p99_ns, r->mean_ns,
+                r->p50_cycles, i + 1 < b->count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+
+    fclose(out);
+    return 0;
+}
+
+#endif /* MUSCLEMAP_BENCH_H */
@@ -0,0 +1,92 @@
+#!/usr/bin/env node
+/**
+ * Compare two benchmark runs
+ *
+ * Usage: node bench/compare.js BASELINE CURRENT [--threshold PERCENT]
+ *
+ * BASELINE and CURRENT are JSON reports written by the bench.h suites
+ * (--json FILE), or directories of them (make bench writes build/bench).
+ * Benchmarks are matched by suite and name and compared on the median of
+ * their per-sample mean ns/op (sampleP50Ns; p50Ns in older reports).
+ * Changes beyond the threshold (default 5%) are flagged; exits 1 if any
+ * benchmark regressed.
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+function usage() {
+  console.error('usage: node bench/compare.js BASELINE CURRENT [--threshold PERCENT]');
+  process.exit(2);
+}
+
+function readReports(target) {
+  let files;
+  try {
+    files = fs.statSync(target).isDirectory()
+      ? fs.readdirSync(target).filter((f) => f.endsWith('.json')).map((f) => path.join(target, f))
+      : [target];
+  } catch (err) {
+    console.error(`${target}: ${err.message}`);
+    process.exit(2);
+  }
+
+  const results = new Map();
+  for (const file of files) {
+    const report = JSON.parse(fs.readFileSync(file, 'utf8'));
+    for (const r of report.results || []) {
+      results.set(`${report.suite}/${r.name}`, { ...r, p50: r.sampleP50Ns ?? r.p50Ns });
+    }
+  }
+  return results;
+}
+
+const args = process.argv.slice(2);
+let threshold = 5;
+const positional = [];
+for (let i = 0; i < args.length; i++) {
+  if (args[i] === '--threshold') {
+    threshold = Number(args[++i]);
+    if (!Number.isFinite(threshold) || threshold < 0) usage();
+  } else {
+    positional.push(args[i]);
+  }
+}
+if (positional.length !== 2) usage();
+
+const baseline = readReports(positional[0]);
+const current = readReports(positional[1]);
+
+let regressions = 0;
+let improvements = 0;
+console.log(`${'benchmark'.padEnd(44)} ${'base p50'.padStart(12)} ${'curr p50'.padStart(12)} ${'change'.padStart(9)}`);
+
+for (const [key, cur] of current) {
+  const base = baseline.get(key);
+  if (!base) {
+    console.log(`${key.padEnd(44)} ${'-'.padStart(12)} ${cur.p50.toFixed(1).padStart(12)} ${'new'.padStart(9)}`);
+    continue;
+  }
+
+  const change = ((cur.p50 - base.p50) / base.p50) * 100;
+  let flag = '';
+  if (change > threshold) {
+    flag = '  REGRESSION';
+    regressions++;
+  } else if (change < -threshold) {
+    flag = '  faster';
+    improvements++;
+  }
+  const pct = `${change >= 0 ? '+' : ''}${change.toFixed(1)}%`;
+  console.log(
+    `${key.padEnd(44)} ${base.p50.toFixed(1).padStart(12)} ${cur.p50.toFixed(1).padStart(12)} ${pct.padStart(9)}${flag}`
+  );
+}
+
+for (const key of baseline.keys()) {
+  if (!current.has(key)) console.log(`${key.padEnd(44)} (missing from current run)`);
+}
+
+console.log('');
+console.log(`threshold ${threshold}%: ${regressions} regression(s), ${improvements} improvement(s)`);
+process.exit(regressions > 0 ? 1 : 0);
@@ -0,0 +1,89 @@
+/**
+ * libgeo benchmark suite
+ *
+ * Compile: gcc -O2 -std=c11 -D_GNU_SOURCE -o geo-bench geo-bench.c -L../lib -lgeo -lm
+ * Usage:   ./geo-bench [bench.h flags]
+ */
+
+#include "bench.h"
+#include "../src/geo/geohash.h"
+
+#define POINTS 4096
+
+typedef struct {
+    double coords[POINTS * 2];
+    double distances[POINTS];
+    char hashes[POINTS][13];
+    uint32_t next;
+} GeoBench;
+
+static void bench_encode(void* ctx) {
+    GeoBench* g = ctx;
+    uint32_t i = g->next++ % POINTS;
+    char hash[13];
+    bench_sink = geohash_encode(g->coords[2 * i], g->coords[2 * i + 1], 9, hash);
+}
+
+static void bench_decode(void* ctx) {
+    GeoBench* g = ctx;
+    double lat, lng;
+    geohash_decode(g->hashes[g->next++ % POINTS], &lat, &lng);
+    bench_sink = lat + lng;
+}
+
+static void bench_neighbors(void* ctx) {
+    GeoBench* g = ctx;
+    char neighbors[8][13];
+    bench_sink = geohash_neighbors(g->hashes[g->next++ % POINTS], neighbors);
+}
+
+static void bench_haversine(void* ctx) {
+    GeoBench* g = ctx;
+    uint32_t i = g->next++ % POINTS;
+    bench_sink = haversine_meters(40.7128, -74.0060, g->coords[2 * i], g->coords[2 * i + 1]);
+}
+
+static void bench_haversine_batch(void* ctx) {
+    GeoBench* g = ctx;
+    haversine_batch(40.7128, -74.0060, g->coords, POINTS, g->distances);
+    bench_sink = g->distances[g->next++ % POINTS];
+}
+
+static void bench_within_radius(void* ctx) {
+    GeoBench* g = ctx;
+    uint32_t i = g->next++ % POINTS;
+    bench_sink = is_within_radius(40.7128, -74.0060, g->coords[2 * i], g->coords[2 * i + 1], 25000.0);
+}
+
+static void bench_bounding_box(void* ctx) {
+    GeoBench* g = ctx;
+    uint32_t i = g->next++ % POINTS;
+    double min_lat, max_lat, min_lng, max_lng;
+    bounding_box(g->coords[2 * i], g->coords[2 * i + 1], 5000.0, &min_lat, &max_lat, &min_lng, &max_lng);
+    bench_sink = min_lat + max_lng;
+}
+
+int main(int argc, char** argv) {
+    Bench b;
+    if (bench_init(&b, "geo", argc, argv) != 0) return 1;
+
+    static GeoBench g;
+    uint32_t rng = 12345;
+    for (int32_t i = 0; i < POINTS; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        g.coords[2 * i] = 40.0 + (double)(rng >> 8) / 16777216.0 * 2.0;
+        rng = rng * 1664525u + 1013904223u;
+        g.coords[2 * i + 1] = -75.0 + (double)(rng >> 8) / 16777216.0 * 2.0;
+        geohash_encode(g.coords[2 * i], g.coords[2 * i + 1], 9, g.hashes[i]);
+    }
+
+    bench_run(&b, "geohash_encode", bench_encode, &g, 1.0);
+    bench_run(&b, "geohash_decode", bench_decode, &g, 1.0);
+    bench_run(&b, "geohash_neighbors", bench_neighbors, &g, 1.0);
+    bench_run(&b, "haversine_meters", bench_haversine, &g, 1.0);
+    bench_run(&b, "haversine_batch_4096", bench_haversine_batch, &g, POINTS);
+    bench_run(&b, "is_within_radius", bench_within_radius, &g, 1.0);
+    bench_run(&b, "bounding_box", bench_bounding_box, &g, 1.0);
+
+    return bench_finish(&b);
+}
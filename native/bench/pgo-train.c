@@ -0,0 +1,319 @@
+/**
+ * PGO Training Workload
+ *
+ * Drives every native library through its production-shaped hot paths:
+ * - libgeo: geohash encode/decode/neighbors and haversine batches
+ * - libratelimit: several threads checking overlapping users
+ * - librank: full rankings, simple percentiles and rank lookups
+ * - libtu: batch TU calculations over a 500-exercise catalog
+ *
+ * `make pgo` runs it against the instrumented libraries to collect the
+ * profile, and against the release builds before and after to report
+ * the gain. Prints one "<library> <ns/op>" line per library.
+ *
+ * Compile: gcc -O2 -std=c11 -D_GNU_SOURCE -o pgo-train pgo-train.c -Llib -lgeo -lratelimit -lrank -ltu -lpthread -lm
+ * Usage:   ./pgo-train [rounds] (default: 20)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "../src/geo/geohash.h"
+#include "../src/ratelimit/limiter.h"
+#include "../src/rank/rank_calculator.h"
+#include "../src/workout/tu_calculator.h"
+
+#define GEO_POINTS 4096
+#define LIMITER_THREADS 4
+#define LIMITER_CHECKS 50000
+#define LIMITER_USERS 2048
+#define RANK_USERS 10000
+#define TU_EXERCISES 500
+#define TU_WORKOUTS 256
+#define TU_WORKOUT_SIZE 8
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static double uniform(uint32_t* rng, double lo, double hi) {
+    return lo + (hi - lo) * (double)xorshift32(rng) / 4294967295.0;
+}
+
+/* Keeps results observable so the workloads are not optimized away */
+static volatile double g_sink;
+
+/* ============================================
+ * LIBGEO
+ * ============================================ */
+
+/**
+ * One round: encode, decode and expand every point, then distances
+ * from a handful of origins. Returns operations performed.
+ */
+static uint64_t train_geo(const double* points, double* distances) {
+    uint64_t ops = 0;
+    double sink = 0.0;
+    char hash[13];
+    char neighbors[8][13];
+
+    for (int32_t i = 0; i < GEO_POINTS; i++) {
+        double lat = points[2 * i], lng = points[2 * i + 1];
+        int precision = 5 + i % 5;
+        if (geohash_encode(lat, lng, precision, hash) > 0) {
+            double dlat, dlng;
+            geohash_decode(hash, &dlat, &dlng);
+            sink += dlat + dlng;
+            if (i % 8 == 0) {
+                geohash_neighbors(hash, neighbors);
+                ops++;
+            }
+        }
+        sink += is_within_radius(lat, lng, points[0], points[1], 5000.0);
+        ops += 3;
+    }
+
+    for (int32_t o = 0; o < 8; o++) {
+        haversine_batch(points[2 * o], points[2 * o + 1], points, GEO_POINTS, distances);
+        sink += distances[o];
+        ops += GEO_POINTS;
+    }
+
+    double min_lat, max_lat, min_lng, max_lng;
+    for (int32_t i = 0; i < 256; i++) {
+        bounding_box(points[2 * i], points[2 * i + 1], 100.0 * i, &min_lat, &max_lat, &min_lng, &max_lng);
+        sink += optimal_precision(100.0 * i) + min_lat;
+        ops += 2;
+    }
+
+    g_sink = sink;
+    return ops;
+}
+
+/* ============================================
+ * LIBRATELIMIT
+ * ============================================ */
+
+typedef struct {
+    RateLimiter* rl;
+    uint32_t seed;
+} LimiterThread;
+
+/**
+ * Hammer a shared limiter; users overlap across threads so slots are
+ * contended, and one call in sixteen goes through the batch API
+ */
+static void* limiter_thread(void* arg) {
+    LimiterThread* lt = arg;
+    uint32_t rng = lt->seed;
+    uint64_t ids[16];
+    int8_t verdicts[16];
+    int allowed = 0;
+
+    for (int32_t i = 0; i < LIMITER_CHECKS; i++) {
+        uint64_t user = xorshift32(&rng) % LIMITER_USERS;
+        if (i % 16 == 0) {
+            for (int32_t b = 0; b < 16; b++) {
+                ids[b] = (user + (uint64_t)b) % LIMITER_USERS;
+            }
+            allowed += ratelimit_check_batch(lt->rl, ids, 16, 1, verdicts);
+        } else {
+            allowed += ratelimit_check(lt->rl, user, 1) > 0;
+        }
+        if (i % 64 == 0) {
+            allowed += ratelimit_remaining(lt->rl, user);
+        }
+    }
+
+    g_sink = allowed;
+    return NULL;
+}
+
+static uint64_t train_ratelimit(uint32_t round) {
+    RateLimiter* rl = ratelimit_create(LIMITER_USERS * 4, 1000);
+    if (!rl) return 0;
+
+    pthread_t handles[LIMITER_THREADS];
+    LimiterThread threads[LIMITER_THREADS];
+    for (int32_t t = 0; t < LIMITER_THREADS; t++) {
+        threads[t].rl = rl;
+        threads[t].seed = 0x9E3779B9u * (uint32_t)(t + 1) + round;
+        pthread_create(&handles[t], NULL, limiter_thread, &threads[t]);
+    }
+    for (int32_t t = 0; t < LIMITER_THREADS; t++) {
+        pthread_join(handles[t], NULL);
+    }
+
+    size_t active;
+    uint64_t total;
+    ratelimit_stats(rl, &active, &total);
+    ratelimit_destroy(rl);
+
+    /* Batch calls count one op per ID */
+    return (uint64_t)LIMITER_THREADS * (LIMITER_CHECKS + (LIMITER_CHECKS / 16) * 15);
+}
+
+/* ============================================
+ * LIBRANK
+ * ============================================ */
+
+static uint64_t train_rank(RankedUser* users, double* scores, double* percentiles, uint32_t* rng) {
+    double sink = 0.0;
+
+    for (int32_t i = 0; i < RANK_USERS; i++) {
+        /* Coarse scores so ties are common, as on real leaderboards */
+        users[i].score = (double)(xorshift32(rng) % 5000);
+        snprintf(users[i].user_id, USER_ID_LEN, "user-%d", i);
+        scores[i] = users[i].score;
+    }
+
+    rank_full_ranking(users, RANK_USERS);
+
+    RankStats stats;
+    rank_calculate_stats(users, RANK_USERS, &stats);
+    sink += stats.mean_score;
+
+    rank_simple_percentiles(scores, RANK_USERS, percentiles);
+    sink += percentiles[0];
+
+    for (int32_t i = 0; i < RANK_USERS; i++) {
+        scores[i] = users[i].score;
+    }
+    for (int32_t i = 0; i < 1000; i++) {
+        sink += rank_find_rank(scores, RANK_USERS, (double)(xorshift32(rng) % 5000));
+    }
+
+    g_sink = sink;
+    return (uint64_t)RANK_USERS * 2 + 1000;
+}
+
+/* ============================================
+ * LIBTU
+ * ============================================ */
+
+static void load_tu_catalog(uint32_t* rng) {
+    char id[32];
+    float activations[MAX_MUSCLES];
+
+    tu_init();
+    for (int32_t m = 0; m < MAX_MUSCLES; m++) {
+        snprintf(id, sizeof(id), "muscle-%d", m);
+        tu_add_muscle(id, 0.5f + (float)(m % 10) * 0.1f);
+    }
+    for (int32_t e = 0; e < TU_EXERCISES; e++) {
+        for (int32_t m = 0; m < MAX_MUSCLES; m++) {
+            activations[m] = xorshift32(rng) % 8 == 0 ? (float)(xorshift32(rng) % 100) : 0.0f;
+        }
+        snprintf(id, sizeof(id), "exercise-%d", e);
+        tu_add_exercise(id, activations, MAX_MUSCLES);
+    }
+}
+
+static uint64_t train_tu(WorkoutExerciseInput* inputs, TUResult* results, uint32_t* rng) {
+    static const WorkoutExerciseInput* workouts[TU_WORKOUTS];
+    static int32_t counts[TU_WORKOUTS];
+    double sink = 0.0;
+
+    for (int32_t w = 0; w < TU_WORKOUTS; w++) {
+        for (int32_t e = 0; e < TU_WORKOUT_SIZE; e++) {
+            WorkoutExerciseInput* in = &inputs[w * TU_WORKOUT_SIZE + e];
+            in->exercise_index = (int32_t)(xorshift32(rng) % TU_EXERCISES);
+            in->sets = 1 + (int32_t)(xorshift32(rng) % 5);
+            in->reps = 10;
+            in->weight = 0.0f;
+        }
+        workouts[w] = &inputs[w * TU_WORKOUT_SIZE];
+        counts[w] = 1 + (int32_t)(xorshift32(rng) % TU_WORKOUT_SIZE);
+    }
+
+    tu_calculate_batch(workouts, counts, TU_WORKOUTS, results);
+    for (int32_t w = 0; w < TU_WORKOUTS; w++) {
+        sink += results[w].total_tu;
+    }
+
+    for (int32_t i = 0; i < 64; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "exercise-%d", (int32_t)(xorshift32(rng) % TU_EXERCISES));
+        sink += tu_find_exercise(id);
+    }
+
+    g_sink = sink;
+    return TU_WORKOUTS + 64;
+}
+
+int main(int argc, char** argv) {
+    int32_t rounds = argc > 1 ? atoi(argv[1]) : 20;
+    if (rounds <= 0) {
+        fprintf(stderr, "usage: %s [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    double* points = malloc(GEO_POINTS * 2 * sizeof(double));
+    double* distances = malloc(GEO_POINTS * sizeof(double));
+    RankedUser* users = malloc(RANK_USERS * sizeof(RankedUser));
+    double* scores = malloc(RANK_USERS * sizeof(double));
+    double* percentiles = malloc(RANK_USERS * sizeof(double));
+    WorkoutExerciseInput* inputs = malloc(TU_WORKOUTS * TU_WORKOUT_SIZE * sizeof(WorkoutExerciseInput));
+    TUResult* results = malloc(TU_WORKOUTS * sizeof(TUResult));
+    if (!points || !distances || !users || !scores || !percentiles || !inputs || !results) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    uint32_t rng = 0x2545F491u;
+    for (int32_t i = 0; i < GEO_POINTS; i++) {
+        /* Clustered around a few metro areas, like real check-ins */
+        int32_t metro = i % 4;
+        points[2 * i] = uniform(&rng, -0.5, 0.5) + (double[]){40.71, 34.05, 51.51, -33.87}[metro];
+        points[2 * i + 1] = uniform(&rng, -0.5, 0.5) + (double[]){-74.01, -118.24, -0.13, 151.21}[metro];
+    }
+    load_tu_catalog(&rng);
+
+    uint64_t geo_ns = 0, ratelimit_ns = 0, rank_ns = 0, tu_ns = 0;
+    uint64_t geo_ops = 0, ratelimit_ops = 0, rank_ops = 0, tu_ops = 0;
+
+    for (int32_t r = 0; r < rounds; r++) {
+        uint64_t t0 = now_ns();
+        geo_ops += train_geo(points, distances);
+        uint64_t t1 = now_ns();
+        ratelimit_ops += train_ratelimit((uint32_t)r);
+        uint64_t t2 = now_ns();
+        rank_ops += train_rank(users, scores, percentiles, &rng);
+        uint64_t t3 = now_ns();
+        tu_ops += train_tu(inputs, results, &rng);
+        uint64_t t4 = now_ns();
+
+        geo_ns += t1 - t0;
+        ratelimit_ns += t2 - t1;
+        rank_ns += t3 - t2;
+        tu_ns += t4 - t3;
+    }
+
+    printf("libgeo %.2f\n", (double)geo_ns / (double)geo_ops);
+    printf("libratelimit %.2f\n", (double)ratelimit_ns / (double)ratelimit_ops);
+    printf("librank %.2f\n", (double)rank_ns / (double)rank_ops);
+    printf("libtu %.2f\n", (double)tu_ns / (double)tu_ops);
+
+    free(points);
+    free(distances);
+    free(users);
+    free(scores);
+    free(percentiles);
+    free(inputs);
+    free(results);
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * librank benchmark suite
+ *
+ * Ranking calls sort in place, so each call first restores the input from
+ * a template; the copy is included in the timings.
+ *
+ * Compile: gcc -O2 -std=c11 -D_GNU_SOURCE -o rank-bench rank-bench.c -L../lib -lrank
+ * Usage:   ./rank-bench [bench.h flags]
+ */
+
+#include "bench.h"
+#include "../src/rank/rank_calculator.h"
+
+#define MAX_USERS 100000
+
+typedef struct {
+    size_t count;
+    RankedUser* template_users;
+    RankedUser* users;
+    double* template_scores;
+    double* scores;
+    double* sorted_scores;
+    double* percentiles;
+    uint32_t next;
+} RankBench;
+
+static void bench_full_ranking(void* ctx) {
+    RankBench* r = ctx;
+    memcpy(r->users, r->template_users, r->count * sizeof(RankedUser));
+    bench_sink = rank_full_ranking(r->users, r->count);
+}
+
+static void bench_simple_percentiles(void* ctx) {
+    RankBench* r = ctx;
+    memcpy(r->scores, r->template_scores, r->count * sizeof(double));
+    bench_sink = rank_simple_percentiles(r->scores, r->count, r->percentiles);
+}
+
+static void bench_find_rank(void* ctx) {
+    RankBench* r = ctx;
+    r->next = r->next * 1664525u + 1013904223u;
+    bench_sink = rank_find_rank(r->sorted_scores, MAX_USERS, (double)((r->next >> 8) % 5000));
+}
+
+static void bench_stats(void* ctx) {
+    RankBench* r = ctx;
+    RankStats stats;
+    rank_calculate_stats(r->template_users, MAX_USERS, &stats);
+    bench_sink = stats.mean_score;
+}
+
+static int compare_desc(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x < y) - (x > y);
+}
+
+int main(int argc, char** argv) {
+    Bench b;
+    if (bench_init(&b, "rank", argc, argv) != 0) return 1;
+
+    RankBench r = {0};
+    r.template_users = malloc(MAX_USERS * sizeof(RankedUser));
+    r.users = malloc(MAX_USERS * sizeof(RankedUser));
+    r.template_scores = malloc(MAX_USERS * sizeof(double));
+    r.scores = malloc(MAX_USERS * sizeof(double));
+    r.sorted_scores = malloc(MAX_USERS * sizeof(double));
+    r.percentiles = malloc(MAX_USERS * sizeof(double));
+    if (!r.template_users || !r.users || !r.template_scores || !r.scores || !r.sorted_scores || !r.percentiles) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    /* Coarse scores so ties are common, as on real leaderboards */
+    uint32_t rng = 54321;
+    for (int32_t i = 0; i < MAX_USERS; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        double score = (double)((rng >> 8) % 5000);
+        snprintf(r.template_users[i].user_id, USER_ID_LEN, "user-%d", i);
+        r.template_users[i].score = score;
+        r.template_users[i].rank = 0;
+        r.template_users[i].percentile = 0.0;
+        r.template_scores[i] = score;
+        r.sorted_scores[i] = score;
+    }
+    qsort(r.sorted_scores, MAX_USERS, sizeof(double), compare_desc);
+
+    static const size_t sizes[] = {1000, 10000, 100000};
+    char name[64];
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        r.count = sizes[s];
+        snprintf(name, sizeof(name), "full_ranking_%zu", sizes[s]);
+        bench_run(&b, name, bench_full_ranking, &r, (double)sizes[s]);
+    }
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        r.count = sizes[s];
+        snprintf(name, sizeof(name), "simple_percentiles_%zu", sizes[s]);
+        bench_run(&b, name, bench_simple_percentiles, &r, (double)sizes[s]);
+    }
+    bench_run(&b, "find_rank_100000", bench_find_rank, &r, 1.0);
+    bench_run(&b, "calculate_stats_100000", bench_stats, &r, MAX_USERS);
+
+    free(r.template_users);
+    free(r.users);
+    free(r.template_scores);
+    free(r.scores);
+    free(r.sorted_scores);
+    free(r.percentiles);
+    return bench_finish(&b);
+}
@@ -0,0 +1,65 @@
+/**
+ * libratelimit benchmark suite
+ *
+ * Compile: gcc -O2 -std=c11 -D_GNU_SOURCE -o ratelimit-bench ratelimit-bench.c -L../lib -lratelimit -lpthread
+ * Usage:   ./ratelimit-bench [bench.h flags]
+ */
+
+#include "bench.h"
+#include "../src/ratelimit/limiter.h"
+
+#define USERS 10000
+#define BATCH 256
+
+typedef struct {
+    RateLimiter* rl;
+    uint64_t ids[BATCH];
+    int8_t verdicts[BATCH];
+    uint64_t next;
+} LimiterBench;
+
+static void bench_check_hot(void* ctx) {
+    LimiterBench* l = ctx;
+    bench_sink = ratelimit_check(l->rl, 42, 1);
+}
+
+static void bench_check_spread(void* ctx) {
+    LimiterBench* l = ctx;
+    l->next = l->next * 6364136223846793005ULL + 1442695040888963407ULL;
+    bench_sink = ratelimit_check(l->rl, (l->next >> 33) % USERS, 1);
+}
+
+static void bench_check_batch(void* ctx) {
+    LimiterBench* l = ctx;
+    bench_sink = ratelimit_check_batch(l->rl, l->ids, BATCH, 1, l->verdicts);
+}
+
+static void bench_remaining(void* ctx) {
+    LimiterBench* l = ctx;
+    l->next = l->next * 6364136223846793005ULL + 1442695040888963407ULL;
+    bench_sink = ratelimit_remaining(l->rl, (l->next >> 33) % USERS);
+}
+
+int main(int argc, char** argv) {
+    Bench b;
+    if (bench_init(&b, "ratelimit", argc, argv) != 0) return 1;
+
+    /* Limit high enough that the window never fills during a run */
+    static LimiterBench l;
+    l.rl = ratelimit_create(USERS * 4, UINT32_MAX);
+    if (!l.rl) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (int32_t i = 0; i < BATCH; i++) {
+        l.ids[i] = (uint64_t)i * 37 % USERS;
+    }
+
+    bench_run(&b, "check_same_user", bench_check_hot, &l, 1.0);
+    bench_run(&b, "check_10k_users", bench_check_spread, &l, 1.0);
+    bench_run(&b, "check_batch_256", bench_check_batch, &l, BATCH);
+    bench_run(&b, "remaining", bench_remaining, &l, 1.0);
+
+    ratelimit_destroy(l.rl);
+    return bench_finish(&b);
+}
@@ -0,0 +1,106 @@
+/**
+ * libtu benchmark suite
+ *
+ * Compile: gcc -O2 -std=c11 -D_GNU_SOURCE -o tu-bench tu-bench.c -L../lib -ltu
+ * Usage:   ./tu-bench [bench.h flags]
+ */
+
+#include "bench.h"
+#include "../src/workout/tu_calculator.h"
+
+#define EXERCISES 500
+#define WORKOUTS 4096
+#define WORKOUT_SIZE 8
+#define SIMPLE_EXERCISES 12
+
+typedef struct {
+    WorkoutExerciseInput inputs[WORKOUTS * WORKOUT_SIZE];
+    const WorkoutExerciseInput* workouts[WORKOUTS];
+    int32_t counts[WORKOUTS];
+    TUResult results[WORKOUTS];
+    int32_t batch;
+    float activations[SIMPLE_EXERCISES * MAX_MUSCLES];
+    int32_t sets[SIMPLE_EXERCISES];
+    float bias[MAX_MUSCLES];
+    char ids[64][32];
+    uint32_t next;
+} TuBench;
+
+static void bench_calculate(void* ctx) {
+    TuBench* t = ctx;
+    uint32_t w = t->next++ % WORKOUTS;
+    bench_sink = tu_calculate(t->workouts[w], WORKOUT_SIZE, &t->results[0]);
+}
+
+static void bench_calculate_batch(void* ctx) {
+    TuBench* t = ctx;
+    bench_sink = tu_calculate_batch(t->workouts, t->counts, t->batch, t->results);
+}
+
+static void bench_calculate_simple(void* ctx) {
+    TuBench* t = ctx;
+    bench_sink = tu_calculate_simple(t->activations, t->sets, t->bias, SIMPLE_EXERCISES, MAX_MUSCLES);
+}
+
+static void bench_find_exercise(void* ctx) {
+    TuBench* t = ctx;
+    bench_sink = tu_find_exercise(t->ids[t->next++ % 64]);
+}
+
+int main(int argc, char** argv) {
+    Bench b;
+    if (bench_init(&b, "tu", argc, argv) != 0) return 1;
+
+    static TuBench t;
+    uint32_t rng = 777;
+    char id[32];
+    float activations[MAX_MUSCLES];
+
+    tu_init();
+    for (int32_t m = 0; m < MAX_MUSCLES; m++) {
+        snprintf(id, sizeof(id), "muscle-%d", m);
+        tu_add_muscle(id, 0.5f + (float)(m % 10) * 0.1f);
+        t.bias[m] = 0.5f + (float)(m % 10) * 0.1f;
+    }
+    for (int32_t e = 0; e < EXERCISES; e++) {
+        for (int32_t m = 0; m < MAX_MUSCLES; m++) {
+            rng = rng * 1664525u + 1013904223u;
+            activations[m] = (rng >> 8) % 8 == 0 ? (float)((rng >> 16) % 100) : 0.0f;
+        }
+        snprintf(id, sizeof(id), "exercise-%d", e);
+        tu_add_exercise(id, activations, MAX_MUSCLES);
+    }
+
+    for (int32_t w = 0; w < WORKOUTS; w++) {
+        for (int32_t e = 0; e < WORKOUT_SIZE; e++) {
+            WorkoutExerciseInput* in = &t.inputs[w * WORKOUT_SIZE + e];
+            rng = rng * 1664525u + 1013904223u;
+            in->exercise_index = (int32_t)((rng >> 8) % EXERCISES);
+            in->sets = 1 + (int32_t)((rng >> 4) % 5);
+            in->reps = 10;
+            in->weight = 0.0f;
+        }
+        t.workouts[w] = &t.inputs[w * WORKOUT_SIZE];
+        t.counts[w] = WORKOUT_SIZE;
+    }
+    for (int32_t i = 0; i < SIMPLE_EXERCISES * MAX_MUSCLES; i++) {
+        t.activations[i] = (float)(i * 7 % 100);
+    }
+    for (int32_t i = 0; i < SIMPLE_EXERCISES; i++) {
+        t.sets[i] = 3;
+    }
+    for (int32_t i = 0; i < 64; i++) {
+        snprintf(t.ids[i], sizeof(t.ids[i]), "exercise-%d", i * 7 % EXERCISES);
+    }
+
+    printf("  (kernel: %s)\n", tu_active_isa());
+    bench_run(&b, "calculate_8_exercises", bench_calculate, &t, 1.0);
+    t.batch = 256;
+    bench_run(&b, "calculate_batch_256", bench_calculate_batch, &t, 256.0);
+    t.batch = WORKOUTS;
+    bench_run(&b, "calculate_batch_4096", bench_calculate_batch, &t, WORKOUTS);
+    bench_run(&b, "calculate_simple_12x64", bench_calculate_simple, &t, 1.0);
+    bench_run(&b, "find_exercise", bench_find_exercise, &t, 1.0);
+
+    return bench_finish(&b);
+}
@@ -0,0 +1,47 @@
+{
+  "variables": {
+    "native_stats%": 0,
+    "native_capture%": 0
+  },
+  "targets": [
+    {
+      "target_name": "musclemap_native",
+      "sources": [
+        "src/addon/addon.c",
+        "src/geo/geohash.c",
+        "src/ratelimit/limiter.c",
+        "src/rank/rank_calculator.c",
+        "src/workout/tu_calculator.c",
+        "src/workpool/workpool.c",
+        "src/stats/native_stats.c"
+      ],
+      "cflags_c": ["-std=c11", "-O3", "-fno-trapping-math"],
+      "defines": ["NDEBUG"],
+      "conditions": [
+        ["native_stats==1", {
+          "defines": ["MUSCLEMAP_NATIVE_STATS"]
+        }],
+        ["native_capture==1", {
+          "defines": ["MUSCLEMAP_NATIVE_CAPTURE"],
+          "libraries": [
+            "-L<(module_root_dir)/lib",
+            "-lnativecapture",
+            "-Wl,-rpath,<(module_root_dir)/lib"
+          ]
+        }, {
+          "sources": ["src/capture/native_capture.c"]
+        }],
+        ["OS=='linux'", {
+          "defines": ["_GNU_SOURCE"],
+          "libraries": ["-lm", "-lpthread"]
+        }],
+        ["OS=='mac'", {
+          "xcode_settings": {
+            "OTHER_CFLAGS": ["-std=c11", "-O3", "-fno-trapping-math"],
+            "MACOSX_DEPLOYMENT_TARGET": "10.15"
+          }
+        }]
+      ]
+    }
+  ]
+}
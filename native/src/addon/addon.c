@@ -0,0 +1,1315 @@
+/**
+ * Native Modules - N-API Addon
+ *
+ * Exposes libgeo, libratelimit, librank and libtu to Node.js with direct
+ * argument conversion, replacing the ffi-napi bindings. The libraries are
+ * compiled into the addon (see binding.gyp); the standalone .so builds
+ * from the Makefile are unchanged.
+ *
+ * Each scalar function mirrors its C counterpart. Batch variants take and
+ * return TypedArrays so one call covers many inputs:
+ * - haversineBatch(lat, lng, Float64Array points[, out]) -> Float64Array
+ * - geohashEncodeBatch(Float64Array coords, precision) -> string[]
+ * - ratelimitCheckBatch(handle, BigUint64Array ids[, count[, out]]) -> Int8Array
+ * - rankSimplePercentiles(Float64Array scores[, out]) -> Float64Array
+ * - tuCalculateBatch(Int32Array packed, Int32Array offsets[, out]) -> Float32Array
+ *
+ * tuLoadCatalog(path) maps the shared binary catalog (make catalog) in
+ * place of tuAddExercise / tuAddMuscle calls.
+ *
+ * Call statistics (build with `node-gyp rebuild --native_stats=1`):
+ * - nativeStatsSnapshot() -> per-function counts, percentiles, histogram
+ * - nativeStatsReset(), nativeStatsEnabled()
+ *
+ * Call capture for offline replay (`make release NATIVE_CAPTURE=1`, then
+ * `node-gyp rebuild --native_capture=1`, which links lib/libnativecapture so
+ * a solver built with capture records into the same ring):
+ * - nativeCaptureStart(path[, sampleEvery[, records]]), nativeCaptureStop()
+ * - nativeCaptureEnabled()
+ *
+ * Build: node-gyp rebuild (or `make addon`)
+ */
+
+#define NAPI_VERSION 8
+#include <node_api.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../geo/geohash.h"
+#include "../ratelimit/limiter.h"
+#include "../rank/rank_calculator.h"
+#include "../workout/tu_calculator.h"
+#include "../stats/native_stats.h"
+#include "../capture/native_capture.h"
+#include "../common/catalog_format.h"
+
+#define GEOHASH_MAX_LEN 12
+#define ID_BUFFER_LEN 64                 /* Exercise, muscle and user IDs (truncated like the C API) */
+#define PATH_BUFFER_LEN 4096
+
+/* ============================================
+ * ARGUMENT HELPERS
+ * ============================================ */
+
+/**
+ * Read callback arguments; throws and returns false if fewer than required
+ */
+static bool get_args(napi_env env, napi_callback_info info, size_t required, size_t max, napi_value* args,
+                     size_t* argc, const char* usage) {
+    *argc = max;
+    napi_get_cb_info(env, info, argc, args, NULL, NULL);
+    for (size_t i = *argc; i < max; i++) {
+        napi_get_undefined(env, &args[i]);
+    }
+    if (*argc < required) {
+        napi_throw_type_error(env, NULL, usage);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read a number argument; throws and returns false if it is not one
+ */
+static bool get_double(napi_env env, napi_value value, double* out) {
+    if (napi_get_value_double(env, value, out) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected number");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read an optional int32 argument (undefined keeps the default)
+ */
+static bool get_int32_or(napi_env env, napi_value value, int32_t fallback, int32_t* out) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    if (type == napi_undefined) {
+        *out = fallback;
+        return true;
+    }
+    if (napi_get_value_int32(env, value, out) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected integer");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read an optional rate limit count (default 1); throws unless positive
+ */
+static bool get_count(napi_env env, napi_value value, uint32_t* out) {
+    int32_t count;
+    if (!get_int32_or(env, value, 1, &count)) return false;
+    if (count <= 0) {
+        napi_throw_range_error(env, NULL, "count must be positive");
+        return false;
+    }
+    *out = (uint32_t)count;
+    return true;
+}
+
+/**
+ * Read a 64-bit user ID from a BigInt or a (safe integer) number
+ */
+static bool get_user_id(napi_env env, napi_value value, uint64_t* out) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    if (type == napi_bigint) {
+        bool lossless;
+        napi_get_value_bigint_uint64(env, value, out, &lossless);
+        return true;
+    }
+    double id;
+    if (napi_get_value_double(env, value, &id) != napi_ok || id < 0) {
+        napi_throw_type_error(env, NULL, "Expected user ID (number or BigInt)");
+        return false;
+    }
+    *out = (uint64_t)id;
+    return true;
+}
+
+/**
+ * Read a string into a fixed buffer (truncated to buffer_len - 1 bytes)
+ */
+static bool get_string(napi_env env, napi_value value, char* buffer, size_t buffer_len) {
+    size_t len;
+    if (napi_get_value_string_utf8(env, value, buffer, buffer_len, &len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected string");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Borrow a TypedArray's storage; throws unless it has the expected type
+ */
+static bool get_typed(napi_env env, napi_value value, napi_typedarray_type expected, void** data, size_t* length,
+                      const char* message) {
+    bool is_typed = false;
+    napi_is_typedarray(env, value, &is_typed);
+    if (is_typed) {
+        napi_typedarray_type type;
+        napi_get_typedarray_info(env, value, &type, length, data, NULL, NULL);
+        if (type == expected) {
+            return true;
+        }
+    }
+    napi_throw_type_error(env, NULL, message);
+    return false;
+}
+
+/**
+ * Output TypedArray for a batch: the caller's `out` if it has the right type
+ * and at least `length` elements, otherwise a new array
+ */
+static napi_value output_typed(napi_env env, napi_value out, napi_typedarray_type type, size_t element_size,
+                               size_t length, void** data) {
+    bool is_typed = false;
+    napi_is_typedarray(env, out, &is_typed);
+    if (is_typed) {
+        napi_typedarray_type out_type;
+        size_t out_len;
+        napi_get_typedarray_info(env, out, &out_type, &out_len, data, NULL, NULL);
+        if (out_type == type && out_len >= length) {
+            return out;
+        }
+    }
+
+    napi_value buffer, result;
+    if (napi_create_arraybuffer(env, length * element_size, data, &buffer) != napi_ok ||
+        napi_create_typedarray(env, type, length, buffer, 0, &result) != napi_ok) {
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+    return result;
+}
+
+static napi_value make_double(napi_env env, double value) {
+    napi_value result;
+    napi_create_double(env, value, &result);
+    return result;
+}
+
+static napi_value make_int32(napi_env env, int32_t value) {
+    napi_value result;
+    napi_create_int32(env, value, &result);
+    return result;
+}
+
+static napi_value make_null(napi_env env) {
+    napi_value result;
+    napi_get_null(env, &result);
+    return result;
+}
+
+/* ============================================
+ * LIBGEO
+ * ============================================ */
+
+/**
+ * geohashEncode(lat, lng, precision = 9) -> string | null
+ */
+static napi_value GeohashEncode(napi_env env, napi_callback_info info) {
+    napi_value args[3];
+    size_t argc;
+    if (!get_args(env, info, 2, 3, args, &argc, "Expected lat, lng[, precision]")) return NULL;
+
+    double lat, lng;
+    int32_t precision;
+    if (!get_double(env, args[0], &lat) || !get_double(env, args[1], &lng) ||
+        !get_int32_or(env, args[2], 9, &precision)) {
+        return NULL;
+    }
+
+    char hash[GEOHASH_MAX_LEN + 1];
+    int len = geohash_encode(lat, lng, precision, hash);
+    if (len < 0) return make_null(env);
+
+    napi_value result;
+    napi_create_string_utf8(env, hash, (size_t)len, &result);
+    return result;
+}
+
+/**
+ * geohashDecode(hash) -> { lat, lng } | null
+ */
+static napi_value GeohashDecode(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected geohash string")) return NULL;
+
+    char hash[GEOHASH_MAX_LEN + 1];
+    if (!get_string(env, args[0], hash, sizeof(hash))) return NULL;
+
+    double lat, lng;
+    if (geohash_decode(hash, &lat, &lng) != 0) return make_null(env);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "lat", make_double(env, lat));
+    napi_set_named_property(env, result, "lng", make_double(env, lng));
+    return result;
+}
+
+/**
+ * geohashPrecisionError(precision) -> { latErr, lngErr } | null
+ */
+static napi_value GeohashPrecisionError(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected precision")) return NULL;
+
+    int32_t precision;
+    if (!get_int32_or(env, args[0], 0, &precision)) return NULL;
+
+    double lat_err, lng_err;
+    if (geohash_precision_error(precision, &lat_err, &lng_err) != 0) return make_null(env);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "latErr", make_double(env, lat_err));
+    napi_set_named_property(env, result, "lngErr", make_double(env, lng_err));
+    return result;
+}
+
+/**
+ * geohashNeighbors(hash) -> [N, NE, E, SE, S, SW, W, NW] | null
+ */
+static napi_value GeohashNeighbors(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected geohash string")) return NULL;
+
+    char hash[GEOHASH_MAX_LEN + 2];
+    if (!get_string(env, args[0], hash, sizeof(hash))) return NULL;
+
+    char neighbors[8][13];
+    if (geohash_neighbors(hash, neighbors) != 0) return make_null(env);
+
+    napi_value result;
+    napi_create_array_with_length(env, 8, &result);
+    for (uint32_t i = 0; i < 8; i++) {
+        napi_value str;
+        napi_create_string_utf8(env, neighbors[i], NAPI_AUTO_LENGTH, &str);
+        napi_set_element(env, result, i, str);
+    }
+    return result;
+}
+
+/**
+ * haversineMeters(lat1, lng1, lat2, lng2) -> meters
+ */
+static napi_value HaversineMeters(napi_env env, napi_callback_info info) {
+    napi_value args[4];
+    size_t argc;
+    if (!get_args(env, info, 4, 4, args, &argc, "Expected lat1, lng1, lat2, lng2")) return NULL;
+
+    double v[4];
+    for (int i = 0; i < 4; i++) {
+        if (!get_double(env, args[i], &v[i])) return NULL;
+    }
+    return make_double(env, haversine_meters(v[0], v[1], v[2], v[3]));
+}
+
+/**
+ * haversineBatch(lat, lng, points[, out]) -> Float64Array of meters
+ * points holds interleaved lat/lng pairs
+ */
+static napi_value HaversineBatch(napi_env env, napi_callback_info info) {
+    napi_value args[4];
+    size_t argc;
+    if (!get_args(env, info, 3, 4, args, &argc, "Expected lat, lng, Float64Array points[, out]")) return NULL;
+
+    double lat, lng;
+    void* points;
+    size_t points_len;
+    if (!get_double(env, args[0], &lat) || !get_double(env, args[1], &lng) ||
+        !get_typed(env, args[2], napi_float64_array, &points, &points_len, "Expected Float64Array of lat/lng pairs")) {
+        return NULL;
+    }
+
+    size_t count = points_len / 2;
+    void* out;
+    napi_value result = output_typed(env, args[3], napi_float64_array, sizeof(double), count, &out);
+    if (!result) return NULL;
+
+    haversine_batch(lat, lng, points, count, out);
+    return result;
+}
+
+/**
+ * isWithinRadius(lat1, lng1, lat2, lng2, radiusMeters) -> boolean
+ */
+static napi_value IsWithinRadius(napi_env env, napi_callback_info info) {
+    napi_value args[5];
+    size_t argc;
+    if (!get_args(env, info, 5, 5, args, &argc, "Expected lat1, lng1, lat2, lng2, radiusMeters")) return NULL;
+
+    double v[5];
+    for (int i = 0; i < 5; i++) {
+        if (!get_double(env, args[i], &v[i])) return NULL;
+    }
+
+    napi_value result;
+    napi_get_boolean(env, is_within_radius(v[0], v[1], v[2], v[3], v[4]) != 0, &result);
+    return result;
+}
+
+/**
+ * boundingBox(lat, lng, radiusMeters) -> { minLat, maxLat, minLng, maxLng }
+ */
+static napi_value BoundingBox(napi_env env, napi_callback_info info) {
+    napi_value args[3];
+    size_t argc;
+    if (!get_args(env, info, 3, 3, args, &argc, "Expected lat, lng, radiusMeters")) return NULL;
+
+    double lat, lng, radius;
+    if (!get_double(env, args[0], &lat) || !get_double(env, args[1], &lng) || !get_double(env, args[2], &radius)) {
+        return NULL;
+    }
+
+    double min_lat, max_lat, min_lng, max_lng;
+    bounding_box(lat, lng, radius, &min_lat, &max_lat, &min_lng, &max_lng);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "minLat", make_double(env, min_lat));
+    napi_set_named_property(env, result, "maxLat", make_double(env, max_lat));
+    napi_set_named_property(env, result, "minLng", make_double(env, min_lng));
+    napi_set_named_property(env, result, "maxLng", make_double(env, max_lng));
+    return result;
+}
+
+/**
+ * optimalPrecision(radiusMeters) -> 1-12
+ */
+static napi_value OptimalPrecision(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected radiusMeters")) return NULL;
+
+    double radius;
+    if (!get_double(env, args[0], &radius)) return NULL;
+    return make_int32(env, optimal_precision(radius));
+}
+
+/**
+ * geohashEncodeBatch(coords, precision = 9) -> (string | null)[]
+ * coords holds interleaved lat/lng pairs
+ */
+static napi_value GeohashEncodeBatch(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 1, 2, args, &argc, "Expected Float64Array coords[, precision]")) return NULL;
+
+    void* data;
+    size_t len;
+    int32_t precision;
+    if (!get_typed(env, args[0], napi_float64_array, &data, &len, "Expected Float64Array of lat/lng pairs") ||
+        !get_int32_or(env, args[1], 9, &precision)) {
+        return NULL;
+    }
+
+    const double* coords = data;
+    size_t count = len / 2;
+
+    napi_value result;
+    napi_create_array_with_length(env, count, &result);
+    for (size_t i = 0; i < count; i++) {
+        char hash[GEOHASH_MAX_LEN + 1];
+        int hash_len = geohash_encode(coords[2 * i], coords[2 * i + 1], precision, hash);
+
+        napi_value str;
+        if (hash_len < 0) {
+            napi_get_null(env, &str);
+        } else {
+            napi_create_string_utf8(env, hash, (size_t)hash_len, &str);
+        }
+        napi_set_element(env, result, (uint32_t)i, str);
+    }
+    return result;
+}
+
+/* ============================================
+ * LIBRATELIMIT
+ * ============================================ */
+
+/**
+ * Rate limiter handle held by a JS external
+ * rl is NULL once ratelimitDestroy has run; the finalizer frees the rest
+ */
+typedef struct {
+    RateLimiter* rl;
+} LimiterHandle;
+
+static const napi_type_tag LIMITER_TAG = {0x6d75736c656d6170ULL, 0x726174656c696d74ULL};
+
+static void limiter_finalize(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)hint;
+    LimiterHandle* handle = data;
+    ratelimit_destroy(handle->rl);
+    free(handle);
+}
+
+/**
+ * Resolve a limiter handle; throws on anything else or a destroyed limiter
+ */
+static RateLimiter* get_limiter(napi_env env, napi_value value) {
+    bool tagged = false;
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    if (type == napi_external) {
+        napi_check_object_type_tag(env, value, &LIMITER_TAG, &tagged);
+    }
+    if (!tagged) {
+        napi_throw_type_error(env, NULL, "Expected rate limiter handle");
+        return NULL;
+    }
+
+    LimiterHandle* handle;
+    napi_get_value_external(env, value, (void**)&handle);
+    if (!handle->rl) {
+        napi_throw_error(env, NULL, "Rate limiter has been destroyed");
+        return NULL;
+    }
+    return handle->rl;
+}
+
+/**
+ * ratelimitCreate(capacity, limit) -> handle
+ */
+static napi_value RatelimitCreate(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 2, 2, args, &argc, "Expected capacity, limit")) return NULL;
+
+    double capacity, limit;
+    if (!get_double(env, args[0], &capacity) || !get_double(env, args[1], &limit)) return NULL;
+    if (capacity < 1 || limit < 0 || limit > UINT32_MAX) {
+        napi_throw_range_error(env, NULL, "Capacity must be positive and limit a uint32");
+        return NULL;
+    }
+
+    LimiterHandle* handle = malloc(sizeof(LimiterHandle));
+    if (!handle) {
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+    handle->rl = ratelimit_create((size_t)capacity, (uint32_t)limit);
+    if (!handle->rl) {
+        free(handle);
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_create_external(env, handle, limiter_finalize, NULL, &result);
+    napi_type_tag_object(env, result, &LIMITER_TAG);
+    return result;
+}
+
+/**
+ * ratelimitDestroy(handle): free now instead of at garbage collection
+ */
+static napi_value RatelimitDestroy(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected rate limiter handle")) return NULL;
+    if (!get_limiter(env, args[0])) return NULL;
+
+    LimiterHandle* handle;
+    napi_get_value_external(env, args[0], (void**)&handle);
+    ratelimit_destroy(handle->rl);
+    handle->rl = NULL;
+    return NULL;
+}
+
+/**
+ * ratelimitCheck(handle, userId, count = 1) -> 1 allowed, 0 limited, -1 error
+ * count must be positive (RangeError otherwise), as for ratelimitCheckBatch
+ */
+static napi_value RatelimitCheck(napi_env env, napi_callback_info info) {
+    napi_value args[3];
+    size_t argc;
+    if (!get_args(env, info, 2, 3, args, &argc, "Expected handle, userId[, count]")) return NULL;
+
+    RateLimiter* rl = get_limiter(env, args[0]);
+    uint64_t user_id;
+    uint32_t count;
+    if (!rl || !get_user_id(env, args[1], &user_id) || !get_count(env, args[2], &count)) return NULL;
+
+    return make_int32(env, ratelimit_check(rl, user_id, count));
+}
+
+/**
+ * ratelimitCheckBatch(handle, userIds, count = 1[, out]) -> Int8Array verdicts
+ * userIds is a BigUint64Array or a Float64Array of safe integers
+ */
+static napi_value RatelimitCheckBatch(napi_env env, napi_callback_info info) {
+    napi_value args[4];
+    size_t argc;
+    if (!get_args(env, info, 2, 4, args, &argc, "Expected handle, userIds[, count[, out]]")) return NULL;
+
+    RateLimiter* rl = get_limiter(env, args[0]);
+    uint32_t count;
+    if (!rl || !get_count(env, args[2], &count)) return NULL;
+
+    bool is_typed = false;
+    napi_typedarray_type type = napi_int8_array;
+    size_t n = 0;
+    void* data = NULL;
+    napi_is_typedarray(env, args[1], &is_typed);
+    if (is_typed) {
+        napi_get_typedarray_info(env, args[1], &type, &n, &data, NULL, NULL);
+    }
+    if (type != napi_biguint64_array && type != napi_float64_array) {
+        napi_throw_type_error(env, NULL, "Expected BigUint64Array or Float64Array of user IDs");
+        return NULL;
+    }
+
+    void* out;
+    napi_value result = output_typed(env, args[3], napi_int8_array, sizeof(int8_t), n, &out);
+    if (!result) return NULL;
+
+    const uint64_t* ids = data;
+    uint64_t* converted = NULL;
+    if (type == napi_float64_array) {
+        converted = malloc((n ? n : 1) * sizeof(uint64_t));
+        if (!converted) {
+            napi_throw_error(env, NULL, "Out of memory");
+            return NULL;
+        }
+        for (size_t i = 0; i < n; i++) {
+            double id = ((const double*)data)[i];
+            converted[i] = id > 0 ? (uint64_t)id : 0;
+        }
+        ids = converted;
+    }
+
+    ratelimit_check_batch(rl, ids, n, count, out);
+    free(converted);
+    return result;
+}
+
+/**
+ * ratelimitRemaining(handle, userId) -> remaining requests in the window
+ */
+static napi_value RatelimitRemaining(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 2, 2, args, &argc, "Expected handle, userId")) return NULL;
+
+    RateLimiter* rl = get_limiter(env, args[0]);
+    uint64_t user_id;
+    if (!rl || !get_user_id(env, args[1], &user_id)) return NULL;
+    return make_int32(env, ratelimit_remaining(rl, user_id));
+}
+
+/**
+ * ratelimitResetMs(handle, userId) -> milliseconds until allowance frees up
+ */
+static napi_value RatelimitResetMs(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 2, 2, args, &argc, "Expected handle, userId")) return NULL;
+
+    RateLimiter* rl = get_limiter(env, args[0]);
+    uint64_t user_id;
+    if (!rl || !get_user_id(env, args[1], &user_id)) return NULL;
+    return make_double(env, (double)ratelimit_reset_ms(rl, user_id));
+}
+
+/**
+ * ratelimitResetUser(handle, userId) -> 0 on success
+ */
+static napi_value RatelimitResetUser(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 2, 2, args, &argc, "Expected handle, userId")) return NULL;
+
+    RateLimiter* rl = get_limiter(env, args[0]);
+    uint64_t user_id;
+    if (!rl || !get_user_id(env, args[1], &user_id)) return NULL;
+    return make_int32(env, ratelimit_reset_user(rl, user_id));
+}
+
+/**
+ * ratelimitStats(handle) -> { activeUsers, totalRequests }
+ */
+static napi_value RatelimitStats(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected rate limiter handle")) return NULL;
+
+    RateLimiter* rl = get_limiter(env, args[0]);
+    if (!rl) return NULL;
+
+    size_t active_users = 0;
+    uint64_t total_requests = 0;
+    ratelimit_stats(rl, &active_users, &total_requests);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "activeUsers", make_double(env, (double)active_users));
+    napi_set_named_property(env, result, "totalRequests", make_double(env, (double)total_requests));
+    return result;
+}
+
+/**
+ * ratelimitClearAll(handle) -> 0 on success
+ */
+static napi_value RatelimitClearAll(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected rate limiter handle")) return NULL;
+
+    RateLimiter* rl = get_limiter(env, args[0]);
+    if (!rl) return NULL;
+    return make_int32(env, ratelimit_clear_all(rl));
+}
+
+/* ============================================
+ * LIBRANK
+ * ============================================ */
+
+/**
+ * rankFullRanking([{ userId, score }]) -> [{ userId, score, rank, percentile }]
+ * Sorted by score descending; ties share a rank
+ */
+static napi_value RankFullRanking(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected array of { userId, score }")) return NULL;
+
+    bool is_array = false;
+    napi_is_array(env, args[0], &is_array);
+    if (!is_array) {
+        napi_throw_type_error(env, NULL, "Expected array of { userId, score }");
+        return NULL;
+    }
+
+    uint32_t count;
+    napi_get_array_length(env, args[0], &count);
+
+    napi_value result;
+    napi_create_array_with_length(env, count, &result);
+    if (count == 0) return result;
+
+    RankedUser* users = calloc(count, sizeof(RankedUser));
+    if (!users) {
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value elem, val;
+        napi_get_element(env, args[0], i, &elem);
+
+        size_t len;
+        napi_get_named_property(env, elem, "userId", &val);
+        napi_get_value_string_utf8(env, val, users[i].user_id, USER_ID_LEN, &len);
+        napi_get_named_property(env, elem, "score", &val);
+        napi_get_value_double(env, val, &users[i].score);
+    }
+
+    if (rank_full_ranking(users, count) != 0) {
+        free(users);
+        napi_throw_range_error(env, NULL, "Too many users to rank");
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value item, user_id;
+        napi_create_object(env, &item);
+        napi_create_string_utf8(env, users[i].user_id, NAPI_AUTO_LENGTH, &user_id);
+        napi_set_named_property(env, item, "userId", user_id);
+        napi_set_named_property(env, item, "score", make_double(env, users[i].score));
+        napi_set_named_property(env, item, "rank", make_int32(env, users[i].rank));
+        napi_set_named_property(env, item, "percentile", make_double(env, users[i].percentile));
+        napi_set_element(env, result, i, item);
+    }
+
+    free(users);
+    return result;
+}
+
+/**
+ * rankSimplePercentiles(scores[, out]) -> Float64Array percentiles
+ * Percentiles are in the input order
+ */
+static napi_value RankSimplePercentiles(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 1, 2, args, &argc, "Expected Float64Array scores[, out]")) return NULL;
+
+    void* scores;
+    size_t count;
+    if (!get_typed(env, args[0], napi_float64_array, &scores, &count, "Expected Float64Array of scores")) return NULL;
+
+    void* out;
+    napi_value result = output_typed(env, args[1], napi_float64_array, sizeof(double), count, &out);
+    if (!result) return NULL;
+
+    if (count > 0 && rank_simple_percentiles(scores, count, out) != 0) {
+        napi_throw_range_error(env, NULL, "Too many scores to rank");
+        return NULL;
+    }
+    return result;
+}
+
+/**
+ * rankFindRank(sortedScores, score) -> 1-based rank, or -1
+ */
+static napi_value RankFindRank(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 2, 2, args, &argc, "Expected Float64Array sortedScores, score")) return NULL;
+
+    void* scores;
+    size_t count;
+    double target;
+    if (!get_typed(env, args[0], napi_float64_array, &scores, &count, "Expected Float64Array of sorted scores") ||
+        !get_double(env, args[1], &target)) {
+        return NULL;
+    }
+    return make_int32(env, rank_find_rank(scores, count, target));
+}
+
+/**
+ * rankCalculateStats(sortedScores) -> { min, max, mean, median, stdDev } | null
+ * Scores sorted descending, as returned by rankFullRanking
+ */
+static napi_value RankCalculateStats(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected Float64Array sortedScores")) return NULL;
+
+    void* data;
+    size_t count;
+    if (!get_typed(env, args[0], napi_float64_array, &data, &count, "Expected Float64Array of sorted scores")) {
+        return NULL;
+    }
+    if (count == 0) return make_null(env);
+
+    RankedUser* users = calloc(count, sizeof(RankedUser));
+    if (!users) {
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        users[i].score = ((const double*)data)[i];
+    }
+
+    RankStats stats;
+    int status = rank_calculate_stats(users, count, &stats);
+    free(users);
+    if (status != 0) return make_null(env);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "min", make_double(env, stats.min_score));
+    napi_set_named_property(env, result, "max", make_double(env, stats.max_score));
+    napi_set_named_property(env, result, "mean", make_double(env, stats.mean_score));
+    napi_set_named_property(env, result, "median", make_double(env, stats.median_score));
+    napi_set_named_property(env, result, "stdDev", make_double(env, stats.std_dev));
+    return result;
+}
+
+/* ============================================
+ * LIBTU
+ * ============================================ */
+
+/**
+ * tuInit() -> 0
+ */
+static napi_value TuInit(napi_env env, napi_callback_info info) {
+    (void)info;
+    return make_int32(env, tu_init());
+}
+
+/**
+ * tuClear()
+ */
+static napi_value TuClear(napi_env env, napi_callback_info info) {
+    (void)env;
+    (void)info;
+    tu_clear();
+    return NULL;
+}
+
+/**
+ * tuAddExercise(id, activations) -> index, or -1
+ * activations: Float32Array or number[] of percentages, one per muscle
+ */
+static napi_value TuAddExercise(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 2, 2, args, &argc, "Expected id, activations")) return NULL;
+
+    char id[ID_BUFFER_LEN];
+    if (!get_string(env, args[0], id, sizeof(id))) return NULL;
+
+    float activations[MAX_MUSCLES] = {0};
+    uint32_t count = 0;
+
+    bool is_typed = false, is_array = false;
+    napi_is_typedarray(env, args[1], &is_typed);
+    napi_is_array(env, args[1], &is_array);
+    if (is_typed) {
+        void* data;
+        size_t len;
+        if (!get_typed(env, args[1], napi_float32_array, &data, &len, "Expected Float32Array of activations")) {
+            return NULL;
+        }
+        count = len > MAX_MUSCLES ? MAX_MUSCLES + 1 : (uint32_t)len;
+        memcpy(activations, data, (count > MAX_MUSCLES ? MAX_MUSCLES : count) * sizeof(float));
+    } else if (is_array) {
+        napi_get_array_length(env, args[1], &count);
+        for (uint32_t m = 0; m < count && m < MAX_MUSCLES; m++) {
+            napi_value val;
+            double act = 0.0;
+            napi_get_element(env, args[1], m, &val);
+            napi_get_value_double(env, val, &act);
+            activations[m] = (float)act;
+        }
+    } else {
+        napi_throw_type_error(env, NULL, "Expected activations array");
+        return NULL;
+    }
+
+    return make_int32(env, tu_add_exercise(id, activations, (int32_t)count));
+}
+
+/**
+ * tuAddMuscle(id, biasWeight) -> index, or -1
+ */
+static napi_value TuAddMuscle(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    size_t argc;
+    if (!get_args(env, info, 2, 2, args, &argc, "Expected id, biasWeight")) return NULL;
+
+    char id[ID_BUFFER_LEN];
+    double bias;
+    if (!get_string(env, args[0], id, sizeof(id)) || !get_double(env, args[1], &bias)) return NULL;
+    return make_int32(env, tu_add_muscle(id, (float)bias));
+}
+
+/**
+ * tuFindExercise(id) -> index, or -1
+ */
+static napi_value TuFindExercise(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected exercise id")) return NULL;
+
+    char id[ID_BUFFER_LEN];
+    if (!get_string(env, args[0], id, sizeof(id))) return NULL;
+    return make_int32(env, tu_find_exercise(id));
+}
+
+/**
+ * tuLoadCatalog(path) -> exercise count; throws if the file is unusable
+ */
+static napi_value TuLoadCatalog(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected catalog path")) return NULL;
+
+    char path[PATH_BUFFER_LEN];
+    if (!get_string(env, args[0], path, sizeof(path))) return NULL;
+
+    int count = tu_load_catalog(path);
+    if (count < 0) {
+        napi_throw_error(env, NULL, catalog_error_string(count));
+        return NULL;
+    }
+    return make_int32(env, count);
+}
+
+/**
+ * tuGetStats() -> { exerciseCount, muscleCount }
+ */
+static napi_value TuGetStats(napi_env env, napi_callback_info info) {
+    (void)info;
+
+    int32_t exercise_count = 0, muscle_count = 0;
+    tu_get_stats(&exercise_count, &muscle_count);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "exerciseCount", make_int32(env, exercise_count));
+    napi_set_named_property(env, result, "muscleCount", make_int32(env, muscle_count));
+    return result;
+}
+
+/**
+ * tuCalculate([{ exerciseIndex, sets, reps?, weight? }])
+ *   -> { totalTu, muscleActivations: Float32Array } | null
+ */
+static napi_value TuCalculate(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    size_t argc;
+    if (!get_args(env, info, 1, 1, args, &argc, "Expected array of workout exercises")) return NULL;
+
+    bool is_array = false;
+    napi_is_array(env, args[0], &is_array);
+    if (!is_array) {
+        napi_throw_type_error(env, NULL, "Expected array of workout exercises");
+        return NULL;
+    }
+
+    uint32_t count;
+    napi_get_array_length(env, args[0], &count);
+    if (count == 0 || count > MAX_WORKOUT_EXERCISES) return make_null(env);
+
+    WorkoutExerciseInput inputs[MAX_WORKOUT_EXERCISES];
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value elem, val;
+        double weight = 0.0;
+        napi_get_element(env, args[0], i, &elem);
+
+        inputs[i] = (WorkoutExerciseInput){-1, 0, 10, 0.0f};
+        napi_get_named_property(env, elem, "exerciseIndex", &val);
+        napi_get_value_int32(env, val, &inputs[i].exercise_index);
+        napi_get_named_property(env, elem, "sets", &val);
+        napi_get_value_int32(env, val, &inputs[i].sets);
+        napi_get_named_property(env, elem, "reps", &val);
+        napi_get_value_int32(env, val, &inputs[i].reps);
+        napi_get_named_property(env, elem, "weight", &val);
+        if (napi_get_value_double(env, val, &weight) == napi_ok) inputs[i].weight = (float)weight;
+    }
+
+    TUResult tu;
+    if (tu_calculate(inputs, (int32_t)count, &tu) != 0) return make_null(env);
+
+    void* activations;
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_value muscles = output_typed(env, undefined, napi_float32_array, sizeof(float), MAX_MUSCLES, &activations);
+    if (!muscles) return NULL;
+    memcpy(activations, tu.muscle_activations, sizeof(tu.muscle_activations));
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "totalTu", make_double(env, tu.total_tu));
+    napi_set_named_property(env, result, "muscleActivations", muscles);
+    return result;
+}
+
+/**
+ * tuCalculateBatch(packed, offsets[, out]) -> Float32Array of total TU
+ * packed holds (exerciseIndex, sets) pairs; workout w spans pairs
+ * offsets[w] .. offsets[w + 1]. Workouts that fail to calculate yield NaN.
+ */
+static napi_value TuCalculateBatch(napi_env env, napi_callback_info info) {
+    napi_value args[3];
+    size_t argc;
+    if (!get_args(env, info, 2, 3, args, &argc, "Expected Int32Array packed, Int32Array offsets[, out]")) return NULL;
+
+    void* packed_data;
+    void* offset_data;
+    size_t packed_len, offset_len;
+    if (!get_typed(env, args[0], napi_int32_array, &packed_data, &packed_len, "Expected Int32Array of (index, sets) pairs") ||
+        !get_typed(env, args[1], napi_int32_array, &offset_data, &offset_len, "Expected Int32Array of workout offsets")) {
+        return NULL;
+    }
+
+    const int32_t* packed = packed_data;
+    const int32_t* offsets = offset_data;
+    size_t batch = offset_len > 0 ? offset_len - 1 : 0;
+    int32_t pairs = (int32_t)(packed_len / 2);
+    if (batch > INT32_MAX) {
+        napi_throw_range_error(env, NULL, "Batch too large");
+        return NULL;
+    }
+    for (size_t w = 0; w < batch; w++) {
+        if (offsets[w] < 0 || offsets[w + 1] < offsets[w] || offsets[w + 1] > pairs) {
+            napi_throw_range_error(env, NULL, "Workout offsets must be ascending and within packed");
+            return NULL;
+        }
+    }
+
+    void* out;
+    napi_value result = output_typed(env, args[2], napi_float32_array, sizeof(float), batch, &out);
+    if (!result) return NULL;
+
+    WorkoutExerciseInput* inputs = malloc(((size_t)pairs + 1) * sizeof(WorkoutExerciseInput));
+    const WorkoutExerciseInput** workouts = malloc((batch + 1) * sizeof(WorkoutExerciseInput*));
+    int32_t* counts = malloc((batch + 1) * sizeof(int32_t));
+    TUResult* results = malloc((batch + 1) * sizeof(TUResult));
+    if (!inputs || !workouts || !counts || !results) {
+        free(inputs);
+        free(workouts);
+        free(counts);
+        free(results);
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < pairs; i++) {
+        inputs[i] = (WorkoutExerciseInput){packed[2 * i], packed[2 * i + 1], 10, 0.0f};
+    }
+    for (size_t w = 0; w < batch; w++) {
+        workouts[w] = inputs + offsets[w];
+        counts[w] = offsets[w + 1] - offsets[w];
+        results[w].total_tu = NAN;
+    }
+
+    if (batch > 0) {
+        tu_calculate_batch(workouts, counts, (int32_t)batch, results);
+    }
+
+    /* tu_calculate leaves rejected workouts untouched, so they stay NaN */
+    float* totals = out;
+    for (size_t w = 0; w < batch; w++) {
+        totals[w] = results[w].total_tu;
+    }
+
+    free(inputs);
+    free(workouts);
+    free(counts);
+    free(results);
+    return result;
+}
+
+/**
+ * tuCalculateSimple(activations, sets, biasWeights, exerciseCount, muscleCount) -> total TU
+ * activations: Float32Array [exerciseCount * muscleCount]; sets: Int32Array;
+ * biasWeights: Float32Array [muscleCount]
+ */
+static napi_value TuCalculateSimple(napi_env env, napi_callback_info info) {
+    napi_value args[5];
+    size_t argc;
+    if (!get_args(env, info, 5, 5, args, &argc,
+                  "Expected activations, sets, biasWeights, exerciseCount, muscleCount")) {
+        return NULL;
+    }
+
+    void* activations;
+    void* sets;
+    void* bias;
+    size_t activations_len, sets_len, bias_len;
+    int32_t exercise_count, muscle_count;
+    if (!get_typed(env, args[0], napi_float32_array, &activations, &activations_len, "Expected Float32Array activations") ||
+        !get_typed(env, args[1], napi_int32_array, &sets, &sets_len, "Expected Int32Array sets") ||
+        !get_typed(env, args[2], napi_float32_array, &bias, &bias_len, "Expected Float32Array bias weights") ||
+        !get_int32_or(env, args[3], 0, &exercise_count) || !get_int32_or(env, args[4], 0, &muscle_count)) {
+        return NULL;
+    }
+
+    if (exercise_count < 0 || muscle_count < 0 || muscle_count > MAX_MUSCLES ||
+        activations_len < (size_t)exercise_count * (size_t)muscle_count ||
+        sets_len < (size_t)exercise_count || bias_len < (size_t)muscle_count) {
+        napi_throw_range_error(env, NULL, "Array lengths do not match exerciseCount and muscleCount");
+        return NULL;
+    }
+
+    return make_double(env, tu_calculate_simple(activations, sets, bias, exercise_count, muscle_count));
+}
+
+/* ============================================
+ * CALL STATISTICS
+ * ============================================ */
+
+/**
+ * nativeStatsEnabled() -> boolean (built with native_stats=1)
+ */
+static napi_value NativeStatsEnabled(napi_env env, napi_callback_info info) {
+    (void)info;
+    napi_value result;
+    napi_get_boolean(env, native_stats_enabled() != 0, &result);
+    return result;
+}
+
+/**
+ * nativeStatsSnapshot() -> [{ name, calls, totalNs, meanNs, p50Ns, p90Ns,
+ *   p99Ns, maxNs, histogram: [[upperNs, count], ...] }]
+ * Histogram lists non-empty buckets only, by increasing upper bound
+ */
+static napi_value NativeStatsSnapshot(napi_env env, napi_callback_info info) {
+    (void)info;
+    NativeStatsEntry* entries = malloc(NATIVE_STATS_MAX_SITES * sizeof(NativeStatsEntry));
+    if (!entries) {
+        napi_throw_error(env, NULL, "Out of memory");
+        return NULL;
+    }
+    int32_t count = native_stats_snapshot(entries, NATIVE_STATS_MAX_SITES);
+    if (count > NATIVE_STATS_MAX_SITES) count = NATIVE_STATS_MAX_SITES;
+
+    napi_value result;
+    napi_create_array_with_length(env, (size_t)count, &result);
+    for (int32_t i = 0; i < count; i++) {
+        const NativeStatsEntry* e = &entries[i];
+        napi_value item, name, histogram;
+        napi_create_object(env, &item);
+        napi_create_string_utf8(env, e->name, NAPI_AUTO_LENGTH, &name);
+        napi_set_named_property(env, item, "name", name);
+        napi_set_named_property(env, item, "calls", make_double(env, (double)e->calls));
+        napi_set_named_property(env, item, "totalNs", make_double(env, e->total_ns));
+        napi_set_named_property(env, item, "meanNs", make_double(env, e->mean_ns));
+        napi_set_named_property(env, item, "p50Ns", make_double(env, e->p50_ns));
+        napi_set_named_property(env, item, "p90Ns", make_double(env, e->p90_ns));
+        napi_set_named_property(env, item, "p99Ns", make_double(env, e->p99_ns));
+        napi_set_named_property(env, item, "maxNs", make_double(env, e->max_ns));
+
+        napi_create_array(env, &histogram);
+        uint32_t filled = 0;
+        for (int32_t b = 0; b < NATIVE_STATS_BUCKETS; b++) {
+            if (e->buckets[b] == 0) continue;
+            napi_value pair;
+            napi_create_array_with_length(env, 2, &pair);
+            napi_set_element(env, pair, 0, make_double(env, native_stats_bucket_limit(b)));
+            napi_set_element(env, pair, 1, make_double(env, (double)e->buckets[b]));
+            napi_set_element(env, histogram, filled++, pair);
+        }
+        napi_set_named_property(env, item, "histogram", histogram);
+        napi_set_element(env, result, (uint32_t)i, item);
+    }
+
+    free(entries);
+    return result;
+}
+
+/**
+ * nativeStatsReset()
+ */
+static napi_value NativeStatsReset(napi_env env, napi_callback_info info) {
+    (void)env;
+    (void)info;
+    native_stats_reset();
+    return NULL;
+}
+
+/* ============================================
+ * CALL CAPTURE
+ * ============================================ */
+
+/**
+ * nativeCaptureEnabled() -> boolean (built with native_capture=1)
+ */
+static napi_value NativeCaptureEnabled(napi_env env, napi_callback_info info) {
+    (void)info;
+    napi_value result;
+    napi_get_boolean(env, native_capture_enabled() != 0, &result);
+    return result;
+}
+
+/**
+ * nativeCaptureStart(path[, sampleEvery = 100[, records = 65536]])
+ * Replaces any running capture; "%p" in path expands to the pid.
+ * Throws a RangeError for records below NATIVE_CAPTURE_MIN_RECORDS, and
+ * an Error if the ring file cannot be created.
+ */
+static napi_value NativeCaptureStart(napi_env env, napi_callback_info info) {
+    napi_value args[3];
+    size_t argc;
+    if (!get_args(env, info, 1, 3, args, &argc, "Expected path[, sampleEvery[, records]]")) return NULL;
+
+    char path[PATH_BUFFER_LEN];
+    int32_t sample_every, records;
+    if (!get_string(env, args[0], path, sizeof(path)) ||
+        !get_int32_or(env, args[1], 100, &sample_every) ||
+        !get_int32_or(env, args[2], 65536, &records)) {
+        return NULL;
+    }
+    if (sample_every < 1) {
+        napi_throw_range_error(env, NULL, "sampleEvery must be positive");
+        return NULL;
+    }
+    if (records < NATIVE_CAPTURE_MIN_RECORDS) {
+        char message[64];
+        snprintf(message, sizeof(message), "records must be at least %d", NATIVE_CAPTURE_MIN_RECORDS);
+        napi_throw_range_error(env, NULL, message);
+        return NULL;
+    }
+
+    if (native_capture_start(path, (uint32_t)sample_every, (uint64_t)records) != 0) {
+        napi_throw_error(env, NULL, "Cannot create capture file");
+        return NULL;
+    }
+    return NULL;
+}
+
+/**
+ * nativeCaptureStop() -> calls captured (the file keeps the latest `records`)
+ */
+static napi_value NativeCaptureStop(napi_env env, napi_callback_info info) {
+    (void)info;
+    return make_double(env, (double)native_capture_stop());
+}
+
+/* ============================================
+ * MODULE
+ * ============================================ */
+
+/**
+ * Module initialization
+ */
+static napi_value Init(napi_env env, napi_value exports) {
+    static const struct {
+        const char* name;
+        napi_callback fn;
+    } FUNCTIONS[] = {
+        {"geohashEncode", GeohashEncode},
+        {"geohashDecode", GeohashDecode},
+        {"geohashPrecisionError", GeohashPrecisionError},
+        {"geohashNeighbors", GeohashNeighbors},
+        {"geohashEncodeBatch", GeohashEncodeBatch},
+        {"haversineMeters", HaversineMeters},
+        {"haversineBatch", HaversineBatch},
+        {"isWithinRadius", IsWithinRadius},
+        {"boundingBox", BoundingBox},
+        {"optimalPrecision", OptimalPrecision},
+
+        {"ratelimitCreate", RatelimitCreate},
+        {"ratelimitDestroy", RatelimitDestroy},
+        {"ratelimitCheck", RatelimitCheck},
+        {"ratelimitCheckBatch", RatelimitCheckBatch},
+        {"ratelimitRemaining", RatelimitRemaining},
+        {"ratelimitResetMs", RatelimitResetMs},
+        {"ratelimitResetUser", RatelimitResetUser},
+        {"ratelimitStats", RatelimitStats},
+        {"ratelimitClearAll", RatelimitClearAll},
+
+        {"rankFullRanking", RankFullRanking},
+        {"rankSimplePercentiles", RankSimplePercentiles},
+        {"rankFindRank", RankFindRank},
+        {"rankCalculateStats", RankCalculateStats},
+
+        {"tuInit", TuInit},
+        {"tuClear", TuClear},
+        {"tuAddExercise", TuAddExercise},
+        {"tuAddMuscle", TuAddMuscle},
+        {"tuFindExercise", TuFindExercise},
+        {"tuLoadCatalog", TuLoadCatalog},
+        {"tuGetStats", TuGetStats},
+        {"tuCalculate", TuCalculate},
+        {"tuCalculateBatch", TuCalculateBatch},
+        {"tuCalculateSimple", TuCalculateSimple},
+
+        {"nativeStatsEnabled", NativeStatsEnabled},
+        {"nativeStatsSnapshot", NativeStatsSnapshot},
+        {"nativeStatsReset", NativeStatsReset},
+
+        {"nativeCaptureEnabled", NativeCaptureEnabled},
+        {"nativeCaptureStart", NativeCaptureStart},
+        {"nativeCaptureStop", NativeCaptureStop},
+    };
+
+    for (size_t i = 0; i < sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]); i++) {
+        napi_value fn;
+        napi_create_function(env, FUNCTIONS[i].name, NAPI_AUTO_LENGTH, FUNCTIONS[i].fn, NULL, &fn);
+        napi_set_named_property(env, exports, FUNCTIONS[i].name, fn);
+    }
+
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
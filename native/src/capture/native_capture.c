@@ -0,0 +1,293 @@
+/**
+ * Native Call Capture
+ *
+ * Compile: gcc -O3 -fPIC -shared -DMUSCLEMAP_NATIVE_CAPTURE -o libnativecapture.so native_capture.c -lpthread
+ *
+ * Features:
+ * - Sampled per thread (a thread-local countdown, no shared state until a
+ *   call is sampled)
+ * - Records filled on the caller's stack and copied into a MAP_SHARED
+ *   ring file when the call returns, so a crash keeps everything
+ *   captured so far
+ * - Lock-free claim of ring slots at copy time; stop waits only for
+ *   calls that are mid-copy
+ * - Optional start at load time from MUSCLEMAP_CAPTURE*
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "native_capture.h"
+
+#ifdef _WIN32
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT __attribute__((visibility("default")))
+#endif
+
+/* Configuration constants */
+#define DEFAULT_SAMPLE_EVERY 100
+#define DEFAULT_RECORDS 65536
+#define MAX_RECORDS (1ull << 24)        /* 2 GB ring */
+#define MAX_PATH_LEN 4096
+
+EXPORT _Atomic uint32_t native_capture_running = 0;
+
+/**
+ * Capture state
+ * Writers check `running`, then register in `writers` before touching the
+ * mapping; stop clears `running` and waits for `writers` to drain before
+ * unmapping.
+ */
+static struct {
+    pthread_mutex_t lock;       /* start / stop */
+    NativeCaptureHeader* header;
+    NativeCaptureRecord* records;
+    size_t map_size;
+    uint64_t mask;              /* capacity - 1 */
+    uint32_t sample_every;
+    uint64_t start_ns;          /* CLOCK_MONOTONIC origin of time_ns */
+    uint32_t generation;        /* Captures started so far */
+    _Atomic uint64_t writers;
+    _Atomic uint32_t next_thread;
+} g_capture = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* Calls left before this thread samples again, and its capture thread number + 1 */
+static _Thread_local uint32_t tl_countdown __attribute__((tls_model("initial-exec")));
+static _Thread_local uint32_t tl_thread __attribute__((tls_model("initial-exec")));
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Expand "%p" in path to the pid
+ */
+static int expand_path(const char* path, char* out, size_t out_len) {
+    size_t used = 0;
+    for (const char* p = path; *p; p++) {
+        int written;
+        if (p[0] == '%' && p[1] == 'p') {
+            written = snprintf(out + used, out_len - used, "%ld", (long)getpid());
+            p++;
+        } else {
+            written = snprintf(out + used, out_len - used, "%c", *p);
+        }
+        if (written < 0 || (size_t)written >= out_len - used) {
+            return -1;
+        }
+        used += (size_t)written;
+    }
+    return 0;
+}
+
+/**
+ * Clear `running` and unmap once no call is writing (lock held)
+ */
+static uint64_t stop_locked(void) {
+    if (!g_capture.header) {
+        return 0;
+    }
+
+    atomic_store(&native_capture_running, 0);
+    while (atomic_load(&g_capture.writers) != 0) {
+        sched_yield();
+    }
+
+    uint64_t captured = atomic_load(&g_capture.header->next);
+    msync(g_capture.header, g_capture.map_size, MS_ASYNC);
+    munmap(g_capture.header, g_capture.map_size);
+    g_capture.header = NULL;
+    g_capture.records = NULL;
+    return captured;
+}
+
+/* ============================================
+ * CONTROL
+ * ============================================ */
+
+EXPORT int native_capture_enabled(void) {
+#ifdef MUSCLEMAP_NATIVE_CAPTURE
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+EXPORT int native_capture_start(const char* path, uint32_t sample_every, uint64_t records) {
+    char file_path[MAX_PATH_LEN];
+    if (!path || records < NATIVE_CAPTURE_MIN_RECORDS || expand_path(path, file_path, sizeof(file_path)) != 0) {
+        return -1;
+    }
+
+    uint64_t capacity = NATIVE_CAPTURE_MIN_RECORDS;
+    while (capacity < records && capacity < MAX_RECORDS) {
+        capacity <<= 1;
+    }
+    size_t map_size = sizeof(NativeCaptureHeader) + (size_t)capacity * sizeof(NativeCaptureRecord);
+
+    int fd = open(file_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)map_size) != 0) {
+        close(fd);
+        return -1;
+    }
+    void* base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    /* The file is zero-filled: every record starts empty (sequence 0) */
+    NativeCaptureHeader* header = base;
+    memcpy(header->magic, NATIVE_CAPTURE_MAGIC, sizeof(header->magic));
+    header->version = NATIVE_CAPTURE_VERSION;
+    header->record_size = sizeof(NativeCaptureRecord);
+    header->capacity = capacity;
+    header->sample_every = sample_every ? sample_every : 1;
+    header->pid = (uint32_t)getpid();
+    header->start_realtime_ns = realtime_ns();
+    atomic_init(&header->next, 0);
+
+    pthread_mutex_lock(&g_capture.lock);
+    stop_locked();
+    g_capture.header = header;
+    g_capture.records = (NativeCaptureRecord*)(header + 1);
+    g_capture.map_size = map_size;
+    g_capture.mask = capacity - 1;
+    g_capture.sample_every = header->sample_every;
+    g_capture.start_ns = monotonic_ns();
+    g_capture.generation++;
+    atomic_store(&native_capture_running, 1);
+    pthread_mutex_unlock(&g_capture.lock);
+    return 0;
+}
+
+EXPORT uint64_t native_capture_stop(void) {
+    pthread_mutex_lock(&g_capture.lock);
+    uint64_t captured = stop_locked();
+    pthread_mutex_unlock(&g_capture.lock);
+    return captured;
+}
+
+/**
+ * Start from the environment when MUSCLEMAP_CAPTURE is set
+ */
+__attribute__((constructor))
+static void capture_from_environment(void) {
+#ifdef MUSCLEMAP_NATIVE_CAPTURE
+    const char* path = getenv("MUSCLEMAP_CAPTURE");
+    if (!path || !*path) {
+        return;
+    }
+    const char* sample = getenv("MUSCLEMAP_CAPTURE_SAMPLE");
+    const char* records = getenv("MUSCLEMAP_CAPTURE_RECORDS");
+    uint64_t ring = records ? strtoull(records, NULL, 10) : DEFAULT_RECORDS;
+    if (ring < NATIVE_CAPTURE_MIN_RECORDS) {
+        fprintf(stderr, "musclemap: MUSCLEMAP_CAPTURE_RECORDS must be at least %d, not capturing\n",
+                NATIVE_CAPTURE_MIN_RECORDS);
+        return;
+    }
+    if (native_capture_start(path, sample ? (uint32_t)strtoul(sample, NULL, 10) : DEFAULT_SAMPLE_EVERY,
+                             ring) != 0) {
+        fprintf(stderr, "musclemap: cannot start capture to %s\n", path);
+    }
+#endif
+}
+
+/* ============================================
+ * RECORDING
+ * ============================================ */
+
+EXPORT NativeCaptureRecord* native_capture_begin(NativeCaptureOp op, NativeCaptureRecord* record) {
+    if (tl_countdown > 1) {
+        tl_countdown--;
+        return NULL;
+    }
+
+    /* Register before re-checking, so the capture settings stay put while read */
+    atomic_fetch_add(&g_capture.writers, 1);
+    if (!atomic_load(&native_capture_running)) {
+        atomic_fetch_sub(&g_capture.writers, 1);
+        return NULL;
+    }
+    tl_countdown = g_capture.sample_every;
+    uint32_t generation = g_capture.generation;
+    uint64_t start_ns = g_capture.start_ns;
+    atomic_fetch_sub(&g_capture.writers, 1);
+
+    if (tl_thread == 0) {
+        tl_thread = atomic_fetch_add_explicit(&g_capture.next_thread, 1, memory_order_relaxed) + 1;
+    }
+
+    /* Until the copy, the sequence holds the capture this record belongs to */
+    atomic_init(&record->sequence, generation);
+    record->time_ns = monotonic_ns() - start_ns;
+    record->duration_ns = 0;
+    record->op = (uint16_t)op;
+    record->thread = (uint16_t)(tl_thread - 1);
+    record->flags = 0;
+    record->reserved = 0;
+    memset(record->args, 0, sizeof(record->args));
+    return record;
+}
+
+EXPORT void native_capture_end(NativeCaptureRecord* record) {
+    uint64_t now = monotonic_ns();
+
+    atomic_fetch_add(&g_capture.writers, 1);
+    /* Dropped if the capture stopped, or was restarted, during the call */
+    if (!atomic_load(&native_capture_running) ||
+        atomic_load_explicit(&record->sequence, memory_order_relaxed) != g_capture.generation) {
+        atomic_fetch_sub(&g_capture.writers, 1);
+        return;
+    }
+
+    uint64_t elapsed = now - g_capture.start_ns - record->time_ns;
+    record->duration_ns = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+
+    uint64_t claim = atomic_fetch_add_explicit(&g_capture.header->next, 1, memory_order_relaxed);
+    uint64_t sequence = claim + 1;
+    NativeCaptureRecord* slot = &g_capture.records[claim & g_capture.mask];
+
+    /* Take the slot unless another writer is copying into it or it already
+     * holds a newer record (only after `capacity` claims during this copy) */
+    uint64_t current = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    if (!(current & NATIVE_CAPTURE_PENDING) && current < sequence &&
+        atomic_compare_exchange_strong_explicit(&slot->sequence, &current, sequence | NATIVE_CAPTURE_PENDING,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        /* Pending until published, so a reader never takes it mid-copy */
+        atomic_thread_fence(memory_order_release);
+        slot->time_ns = record->time_ns;
+        slot->duration_ns = record->duration_ns;
+        slot->op = record->op;
+        slot->thread = record->thread;
+        slot->flags = record->flags;
+        slot->reserved = 0;
+        memcpy(slot->args, record->args, sizeof(slot->args));
+        atomic_store_explicit(&slot->sequence, sequence, memory_order_release);
+    }
+
+    atomic_fetch_sub(&g_capture.writers, 1);
+}
@@ -0,0 +1,209 @@
+/**
+ * Native Call Capture
+ *
+ * Opt-in, sampled recording of production calls and their arguments into
+ * a ring file, replayed offline by tools/replay.c (make replay) to measure
+ * a build against real traffic. Build with -DMUSCLEMAP_NATIVE_CAPTURE
+ * (make NATIVE_CAPTURE=1); otherwise the capture points compile to nothing.
+ *
+ * Capture is off until started, by native_capture_start() or at load time
+ * from the environment:
+ *   MUSCLEMAP_CAPTURE=<path>           ring file; "%p" expands to the pid
+ *   MUSCLEMAP_CAPTURE_SAMPLE=<n>       record 1 call in n per thread (default 100)
+ *   MUSCLEMAP_CAPTURE_RECORDS=<n>      ring size in records (default 65536,
+ *                                      at least NATIVE_CAPTURE_MIN_RECORDS)
+ *
+ * Cost: while stopped, one relaxed load per capture point; while running,
+ * a thread-local countdown, and for sampled calls two clock reads, a
+ * 128-byte record filled on the caller's stack and one copy into the
+ * mapped file.
+ *
+ * File layout: NativeCaptureHeader, then `capacity` NativeCaptureRecords.
+ * A sampled call fills its record on the stack; only when it returns does
+ * it claim a slot from a shared counter (overwriting the oldest once the
+ * ring wraps) and copy the record in, so a call never holds a slot while
+ * it runs. The slot's sequence carries NATIVE_CAPTURE_PENDING during the
+ * copy; a writer that finds the slot pending, or already holding a newer
+ * record, drops its own. Readers take a slot only when its sequence is
+ * the same, and not pending, before and after copying it out.
+ *
+ * Usage in an exported function:
+ *   NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_RANK_FULL_RANKING);
+ *   if (capture) {
+ *       NativeCaptureRank* args = (NativeCaptureRank*)capture->args;
+ *       args->count = count;
+ *   }
+ */
+
+#ifndef MUSCLEMAP_NATIVE_CAPTURE_H
+#define MUSCLEMAP_NATIVE_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define NATIVE_CAPTURE_MAGIC "MMCAPTR"   /* 8 bytes with the NUL */
+#define NATIVE_CAPTURE_VERSION 1
+#define NATIVE_CAPTURE_ARGS_LEN 96
+#define NATIVE_CAPTURE_MIN_RECORDS 1024
+#define NATIVE_CAPTURE_RATELIMIT_USERS 8
+#define NATIVE_CAPTURE_TU_EXERCISES 16
+#define NATIVE_CAPTURE_SOLVE_EXCLUDED 3
+
+typedef enum {
+    NATIVE_CAPTURE_RATELIMIT_CHECK = 1,  /* NativeCaptureRatelimit */
+    NATIVE_CAPTURE_RATELIMIT_CHECK_BATCH,
+    NATIVE_CAPTURE_RANK_FULL_RANKING,    /* NativeCaptureRank */
+    NATIVE_CAPTURE_RANK_SIMPLE_PERCENTILES,
+    NATIVE_CAPTURE_TU_CALCULATE,         /* NativeCaptureTu */
+    NATIVE_CAPTURE_TU_CALCULATE_BATCH,
+    NATIVE_CAPTURE_SOLVE,                /* NativeCaptureSolve */
+    NATIVE_CAPTURE_OP_COUNT
+} NativeCaptureOp;
+
+/* Record flags */
+#define NATIVE_CAPTURE_TRUNCATED 0x1     /* Arrays longer than the record holds, or values saturated */
+#define NATIVE_CAPTURE_CACHE_HIT 0x2     /* Solve answered from the result cache */
+
+/* Sequence bit of a record still being written */
+#define NATIVE_CAPTURE_PENDING (1ull << 63)
+
+typedef struct {
+    char magic[8];                       /* NATIVE_CAPTURE_MAGIC */
+    uint32_t version;                    /* NATIVE_CAPTURE_VERSION */
+    uint32_t record_size;                /* sizeof(NativeCaptureRecord) */
+    uint64_t capacity;                   /* Records in the ring (power of two) */
+    uint32_t sample_every;
+    uint32_t pid;
+    uint64_t start_realtime_ns;          /* Wall clock when the capture started */
+    _Atomic uint64_t next;               /* Records claimed so far */
+    uint8_t reserved[16];
+} NativeCaptureHeader;
+
+typedef struct {
+    _Atomic uint64_t sequence;           /* Claim number + 1 (0 = empty), PENDING while written */
+    uint64_t time_ns;                    /* Call start, since the capture started */
+    uint32_t duration_ns;                /* Call duration (saturating) */
+    uint16_t op;                         /* NativeCaptureOp */
+    uint16_t thread;                     /* Capturing thread, numbered from 0 */
+    uint32_t flags;
+    uint32_t reserved;
+    uint8_t args[NATIVE_CAPTURE_ARGS_LEN] __attribute__((aligned(8)));
+} NativeCaptureRecord;
+
+_Static_assert(sizeof(NativeCaptureHeader) == 64, "capture header layout");
+_Static_assert(sizeof(NativeCaptureRecord) == 128, "capture record layout");
+
+/* ratelimit_check / ratelimit_check_batch */
+typedef struct {
+    uint64_t limiter;                    /* Limiter identity within the capture */
+    uint64_t capacity;                   /* Limiter slots */
+    uint32_t limit;                      /* Requests per window */
+    uint32_t count;                      /* Operations consumed per user */
+    uint64_t users;                      /* Users in the call */
+    uint64_t user_ids[NATIVE_CAPTURE_RATELIMIT_USERS];  /* First users */
+} NativeCaptureRatelimit;
+
+/* rank_full_ranking / rank_simple_percentiles */
+typedef struct {
+    uint64_t count;                      /* Leaderboard size */
+} NativeCaptureRank;
+
+/* tu_calculate / tu_calculate_batch */
+typedef struct {
+    int32_t workouts;                    /* 1 for tu_calculate */
+    int32_t exercises;                   /* Across all workouts */
+    int32_t exercise_index[NATIVE_CAPTURE_TU_EXERCISES];  /* First exercises, in order */
+    uint8_t sets[NATIVE_CAPTURE_TU_EXERCISES];  /* Saturated to 0..255 */
+} NativeCaptureTu;
+
+/* Constraint solver request (solve through the result cache) */
+typedef struct {
+    int32_t time_available_seconds;
+    int32_t equipment_mask;
+    int32_t goals_mask;
+    int32_t excluded_muscles_mask;
+    int32_t recent_24h_muscles_mask;
+    int32_t recent_48h_muscles_mask;
+    int32_t optimize_deadline_us;
+    uint32_t seed;
+    float variety;
+    float weights[6];                    /* ScoringWeights order */
+    int32_t catalog_exercises;           /* Catalog size at capture time */
+    int32_t excluded_count;              /* Exercises excluded by the request */
+    int32_t excluded[NATIVE_CAPTURE_SOLVE_EXCLUDED];  /* First excluded catalog indices */
+    int8_t location;                     /* Small request fields, saturated to int8 */
+    int8_t fitness_level;
+    int8_t max_group_size;
+    int8_t max_antagonist_imbalance;
+    int8_t pattern_quota[7];
+} NativeCaptureSolve;
+
+_Static_assert(sizeof(NativeCaptureRatelimit) <= NATIVE_CAPTURE_ARGS_LEN &&
+               sizeof(NativeCaptureTu) <= NATIVE_CAPTURE_ARGS_LEN &&
+               sizeof(NativeCaptureSolve) <= NATIVE_CAPTURE_ARGS_LEN,
+               "capture arguments must fit a record");
+
+/* Non-zero while a capture is running (checked inline at every capture point) */
+extern _Atomic uint32_t native_capture_running;
+
+/**
+ * Start capturing into a new ring file (replacing any running capture)
+ *
+ * @param path Ring file to create; "%p" expands to the pid
+ * @param sample_every Record 1 call in sample_every per thread (0 = 1)
+ * @param records Ring size in records (at least NATIVE_CAPTURE_MIN_RECORDS),
+ *                rounded up to a power of two
+ * @return 0 on success, -1 on error (including a ring below the minimum)
+ */
+int native_capture_start(const char* path, uint32_t sample_every, uint64_t records);
+
+/**
+ * Stop the running capture, waiting for calls still writing a record
+ * @return Records captured (the ring keeps the latest `capacity`)
+ */
+uint64_t native_capture_stop(void);
+
+/**
+ * Whether the library was built with MUSCLEMAP_NATIVE_CAPTURE
+ */
+int native_capture_enabled(void);
+
+/**
+ * Start a sampled call's record in caller storage
+ * @return record, or NULL if this call is not sampled
+ */
+NativeCaptureRecord* native_capture_begin(NativeCaptureOp op, NativeCaptureRecord* record);
+
+/**
+ * Stamp the duration, then claim a ring slot and copy the record into it
+ */
+void native_capture_end(NativeCaptureRecord* record);
+
+#ifdef MUSCLEMAP_NATIVE_CAPTURE
+
+static inline NativeCaptureRecord* native_capture_point(NativeCaptureOp op, NativeCaptureRecord* record) {
+    if (__builtin_expect(!atomic_load_explicit(&native_capture_running, memory_order_relaxed), 1)) {
+        return NULL;
+    }
+    return native_capture_begin(op, record);
+}
+
+static inline void native_capture_scope_end(NativeCaptureRecord** record) {
+    if (*record) {
+        native_capture_end(*record);
+    }
+}
+
+#define NATIVE_CAPTURE_SCOPE(name, op) \
+    NativeCaptureRecord name##_record; \
+    NativeCaptureRecord* name __attribute__((cleanup(native_capture_scope_end))) = \
+        native_capture_point(op, &name##_record)
+
+#else
+
+#define NATIVE_CAPTURE_SCOPE(name, op) NativeCaptureRecord* const name = NULL
+
+#endif
+
+#endif /* MUSCLEMAP_NATIVE_CAPTURE_H */
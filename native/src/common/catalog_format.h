@@ -0,0 +1,309 @@
+/**
+ * Binary Exercise Catalog
+ *
+ * One versioned file holding everything libtu and the constraint solver
+ * need about the exercise catalog, laid out so both can map it read-only
+ * and use it in place: loading costs one mmap and a header check, and the
+ * pages are shared by every process on the host through the page cache.
+ *
+ * Written by native/tools/build-catalog.js (`make catalog`); this header
+ * is the authoritative description of the layout.
+ *
+ * Layout:
+ * - CatalogFileHeader at offset 0, then one section per CatalogSection,
+ *   each starting on a 64-byte boundary at the offset in the header
+ * - Little-endian; byte_order lets readers reject a foreign file
+ * - Exercises and muscles are addressed by dense index (file order)
+ * - String IDs are fixed CATALOG_ID_LEN slots, NUL padded
+ * - The ID table maps FNV-1a(string id) to dense index + 1 (0 = empty),
+ *   Fibonacci-hashed into a power-of-two table with linear probing. The
+ *   solver's integer exercise ID is the same FNV-1a value, so both
+ *   modules share one table.
+ * - Activations are stored twice: dense rows of CATALOG_MAX_MUSCLES
+ *   percentages (libtu's kernels) and CSR (sparse consumers)
+ * - Solver columns (difficulty, masks, candidate bitsets) are precomputed
+ *   over the first mask_muscles muscles
+ *
+ * Compatibility: readers reject any version other than
+ * CATALOG_FORMAT_VERSION. Bump it on every layout change; sections are
+ * only ever appended.
+ */
+
+#ifndef MUSCLEMAP_CATALOG_FORMAT_H
+#define MUSCLEMAP_CATALOG_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CATALOG_MAGIC "MMCATLG"          /* 8 bytes with the NUL */
+#define CATALOG_FORMAT_VERSION 1
+#define CATALOG_BYTE_ORDER 0x01020304u
+#define CATALOG_ALIGN 64
+#define CATALOG_ID_LEN 64                /* String ID slot, NUL included */
+#define CATALOG_MAX_MUSCLES 64           /* Dense activation row width */
+#define CATALOG_MAX_EXERCISES (1 << 20)
+#define CATALOG_BITSET_ROWS 32           /* Locations / equipment items, one per mask bit */
+
+typedef enum {
+    CATALOG_SECTION_EXERCISE_IDS,        /* char[exercises][CATALOG_ID_LEN] */
+    CATALOG_SECTION_ID_TABLE,            /* int32[id_table_size]: dense index + 1, 0 = empty */
+    CATALOG_SECTION_EXERCISES,           /* CatalogExercise[exercises] */
+    CATALOG_SECTION_DIFFICULTY,          /* int32[exercises]: 1-5 */
+    CATALOG_SECTION_MOVEMENT_PATTERN,    /* int32[exercises]: push=0 ... isolation=6 */
+    CATALOG_SECTION_IS_COMPOUND,         /* int32[exercises]: 0 or 1 */
+    CATALOG_SECTION_EXCLUSION_MASK,      /* int32[exercises]: primary plus activated > 40% */
+    CATALOG_SECTION_ACTIVE_MASK,         /* uint64[exercises]: any activation */
+    CATALOG_SECTION_WORKED_MASK,         /* uint64[exercises]: primary plus activated > 40% */
+    CATALOG_SECTION_LOCATION_BITS,       /* uint64[32][bitset_words]: bit i = exercise i valid there */
+    CATALOG_SECTION_EQUIPMENT_BITS,      /* uint64[32][bitset_words]: bit i = exercise i needs it */
+    CATALOG_SECTION_ACTIVATIONS,         /* float[exercises][CATALOG_MAX_MUSCLES]: percent 0-100 */
+    CATALOG_SECTION_ACTIVATION_SPAN,     /* uint32[exercises]: last activated muscle + 1 */
+    CATALOG_SECTION_CSR_OFFSETS,         /* uint32[exercises + 1] into the CSR arrays */
+    CATALOG_SECTION_CSR_MUSCLES,         /* uint16[activation_nnz] */
+    CATALOG_SECTION_CSR_VALUES,          /* float[activation_nnz] */
+    CATALOG_SECTION_MUSCLE_IDS,          /* char[muscles][CATALOG_ID_LEN] */
+    CATALOG_SECTION_MUSCLE_BIAS,         /* float[muscles]: TU bias weight */
+    CATALOG_SECTION_MUSCLE_RECOVERY,     /* int32[muscles]: recovery window in hours */
+    CATALOG_SECTION_COUNT
+} CatalogSection;
+
+typedef struct {
+    char magic[8];                       /* CATALOG_MAGIC */
+    uint32_t version;                    /* CATALOG_FORMAT_VERSION */
+    uint32_t byte_order;                 /* CATALOG_BYTE_ORDER as written */
+    uint64_t file_size;
+    uint32_t exercise_count;
+    uint32_t muscle_count;               /* <= CATALOG_MAX_MUSCLES */
+    uint32_t mask_muscles;               /* Muscles covered by the mask columns */
+    uint32_t activation_nnz;             /* Non-zero activations (CSR length) */
+    uint32_t id_table_size;              /* Power of two >= 2 * exercise_count, >= 64 */
+    uint32_t bitset_words;               /* (exercise_count + 63) / 64 */
+    int32_t equipment_used_mask;         /* Union of equipment_required_mask */
+    uint32_t reserved;
+    uint64_t sections[CATALOG_SECTION_COUNT];  /* Byte offsets from the start of the file */
+} CatalogFileHeader;
+
+_Static_assert(sizeof(CatalogFileHeader) == 56 + 8 * CATALOG_SECTION_COUNT, "catalog header layout");
+
+/* Per-exercise fields outside the scoring columns (the solver's Exercise) */
+typedef struct {
+    int32_t id;                          /* FNV-1a of the string ID */
+    int32_t estimated_seconds;
+    int32_t rest_seconds;
+    int32_t primary_muscles_mask;
+    int32_t locations_mask;
+    int32_t equipment_required_mask;
+} CatalogExercise;
+
+/* A mapped, validated catalog file */
+typedef struct {
+    const CatalogFileHeader* header;     /* NULL when not open */
+    size_t size;
+} CatalogFile;
+
+/* catalog_file_open() errors */
+enum {
+    CATALOG_ERR_OPEN = -1,               /* errno has the reason */
+    CATALOG_ERR_FORMAT = -2,             /* Not a catalog, or truncated */
+    CATALOG_ERR_VERSION = -3,            /* Other format version, byte order or mask width */
+    CATALOG_ERR_CORRUPT = -4             /* Counts, sections or ID table inconsistent */
+};
+
+/**
+ * FNV-1a of a NUL-terminated string (the catalog's ID hash)
+ */
+static inline uint32_t catalog_id_hash(const char* id) {
+    uint32_t hash = 0x811c9dc5u;
+    for (const unsigned char* p = (const unsigned char*)id; *p; p++) {
+        hash = (hash ^ *p) * 0x01000193u;
+    }
+    return hash;
+}
+
+/**
+ * ID table slot for an ID hash (table_bits = log2 of the table size)
+ */
+static inline uint32_t catalog_id_slot(uint32_t hash, uint32_t table_bits) {
+    return (hash * 0x9E3779B1u) >> (32 - table_bits);
+}
+
+static inline uint32_t catalog_table_bits(uint32_t table_size) {
+    return (uint32_t)__builtin_ctz(table_size);
+}
+
+/**
+ * Size in bytes of a section, from the header counts
+ */
+static inline uint64_t catalog_section_size(const CatalogFileHeader* h, CatalogSection section) {
+    uint64_t exercises = h->exercise_count;
+    uint64_t muscles = h->muscle_count;
+    switch (section) {
+        case CATALOG_SECTION_EXERCISE_IDS: return exercises * CATALOG_ID_LEN;
+        case CATALOG_SECTION_ID_TABLE: return (uint64_t)h->id_table_size * sizeof(int32_t);
+        case CATALOG_SECTION_EXERCISES: return exercises * sizeof(CatalogExercise);
+        case CATALOG_SECTION_DIFFICULTY:
+        case CATALOG_SECTION_MOVEMENT_PATTERN:
+        case CATALOG_SECTION_IS_COMPOUND:
+        case CATALOG_SECTION_EXCLUSION_MASK: return exercises * sizeof(int32_t);
+        case CATALOG_SECTION_ACTIVE_MASK:
+        case CATALOG_SECTION_WORKED_MASK: return exercises * sizeof(uint64_t);
+        case CATALOG_SECTION_LOCATION_BITS:
+        case CATALOG_SECTION_EQUIPMENT_BITS:
+            return (uint64_t)CATALOG_BITSET_ROWS * h->bitset_words * sizeof(uint64_t);
+        case CATALOG_SECTION_ACTIVATIONS: return exercises * CATALOG_MAX_MUSCLES * sizeof(float);
+        case CATALOG_SECTION_ACTIVATION_SPAN: return exercises * sizeof(uint32_t);
+        case CATALOG_SECTION_CSR_OFFSETS: return (exercises + 1) * sizeof(uint32_t);
+        case CATALOG_SECTION_CSR_MUSCLES: return (uint64_t)h->activation_nnz * sizeof(uint16_t);
+        case CATALOG_SECTION_CSR_VALUES: return (uint64_t)h->activation_nnz * sizeof(float);
+        case CATALOG_SECTION_MUSCLE_IDS: return muscles * CATALOG_ID_LEN;
+        case CATALOG_SECTION_MUSCLE_BIAS: return muscles * sizeof(float);
+        case CATALOG_SECTION_MUSCLE_RECOVERY: return muscles * sizeof(int32_t);
+        default: return 0;
+    }
+}
+
+/**
+ * Start of a section in an open catalog
+ */
+static inline const void* catalog_section(const CatalogFile* file, CatalogSection section) {
+    return (const uint8_t*)file->header + file->header->sections[section];
+}
+
+/**
+ * Check the header and every section against the mapped size
+ * The ID table is walked once so lookups can trust its entries.
+ * @return 0, or a CATALOG_ERR_* code
+ */
+static inline int catalog_file_validate(const CatalogFile* file) {
+    const CatalogFileHeader* h = file->header;
+    if (file->size < sizeof(CatalogFileHeader) || memcmp(h->magic, CATALOG_MAGIC, sizeof(h->magic)) != 0) {
+        return CATALOG_ERR_FORMAT;
+    }
+    if (h->version != CATALOG_FORMAT_VERSION || h->byte_order != CATALOG_BYTE_ORDER) {
+        return CATALOG_ERR_VERSION;
+    }
+    if (h->file_size != file->size) {
+        return CATALOG_ERR_FORMAT;
+    }
+
+    uint32_t table = h->id_table_size;
+    if (h->exercise_count > CATALOG_MAX_EXERCISES || h->muscle_count > CATALOG_MAX_MUSCLES ||
+        h->mask_muscles > CATALOG_MAX_MUSCLES || h->bitset_words != (h->exercise_count + 63) / 64 ||
+        table < 64 || (table & (table - 1)) != 0 || table < 2 * h->exercise_count ||
+        h->activation_nnz > h->exercise_count * (uint64_t)CATALOG_MAX_MUSCLES) {
+        return CATALOG_ERR_CORRUPT;
+    }
+
+    for (int s = 0; s < CATALOG_SECTION_COUNT; s++) {
+        uint64_t offset = h->sections[s];
+        if (offset % CATALOG_ALIGN != 0 || offset < sizeof(CatalogFileHeader) || offset > file->size ||
+            catalog_section_size(h, (CatalogSection)s) > file->size - offset) {
+            return CATALOG_ERR_CORRUPT;
+        }
+    }
+
+    const uint32_t* csr = catalog_section(file, CATALOG_SECTION_CSR_OFFSETS);
+    if (csr[0] != 0 || csr[h->exercise_count] != h->activation_nnz) {
+        return CATALOG_ERR_CORRUPT;
+    }
+
+    const int32_t* slots = catalog_section(file, CATALOG_SECTION_ID_TABLE);
+    uint32_t filled = 0;
+    for (uint32_t s = 0; s < table; s++) {
+        if (slots[s] < 0 || (uint32_t)slots[s] > h->exercise_count) {
+            return CATALOG_ERR_CORRUPT;
+        }
+        filled += slots[s] != 0;
+    }
+    return filled == h->exercise_count ? 0 : CATALOG_ERR_CORRUPT;
+}
+
+/**
+ * Map a catalog file read-only and validate it
+ * @return 0, or a CATALOG_ERR_* code (file left closed)
+ */
+static inline int catalog_file_open(const char* path, CatalogFile* file) {
+    file->header = NULL;
+    file->size = 0;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return CATALOG_ERR_OPEN;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return CATALOG_ERR_OPEN;
+    }
+    if ((size_t)st.st_size < sizeof(CatalogFileHeader)) {
+        close(fd);
+        return CATALOG_ERR_FORMAT;
+    }
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return CATALOG_ERR_OPEN;
+    }
+
+    CatalogFile mapped = {base, (size_t)st.st_size};
+    int rc = catalog_file_validate(&mapped);
+    if (rc != 0) {
+        munmap(base, mapped.size);
+        return rc;
+    }
+
+    *file = mapped;
+    return 0;
+}
+
+/**
+ * Unmap a catalog (no-op when not open)
+ */
+static inline void catalog_file_close(CatalogFile* file) {
+    if (file->header) {
+        munmap((void*)file->header, file->size);
+    }
+    file->header = NULL;
+    file->size = 0;
+}
+
+/**
+ * Dense index of the first exercise with the given string ID, or -1
+ */
+static inline int32_t catalog_find_exercise(const CatalogFile* file, const char* id) {
+    const CatalogFileHeader* h = file->header;
+    const int32_t* table = catalog_section(file, CATALOG_SECTION_ID_TABLE);
+    const char* ids = catalog_section(file, CATALOG_SECTION_EXERCISE_IDS);
+    uint32_t mask = h->id_table_size - 1;
+
+    for (uint32_t slot = catalog_id_slot(catalog_id_hash(id), catalog_table_bits(h->id_table_size));
+         table[slot] != 0; slot = (slot + 1) & mask) {
+        int32_t idx = table[slot] - 1;
+        if (strncmp(ids + (size_t)idx * CATALOG_ID_LEN, id, CATALOG_ID_LEN) == 0) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Message for a catalog_file_open() error
+ */
+static inline const char* catalog_error_string(int error) {
+    switch (error) {
+        case CATALOG_ERR_OPEN: return "cannot open or map catalog file";
+        case CATALOG_ERR_FORMAT: return "not a catalog file, or truncated";
+        case CATALOG_ERR_VERSION: return "catalog format version, byte order or layout not supported";
+        case CATALOG_ERR_CORRUPT: return "catalog file is corrupt";
+        default: return "unknown catalog error";
+    }
+}
+
+#endif /* MUSCLEMAP_CATALOG_FORMAT_H */
@@ -0,0 +1,89 @@
+/**
+ * Runtime CPU feature dispatch
+ *
+ * Release builds target the baseline ISA (SSE2 on x86-64) so one artifact
+ * runs on every host. Hot kernels are compiled once per ISA below and the
+ * widest one the CPU supports is picked at load time.
+ *
+ * Set MUSCLEMAP_NATIVE_ISA=baseline|avx2|avx512 to force a narrower
+ * variant (e.g. to test the fallback path). Requests for an ISA the CPU
+ * lacks are capped at the widest supported one.
+ *
+ * WebAssembly has no runtime feature detection: the wasm build (make wasm)
+ * compiles with -msimd128, so SIMD128 is the widest and only SIMD level
+ * there and the x86 variants are not built.
+ *
+ * Usage: write the kernel body as a static always-inline function, wrap
+ * it once per ISA with NATIVE_TARGET_AVX2 / NATIVE_TARGET_AVX512, and
+ * pick the wrapper from a constructor via native_isa_select(). libtu and
+ * the solver's static scoring kernel (apps/api/native) both do.
+ */
+
+#ifndef MUSCLEMAP_CPU_DISPATCH_H
+#define MUSCLEMAP_CPU_DISPATCH_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define NATIVE_DISPATCH_X86 1
+#define NATIVE_TARGET_AVX2 __attribute__((target("avx2")))
+#define NATIVE_TARGET_AVX512 __attribute__((target("avx512f,avx512vl,avx2")))
+#else
+#define NATIVE_DISPATCH_X86 0
+#endif
+
+#if defined(__wasm_simd128__)
+#define NATIVE_DISPATCH_WASM_SIMD 1
+#else
+#define NATIVE_DISPATCH_WASM_SIMD 0
+#endif
+
+/* Instruction set levels, narrowest first */
+typedef enum {
+    NATIVE_ISA_BASELINE = 0,
+    NATIVE_ISA_AVX2 = 1,
+    NATIVE_ISA_AVX512 = 2,
+    NATIVE_ISA_SIMD128 = 3               /* WebAssembly builds only */
+} NativeIsa;
+
+static const char* const NATIVE_ISA_NAMES[] = {"baseline", "avx2", "avx512", "simd128"};
+
+/**
+ * Widest ISA supported by this CPU, narrowed by MUSCLEMAP_NATIVE_ISA
+ * Call from a constructor (runs after libc is initialized)
+ */
+static inline NativeIsa native_isa_select(void) {
+    int best = NATIVE_ISA_BASELINE;
+
+#if NATIVE_DISPATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        best = NATIVE_ISA_AVX2;
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) {
+            best = NATIVE_ISA_AVX512;
+        }
+    }
+#elif NATIVE_DISPATCH_WASM_SIMD
+    best = NATIVE_ISA_SIMD128;
+#endif
+
+    const char* forced = getenv("MUSCLEMAP_NATIVE_ISA");
+    if (forced) {
+        if (strcmp(forced, "sse2") == 0) {
+            return NATIVE_ISA_BASELINE;
+        }
+        for (int isa = NATIVE_ISA_BASELINE; isa < best; isa++) {
+            if (NATIVE_DISPATCH_WASM_SIMD && (isa == NATIVE_ISA_AVX2 || isa == NATIVE_ISA_AVX512)) {
+                continue;
+            }
+            if (strcmp(forced, NATIVE_ISA_NAMES[isa]) == 0) {
+                return (NativeIsa)isa;
+            }
+        }
+    }
+
+    return (NativeIsa)best;
+}
+
+#endif /* MUSCLEMAP_CPU_DISPATCH_H */
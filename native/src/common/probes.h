@@ -0,0 +1,109 @@
+/**
+ * USDT Static Tracepoints
+ *
+ * NATIVE_PROBEn(name, args...) marks a point that perf, bpftrace or
+ * SystemTap can attach to at runtime on a live process:
+ *   bpftrace -e 'usdt:./lib/libratelimit.so:musclemap:ratelimit__verdict { @[arg2] = count(); }'
+ *
+ * A probe is a single nop plus an ELF note (.note.stapsdt) recording its
+ * address and where each argument lives, so it costs nothing until a
+ * tracer attaches. Arguments must be integers; pass values the code
+ * already has, since argument expressions are evaluated either way.
+ *
+ * Implementation, first match wins:
+ * - MUSCLEMAP_NO_PROBES defined: probes compile out
+ * - <sys/sdt.h> available (systemtap-sdt-dev): its DTRACE_PROBEn
+ * - GCC/Clang on x86-64 ELF: the same note format emitted below
+ * - otherwise: probes compile out
+ *
+ * Every probe uses the provider "musclemap"; the list lives in
+ * native/test/probes.sh, which also checks the notes are present.
+ */
+
+#ifndef MUSCLEMAP_PROBES_H
+#define MUSCLEMAP_PROBES_H
+
+#if !defined(MUSCLEMAP_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define NATIVE_PROBES_SDT 1
+#elif defined(__x86_64__) && defined(__ELF__) && defined(__GNUC__)
+#define NATIVE_PROBES_BUILTIN 1
+#endif
+#endif
+
+#if defined(NATIVE_PROBES_SDT)
+
+#define NATIVE_PROBES_ENABLED 1
+#define NATIVE_PROBE0(name) DTRACE_PROBE(musclemap, name)
+#define NATIVE_PROBE1(name, a1) DTRACE_PROBE1(musclemap, name, a1)
+#define NATIVE_PROBE2(name, a1, a2) DTRACE_PROBE2(musclemap, name, a1, a2)
+#define NATIVE_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(musclemap, name, a1, a2, a3)
+#define NATIVE_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(musclemap, name, a1, a2, a3, a4)
+
+#elif defined(NATIVE_PROBES_BUILTIN)
+
+/*
+ * Note layout (as <sys/sdt.h>, note type 3 "stapsdt"): probe address,
+ * .stapsdt.base address (lets tools correct for prelink), semaphore (0,
+ * unused), provider, name, then "size@operand" per argument, where size
+ * is negative for signed types.
+ */
+#define NATIVE_PROBES_ENABLED 1
+
+#define NATIVE_PROBE_SIGNED(x) (((__typeof__((x) + 0))-1) < 1)
+#define NATIVE_PROBE_SIZE(x) ((NATIVE_PROBE_SIGNED(x) ? 1 : -1) * (int)sizeof((x) + 0))
+
+/* Operands: %n prints the negated size, then '@' and the argument's location */
+#define NATIVE_PROBE_OP(n, x) [s##n] "n"(NATIVE_PROBE_SIZE(x)), [a##n] "nor"((x) + 0)
+
+#define NATIVE_PROBE_ASM(probe_name, args_template, ...)                    \
+    __asm__ __volatile__(                                                   \
+        "990: nop\n"                                                        \
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n"                       \
+        ".balign 4\n"                                                       \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                  \
+        "991: .asciz \"stapsdt\"\n"                                         \
+        "992: .balign 4\n"                                                  \
+        "993: .8byte 990b\n"                                                \
+        ".8byte _.stapsdt.base\n"                                           \
+        ".8byte 0\n"                                                        \
+        ".asciz \"musclemap\"\n"                                            \
+        ".asciz \"" probe_name "\"\n"                                       \
+        ".asciz \"" args_template "\"\n"                                    \
+        "994: .balign 4\n"                                                  \
+        ".popsection\n"                                                     \
+        ".ifndef _.stapsdt.base\n"                                          \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+        ".weak _.stapsdt.base\n"                                            \
+        ".hidden _.stapsdt.base\n"                                          \
+        "_.stapsdt.base: .space 1\n"                                        \
+        ".size _.stapsdt.base, 1\n"                                         \
+        ".popsection\n"                                                     \
+        ".endif\n"                                                          \
+        :: __VA_ARGS__)
+
+#define NATIVE_PROBE0(name) NATIVE_PROBE_ASM(#name, "", "i"(0))
+#define NATIVE_PROBE1(name, a1) \
+    NATIVE_PROBE_ASM(#name, "%n[s1]@%[a1]", NATIVE_PROBE_OP(1, a1))
+#define NATIVE_PROBE2(name, a1, a2) \
+    NATIVE_PROBE_ASM(#name, "%n[s1]@%[a1] %n[s2]@%[a2]", NATIVE_PROBE_OP(1, a1), NATIVE_PROBE_OP(2, a2))
+#define NATIVE_PROBE3(name, a1, a2, a3)                                             \
+    NATIVE_PROBE_ASM(#name, "%n[s1]@%[a1] %n[s2]@%[a2] %n[s3]@%[a3]", NATIVE_PROBE_OP(1, a1), \
+                     NATIVE_PROBE_OP(2, a2), NATIVE_PROBE_OP(3, a3))
+#define NATIVE_PROBE4(name, a1, a2, a3, a4)                                                       \
+    NATIVE_PROBE_ASM(#name, "%n[s1]@%[a1] %n[s2]@%[a2] %n[s3]@%[a3] %n[s4]@%[a4]", NATIVE_PROBE_OP(1, a1), \
+                     NATIVE_PROBE_OP(2, a2), NATIVE_PROBE_OP(3, a3), NATIVE_PROBE_OP(4, a4))
+
+#else
+
+#define NATIVE_PROBES_ENABLED 0
+#define NATIVE_PROBE0(name) ((void)0)
+#define NATIVE_PROBE1(name, a1) ((void)0)
+#define NATIVE_PROBE2(name, a1, a2) ((void)0)
+#define NATIVE_PROBE3(name, a1, a2, a3) ((void)0)
+#define NATIVE_PROBE4(name, a1, a2, a3, a4) ((void)0)
+
+#endif
+
+#endif /* MUSCLEMAP_PROBES_H */
@@ -1,13 +1,14 @@
 /**
  * High-performance Geohash Implementation
  *
- * Compile: gcc -O3 -march=native -fPIC -shared -o libgeo.so geohash.c -lm
+ * Compile: gcc -O3 -fPIC -shared -o libgeo.so geohash.c -lm
  *
  * Features:
  * - Encode lat/lng to geohash string
  * - Decode geohash to lat/lng
  * - Find neighboring geohashes
- * - Haversine distance calculation
+ * - Haversine distance calculation (batches two points per step in f64x2
+ *   lanes in the WebAssembly build)
  */
 
 #include <stdint.h>
@@ -15,6 +16,13 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+#include "geohash.h"
+#include "../workpool/workpool.h"
+#include "../stats/native_stats.h"
 
 #ifdef _WIN32
 #define EXPORT __declspec(dllexport)
@@ -60,6 +68,7 @@ static const int8_t DECODE[128] = {
 EXPORT
 __attribute__((hot, nonnull))
 int geohash_encode(double lat, double lng, int precision, char* restrict out) {
+    NATIVE_STATS_SCOPE();
     /* Validate and clamp precision */
     if (precision < 1) precision = 1;
     if (precision > 12) precision = 12;
@@ -112,6 +121,7 @@ int geohash_encode(double lat, double lng, int precision, char* restrict out) {
 EXPORT
 __attribute__((hot, nonnull))
 int geohash_decode(const char* restrict hash, double* restrict lat, double* restrict lng) {
+    NATIVE_STATS_SCOPE();
     if (!hash || !lat || !lng) {
         return -1;
     }
@@ -162,6 +172,7 @@ int geohash_decode(const char* restrict hash, double* restrict lat, double* rest
  */
 EXPORT
 int geohash_precision_error(int precision, double* lat_err, double* lng_err) {
+    NATIVE_STATS_SCOPE();
     if (precision < 1 || precision > 12 || !lat_err || !lng_err) {
         return -1;
     }
@@ -183,6 +194,7 @@ int geohash_precision_error(int precision, double* lat_err, double* lng_err) {
 EXPORT
 __attribute__((nonnull))
 int geohash_neighbors(const char* restrict hash, char neighbors[8][13]) {
+    NATIVE_STATS_SCOPE();
     if (!hash || !neighbors) {
         return -1;
     }
@@ -242,8 +254,13 @@ int geohash_neighbors(const char* restrict hash, char neighbors[8][13]) {
  * @return Distance in meters
  */
 EXPORT
+#ifdef MUSCLEMAP_NATIVE_STATS
+__attribute__((hot))        /* Not const: the stats scope records every call */
+#else
 __attribute__((hot, const))
+#endif
 double haversine_meters(double lat1, double lng1, double lat2, double lng2) {
+    NATIVE_STATS_SCOPE();
     static const double R = 6371000.0;  /* Earth's radius in meters */
     static const double DEG2RAD = 0.017453292519943295;  /* PI / 180 */
 
@@ -260,6 +277,108 @@ double haversine_meters(double lat1, double lng1, double lat2, double lng2) {
     return R * 2.0 * atan2(sqrt(a), sqrt(1.0 - a));
 }
 
+/* Points per work-stealing range in haversine_batch (~50 us) */
+#define HAVERSINE_GRAIN 2048
+
+/**
+ * Shared state for a haversine batch
+ */
+typedef struct {
+    double lat;
+    double lng;
+    double cos_phi1;
+    const double* points;
+    double* out;
+} HaversineBatch;
+
+static void haversine_range(void* ctx, size_t begin, size_t end) {
+    static const double R = 6371000.0;
+    static const double DEG2RAD = 0.017453292519943295;
+
+    const HaversineBatch* batch = ctx;
+    const double* restrict points = batch->points;
+    double* restrict out = batch->out;
+    size_t i = begin;
+
+#if defined(__wasm_simd128__)
+    /* Two points per step: subtractions, products and square roots in
+       f64x2 lanes, sin/cos/atan2 per lane, in the scalar loop's order so
+       both paths round identically */
+    const v128_t origin_lat = wasm_f64x2_splat(batch->lat);
+    const v128_t origin_lng = wasm_f64x2_splat(batch->lng);
+    const v128_t cos_phi1 = wasm_f64x2_splat(batch->cos_phi1);
+    const v128_t deg2rad = wasm_f64x2_splat(DEG2RAD);
+    const v128_t half = wasm_f64x2_splat(0.5);
+    const v128_t one = wasm_f64x2_splat(1.0);
+
+    for (; i + 2 <= end; i += 2) {
+        v128_t first = wasm_v128_load(points + 2 * i);
+        v128_t second = wasm_v128_load(points + 2 * i + 2);
+        v128_t lat2 = wasm_i64x2_shuffle(first, second, 0, 2);
+        v128_t lng2 = wasm_i64x2_shuffle(first, second, 1, 3);
+        v128_t half_dphi = wasm_f64x2_mul(wasm_f64x2_mul(wasm_f64x2_sub(lat2, origin_lat), deg2rad), half);
+        v128_t half_dlam = wasm_f64x2_mul(wasm_f64x2_mul(wasm_f64x2_sub(lng2, origin_lng), deg2rad), half);
+        v128_t phi2 = wasm_f64x2_mul(lat2, deg2rad);
+
+        v128_t sin_dphi = wasm_f64x2_make(sin(wasm_f64x2_extract_lane(half_dphi, 0)),
+                                          sin(wasm_f64x2_extract_lane(half_dphi, 1)));
+        v128_t sin_dlam = wasm_f64x2_make(sin(wasm_f64x2_extract_lane(half_dlam, 0)),
+                                          sin(wasm_f64x2_extract_lane(half_dlam, 1)));
+        v128_t cos_phi2 = wasm_f64x2_make(cos(wasm_f64x2_extract_lane(phi2, 0)),
+                                          cos(wasm_f64x2_extract_lane(phi2, 1)));
+
+        v128_t a = wasm_f64x2_add(
+            wasm_f64x2_mul(sin_dphi, sin_dphi),
+            wasm_f64x2_mul(wasm_f64x2_mul(wasm_f64x2_mul(cos_phi1, cos_phi2), sin_dlam), sin_dlam));
+        v128_t y = wasm_f64x2_sqrt(a);
+        v128_t x = wasm_f64x2_sqrt(wasm_f64x2_sub(one, a));
+
+        out[i] = R * 2.0 * atan2(wasm_f64x2_extract_lane(y, 0), wasm_f64x2_extract_lane(x, 0));
+        out[i + 1] = R * 2.0 * atan2(wasm_f64x2_extract_lane(y, 1), wasm_f64x2_extract_lane(x, 1));
+    }
+#endif
+
+    for (; i < end; i++) {
+        double lat2 = points[2 * i];
+        double lng2 = points[2 * i + 1];
+        double dphi = (lat2 - batch->lat) * DEG2RAD;
+        double dlam = (lng2 - batch->lng) * DEG2RAD;
+
+        double sin_dphi = sin(dphi * 0.5);
+        double sin_dlam = sin(dlam * 0.5);
+
+        double a = sin_dphi * sin_dphi + batch->cos_phi1 * cos(lat2 * DEG2RAD) * sin_dlam * sin_dlam;
+        out[i] = R * 2.0 * atan2(sqrt(a), sqrt(1.0 - a));
+    }
+}
+
+/**
+ * Distances from one origin to many points
+ *
+ * Same result as haversine_meters per point, with the origin's terms
+ * computed once. Large batches run on the shared work pool.
+ *
+ * @param lat Origin latitude
+ * @param lng Origin longitude
+ * @param points Interleaved lat/lng pairs (2 * count doubles)
+ * @param count Number of points
+ * @param out Output distances in meters (count doubles)
+ * @return 0 on success, -1 on error
+ */
+EXPORT
+__attribute__((hot))
+int haversine_batch(double lat, double lng, const double* restrict points, size_t count, double* restrict out) {
+    NATIVE_STATS_SCOPE();
+    static const double DEG2RAD = 0.017453292519943295;
+
+    if ((!points || !out) && count > 0) {
+        return -1;
+    }
+
+    HaversineBatch batch = {lat, lng, cos(lat * DEG2RAD), points, out};
+    return workpool_parallel_for(0, count, HAVERSINE_GRAIN, haversine_range, &batch);
+}
+
 /**
  * Check if a point is within a radius of another point
  *
@@ -273,6 +392,7 @@ double haversine_meters(double lat1, double lng1, double lat2, double lng2) {
 EXPORT
 __attribute__((hot))
 int is_within_radius(double lat1, double lng1, double lat2, double lng2, double radius_meters) {
+    NATIVE_STATS_SCOPE();
     return haversine_meters(lat1, lng1, lat2, lng2) <= radius_meters;
 }
 
@@ -294,6 +414,7 @@ int bounding_box(
     double* min_lat, double* max_lat,
     double* min_lng, double* max_lng
 ) {
+    NATIVE_STATS_SCOPE();
     static const double R = 6371000.0;
     static const double DEG2RAD = 0.017453292519943295;
     static const double RAD2DEG = 57.29577951308232;
@@ -321,6 +442,7 @@ int bounding_box(
  */
 EXPORT
 int optimal_precision(double radius_meters) {
+    NATIVE_STATS_SCOPE();
     /* Approximate cell widths in meters for each precision */
     static const double CELL_WIDTHS[] = {
         5009400.0,  /* 1: 5009.4 km */
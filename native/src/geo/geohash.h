@@ -0,0 +1,26 @@
+/**
+ * Geohash and distance functions (libgeo)
+ *
+ * Shared by the ffi-loaded library and the N-API addon.
+ */
+
+#ifndef MUSCLEMAP_GEOHASH_H
+#define MUSCLEMAP_GEOHASH_H
+
+#include <stddef.h>
+
+int geohash_encode(double lat, double lng, int precision, char* out);
+int geohash_decode(const char* hash, double* lat, double* lng);
+int geohash_precision_error(int precision, double* lat_err, double* lng_err);
+int geohash_neighbors(const char* hash, char neighbors[8][13]);
+double haversine_meters(double lat1, double lng1, double lat2, double lng2);
+int haversine_batch(double lat, double lng, const double* points, size_t count, double* out);
+int is_within_radius(double lat1, double lng1, double lat2, double lng2, double radius_meters);
+int bounding_box(
+    double lat, double lng, double radius_meters,
+    double* min_lat, double* max_lat,
+    double* min_lng, double* max_lng
+);
+int optimal_precision(double radius_meters);
+
+#endif /* MUSCLEMAP_GEOHASH_H */
@@ -1,7 +1,7 @@
 /**
  * High-performance Leaderboard Ranking Calculator
  *
- * Compile: gcc -O3 -march=native -fPIC -shared -o librank.so rank_calculator.c -lm
+ * Compile: gcc -O3 -fPIC -shared -o librank.so rank_calculator.c -lm
  *
  * Features:
  * - Fast in-place sorting using introsort (hybrid quicksort/heapsort)
@@ -17,6 +17,12 @@
 #include <stdlib.h>
 #include <pthread.h>
 
+#include "rank_calculator.h"
+#include "../workpool/workpool.h"
+#include "../stats/native_stats.h"
+#include "../common/probes.h"
+#include "../capture/native_capture.h"
+
 #ifdef _WIN32
 #define EXPORT __declspec(dllexport)
 #else
@@ -25,22 +31,19 @@
 
 /* Maximum entries for batch processing */
 #define MAX_ENTRIES 100000
-#define USER_ID_LEN 64
+
+/* Parallel sort: inputs this large are cut into fixed-size chunks sorted
+ * on the shared work pool, then merged pairwise. Chunking depends only on
+ * the input size, so the order (including ties) is the same for any
+ * thread count. */
+#define PARALLEL_SORT_MIN 16384
+#define SORT_CHUNK 4096
+#define COPY_GRAIN 4096
 
 /* ============================================
  * DATA STRUCTURES
  * ============================================ */
 
-/**
- * User with score for ranking
- */
-typedef struct {
-    char user_id[USER_ID_LEN];
-    double score;
-    int32_t rank;
-    double percentile;
-} RankedUser;
-
 /**
  * Comparison result for sorting
  */
@@ -179,6 +182,103 @@ static void introsort(ScoreIndex* arr, size_t len) {
     introsort_impl(arr, 0, len - 1, calc_depth_limit(len));
 }
 
+/**
+ * Chunks of a parallel sort
+ */
+typedef struct {
+    ScoreIndex* arr;
+    size_t len;
+} ChunkSort;
+
+static void sort_chunk_range(void* ctx, size_t begin, size_t end) {
+    const ChunkSort* sort = ctx;
+    for (size_t c = begin; c < end; c++) {
+        size_t lo = c * SORT_CHUNK;
+        size_t len = sort->len - lo < SORT_CHUNK ? sort->len - lo : SORT_CHUNK;
+        introsort(sort->arr + lo, len);
+    }
+}
+
+/**
+ * One merge pass: runs of `width` merged pairwise from src into dst
+ */
+typedef struct {
+    const ScoreIndex* src;
+    ScoreIndex* dst;
+    size_t len;
+    size_t width;
+} MergePass;
+
+static void merge_pair_range(void* ctx, size_t begin, size_t end) {
+    const MergePass* pass = ctx;
+    const ScoreIndex* src = pass->src;
+
+    for (size_t p = begin; p < end; p++) {
+        size_t lo = p * 2 * pass->width;
+        size_t mid = lo + pass->width < pass->len ? lo + pass->width : pass->len;
+        size_t hi = mid + pass->width < pass->len ? mid + pass->width : pass->len;
+        size_t i = lo, j = mid, k = lo;
+
+        /* Descending; ties keep the left run first */
+        while (i < mid && j < hi) {
+            pass->dst[k++] = src[i].score >= src[j].score ? src[i++] : src[j++];
+        }
+        while (i < mid) pass->dst[k++] = src[i++];
+        while (j < hi) pass->dst[k++] = src[j++];
+    }
+}
+
+/**
+ * Sort descending; large inputs use the shared work pool
+ * @return 0 on success, -1 on allocation failure
+ */
+static int sort_scores(ScoreIndex* arr, size_t len) {
+    if (len < PARALLEL_SORT_MIN) {
+        introsort(arr, len);
+        return 0;
+    }
+
+    ScoreIndex* tmp = malloc(len * sizeof(ScoreIndex));
+    if (!tmp) {
+        return -1;
+    }
+
+    ChunkSort chunks = {arr, len};
+    workpool_parallel_for(0, (len + SORT_CHUNK - 1) / SORT_CHUNK, 1, sort_chunk_range, &chunks);
+
+    ScoreIndex* src = arr;
+    ScoreIndex* dst = tmp;
+    for (size_t width = SORT_CHUNK; width < len; width *= 2) {
+        MergePass pass = {src, dst, len, width};
+        workpool_parallel_for(0, (len + 2 * width - 1) / (2 * width), 1, merge_pair_range, &pass);
+        ScoreIndex* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != arr) {
+        memcpy(arr, src, len * sizeof(ScoreIndex));
+    }
+    free(tmp);
+    return 0;
+}
+
+/**
+ * Gather users into sorted order
+ */
+typedef struct {
+    const RankedUser* users;
+    const ScoreIndex* order;
+    RankedUser* sorted;
+} Permutation;
+
+static void permute_range(void* ctx, size_t begin, size_t end) {
+    const Permutation* perm = ctx;
+    for (size_t i = begin; i < end; i++) {
+        perm->sorted[i] = perm->users[perm->order[i].original_index];
+    }
+}
+
 /* ============================================
  * RANKING FUNCTIONS (HOT PATH)
  * ============================================ */
@@ -191,13 +291,17 @@ static void introsort(ScoreIndex* arr, size_t len) {
  * @return 0 on success, -1 on error
  */
 EXPORT int __attribute__((hot)) rank_sort_users(RankedUser* users, size_t count) {
+    NATIVE_STATS_SCOPE();
     if (!users || count == 0 || count > MAX_ENTRIES) {
         return -1;
     }
 
+    NATIVE_PROBE1(rank__sort__start, count);
+
     /* Create index array for sorting */
     ScoreIndex* indices = malloc(count * sizeof(ScoreIndex));
     if (!indices) {
+        NATIVE_PROBE1(rank__sort__end, (size_t)0);
         return -1;
     }
 
@@ -207,24 +311,29 @@ EXPORT int __attribute__((hot)) rank_sort_users(RankedUser* users, size_t count)
     }
 
     /* Sort by score descending */
-    introsort(indices, count);
+    if (sort_scores(indices, count) != 0) {
+        free(indices);
+        NATIVE_PROBE1(rank__sort__end, (size_t)0);
+        return -1;
+    }
 
     /* Create sorted copy */
     RankedUser* sorted = malloc(count * sizeof(RankedUser));
     if (!sorted) {
         free(indices);
+        NATIVE_PROBE1(rank__sort__end, (size_t)0);
         return -1;
     }
 
-    for (size_t i = 0; i < count; i++) {
-        sorted[i] = users[indices[i].original_index];
-    }
+    Permutation perm = {users, indices, sorted};
+    workpool_parallel_for(0, count, COPY_GRAIN, permute_range, &perm);
 
     /* Copy back to original array */
     memcpy(users, sorted, count * sizeof(RankedUser));
 
     free(sorted);
     free(indices);
+    NATIVE_PROBE1(rank__sort__end, count);
     return 0;
 }
 
@@ -239,6 +348,7 @@ EXPORT int __attribute__((hot)) rank_sort_users(RankedUser* users, size_t count)
  * @return 0 on success, -1 on error
  */
 EXPORT int __attribute__((hot)) rank_assign_ranks(RankedUser* users, size_t count) {
+    NATIVE_STATS_SCOPE();
     if (!users || count == 0) {
         return -1;
     }
@@ -269,6 +379,7 @@ EXPORT int __attribute__((hot)) rank_assign_ranks(RankedUser* users, size_t coun
  * @return 0 on success, -1 on error
  */
 EXPORT int __attribute__((hot)) rank_calculate_percentiles(RankedUser* users, size_t count) {
+    NATIVE_STATS_SCOPE();
     if (!users || count == 0) {
         return -1;
     }
@@ -291,6 +402,11 @@ EXPORT int __attribute__((hot)) rank_calculate_percentiles(RankedUser* users, si
  * @return 0 on success, -1 on error
  */
 EXPORT int __attribute__((hot)) rank_full_ranking(RankedUser* users, size_t count) {
+    NATIVE_STATS_SCOPE();
+    NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_RANK_FULL_RANKING);
+    if (capture) {
+        ((NativeCaptureRank*)capture->args)->count = count;
+    }
     if (rank_sort_users(users, count) != 0) {
         return -1;
     }
@@ -316,6 +432,11 @@ EXPORT int rank_simple_percentiles(
     size_t count,
     double* percentiles
 ) {
+    NATIVE_STATS_SCOPE();
+    NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_RANK_SIMPLE_PERCENTILES);
+    if (capture) {
+        ((NativeCaptureRank*)capture->args)->count = count;
+    }
     if (!scores || !percentiles || count == 0 || count > MAX_ENTRIES) {
         return -1;
     }
@@ -332,7 +453,13 @@ EXPORT int rank_simple_percentiles(
     }
 
     /* Sort descending */
-    introsort(indices, count);
+    NATIVE_PROBE1(rank__simple__sort__start, count);
+    if (sort_scores(indices, count) != 0) {
+        free(indices);
+        NATIVE_PROBE1(rank__simple__sort__end, (size_t)0);
+        return -1;
+    }
+    NATIVE_PROBE1(rank__simple__sort__end, count);
 
     /* Calculate percentiles and map back to original positions */
     int32_t current_rank = 1;
@@ -371,6 +498,7 @@ EXPORT int __attribute__((hot)) rank_find_rank(
     size_t count,
     double target_score
 ) {
+    NATIVE_STATS_SCOPE();
     if (!sorted_scores || count == 0) {
         return -1;
     }
@@ -411,6 +539,7 @@ EXPORT int rank_get_top_n(
     size_t top_n,
     RankedUser* output
 ) {
+    NATIVE_STATS_SCOPE();
     if (!users || !output || total_count == 0) {
         return -1;
     }
@@ -421,17 +550,6 @@ EXPORT int rank_get_top_n(
     return (int)copy_count;
 }
 
-/**
- * Get rank statistics
- */
-typedef struct {
-    double min_score;
-    double max_score;
-    double mean_score;
-    double median_score;
-    double std_dev;
-} RankStats;
-
 /**
  * Calculate statistics for ranked users
  *
@@ -445,6 +563,7 @@ EXPORT int rank_calculate_stats(
     size_t count,
     RankStats* stats
 ) {
+    NATIVE_STATS_SCOPE();
     if (!users || !stats || count == 0) {
         return -1;
     }
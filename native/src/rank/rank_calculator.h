@@ -0,0 +1,45 @@
+/**
+ * Leaderboard ranking (librank)
+ *
+ * Shared by the ffi-loaded library and the N-API addon.
+ */
+
+#ifndef MUSCLEMAP_RANK_CALCULATOR_H
+#define MUSCLEMAP_RANK_CALCULATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define USER_ID_LEN 64
+
+/**
+ * User with score for ranking
+ */
+typedef struct {
+    char user_id[USER_ID_LEN];
+    double score;
+    int32_t rank;
+    double percentile;
+} RankedUser;
+
+/**
+ * Get rank statistics
+ */
+typedef struct {
+    double min_score;
+    double max_score;
+    double mean_score;
+    double median_score;
+    double std_dev;
+} RankStats;
+
+int rank_sort_users(RankedUser* users, size_t count);
+int rank_assign_ranks(RankedUser* users, size_t count);
+int rank_calculate_percentiles(RankedUser* users, size_t count);
+int rank_full_ranking(RankedUser* users, size_t count);
+int rank_simple_percentiles(double* scores, size_t count, double* percentiles);
+int rank_find_rank(const double* sorted_scores, size_t count, double target_score);
+int rank_get_top_n(const RankedUser* users, size_t total_count, size_t top_n, RankedUser* output);
+int rank_calculate_stats(const RankedUser* users, size_t count, RankStats* stats);
+
+#endif /* MUSCLEMAP_RANK_CALCULATOR_H */
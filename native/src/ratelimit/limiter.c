@@ -1,7 +1,7 @@
 /**
  * Lock-free Sliding Window Rate Limiter
  *
- * Compile: gcc -O3 -march=native -fPIC -shared -o libratelimit.so limiter.c -lpthread
+ * Compile: gcc -O3 -fPIC -shared -o libratelimit.so limiter.c -lpthread
  *
  * Features:
  * - Lock-free design using atomic operations
@@ -18,6 +18,11 @@
 #include <pthread.h>
 #include <stdbool.h>
 
+#include "limiter.h"
+#include "../stats/native_stats.h"
+#include "../common/probes.h"
+#include "../capture/native_capture.h"
+
 #ifdef _WIN32
 #define EXPORT __declspec(dllexport)
 #else
@@ -41,12 +46,12 @@ typedef struct {
 /**
  * Rate limiter instance
  */
-typedef struct {
+struct RateLimiter {
     Slot* slots;
     size_t capacity;
     uint32_t limit;
     pthread_rwlock_t lock;
-} RateLimiter;
+};
 
 /**
  * Hash function for user IDs (SplitMix64)
@@ -78,6 +83,7 @@ static inline uint64_t now_ms(void) {
  */
 EXPORT
 RateLimiter* ratelimit_create(size_t capacity, uint32_t limit) {
+    NATIVE_STATS_SCOPE();
     RateLimiter* rl = calloc(1, sizeof(RateLimiter));
     if (!rl) return NULL;
 
@@ -106,6 +112,7 @@ RateLimiter* ratelimit_create(size_t capacity, uint32_t limit) {
  */
 EXPORT
 void ratelimit_destroy(RateLimiter* rl) {
+    NATIVE_STATS_SCOPE();
     if (!rl) return;
     pthread_rwlock_destroy(&rl->lock);
     free(rl->slots);
@@ -113,26 +120,19 @@ void ratelimit_destroy(RateLimiter* rl) {
 }
 
 /**
- * Check and consume rate limit allowance
+ * Check and consume allowance for one user (caller holds rl->lock for reading)
  *
- * @param rl Rate limiter instance
- * @param user_id User identifier
- * @param count Number of operations to consume
- * @return 1 if allowed, 0 if rate limited, -1 on error
+ * @return 1 if allowed, 0 if rate limited, -1 if the table is too full
  */
-EXPORT
-int ratelimit_check(RateLimiter* rl, uint64_t user_id, uint32_t count) {
-    if (!rl || count == 0) return -1;
-
-    pthread_rwlock_rdlock(&rl->lock);
-
-    uint64_t ms = now_ms();
+static int check_locked(RateLimiter* rl, uint64_t user_id, uint32_t count, uint64_t ms) {
     int bucket = (ms / 1000) % BUCKETS;
     uint64_t base = hash_user(user_id) % rl->capacity;
     Slot* target = NULL;
+    int probes = 0;
 
     /* Find or create slot for user using linear probing */
     for (int p = 0; p < MAX_PROBES; p++) {
+        probes = p + 1;
         Slot* slot = &rl->slots[(base + p) % rl->capacity];
         uint64_t stored = atomic_load_explicit(&slot->user_id, memory_order_acquire);
 
@@ -156,7 +156,7 @@ int ratelimit_check(RateLimiter* rl, uint64_t user_id, uint32_t count) {
 
     /* No slot available - table is too full */
     if (!target) {
-        pthread_rwlock_unlock(&rl->lock);
+        NATIVE_PROBE4(ratelimit__verdict, user_id, count, -1, probes);
         return -1;
     }
 
@@ -183,10 +183,89 @@ int ratelimit_check(RateLimiter* rl, uint64_t user_id, uint32_t count) {
         atomic_fetch_add_explicit(&target->counts[bucket], count, memory_order_acq_rel);
     }
 
+    NATIVE_PROBE4(ratelimit__verdict, user_id, count, result, probes);
+    return result;
+}
+
+/**
+ * Fill a capture record for ratelimit_check / ratelimit_check_batch
+ */
+static void capture_check(NativeCaptureRecord* capture, RateLimiter* rl,
+                          const uint64_t* user_ids, size_t n, uint32_t count) {
+    NativeCaptureRatelimit* args = (NativeCaptureRatelimit*)capture->args;
+    args->limiter = (uint64_t)(uintptr_t)rl;
+    args->capacity = rl ? rl->capacity : 0;
+    args->limit = rl ? rl->limit : 0;
+    args->count = count;
+    args->users = n;
+    size_t kept = n < NATIVE_CAPTURE_RATELIMIT_USERS ? n : NATIVE_CAPTURE_RATELIMIT_USERS;
+    if (user_ids) {
+        memcpy(args->user_ids, user_ids, kept * sizeof(uint64_t));
+    }
+    if (kept < n) {
+        capture->flags |= NATIVE_CAPTURE_TRUNCATED;
+    }
+}
+
+/**
+ * Check and consume rate limit allowance
+ *
+ * @param rl Rate limiter instance
+ * @param user_id User identifier
+ * @param count Number of operations to consume
+ * @return 1 if allowed, 0 if rate limited, -1 on error
+ */
+EXPORT
+int ratelimit_check(RateLimiter* rl, uint64_t user_id, uint32_t count) {
+    NATIVE_STATS_SCOPE();
+    NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_RATELIMIT_CHECK);
+    if (capture) {
+        capture_check(capture, rl, &user_id, 1, count);
+    }
+    if (!rl || count == 0) return -1;
+
+    pthread_rwlock_rdlock(&rl->lock);
+    int result = check_locked(rl, user_id, count, now_ms());
     pthread_rwlock_unlock(&rl->lock);
     return result;
 }
 
+/**
+ * Check and consume allowance for many users in one call
+ *
+ * Equivalent to ratelimit_check per user, sharing one lock acquisition
+ * and one clock read across the batch.
+ *
+ * @param rl Rate limiter instance
+ * @param user_ids User identifiers
+ * @param n Number of users
+ * @param count Number of operations to consume per user
+ * @param verdicts Output per user: 1 allowed, 0 rate limited, -1 table full
+ * @return Number of allowed users, or -1 on error
+ */
+EXPORT
+int ratelimit_check_batch(RateLimiter* rl, const uint64_t* user_ids, size_t n, uint32_t count, int8_t* verdicts) {
+    NATIVE_STATS_SCOPE();
+    NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_RATELIMIT_CHECK_BATCH);
+    if (capture) {
+        capture_check(capture, rl, user_ids, n, count);
+    }
+    if (!rl || count == 0 || ((!user_ids || !verdicts) && n > 0)) return -1;
+
+    pthread_rwlock_rdlock(&rl->lock);
+
+    uint64_t ms = now_ms();
+    int allowed = 0;
+    for (size_t i = 0; i < n; i++) {
+        int result = check_locked(rl, user_ids[i], count, ms);
+        verdicts[i] = (int8_t)result;
+        allowed += result == 1;
+    }
+
+    pthread_rwlock_unlock(&rl->lock);
+    return allowed;
+}
+
 /**
  * Get remaining allowance for a user
  *
@@ -196,6 +275,7 @@ int ratelimit_check(RateLimiter* rl, uint64_t user_id, uint32_t count) {
  */
 EXPORT
 int ratelimit_remaining(RateLimiter* rl, uint64_t user_id) {
+    NATIVE_STATS_SCOPE();
     if (!rl) return -1;
 
     pthread_rwlock_rdlock(&rl->lock);
@@ -239,6 +319,7 @@ int ratelimit_remaining(RateLimiter* rl, uint64_t user_id) {
  */
 EXPORT
 uint64_t ratelimit_reset_ms(RateLimiter* rl, uint64_t user_id) {
+    NATIVE_STATS_SCOPE();
     if (!rl) return 0;
 
     pthread_rwlock_rdlock(&rl->lock);
@@ -289,6 +370,7 @@ uint64_t ratelimit_reset_ms(RateLimiter* rl, uint64_t user_id) {
  */
 EXPORT
 int ratelimit_reset_user(RateLimiter* rl, uint64_t user_id) {
+    NATIVE_STATS_SCOPE();
     if (!rl) return -1;
 
     pthread_rwlock_wrlock(&rl->lock);
@@ -323,6 +405,7 @@ int ratelimit_reset_user(RateLimiter* rl, uint64_t user_id) {
  */
 EXPORT
 int ratelimit_stats(RateLimiter* rl, size_t* active_users, uint64_t* total_requests) {
+    NATIVE_STATS_SCOPE();
     if (!rl || !active_users || !total_requests) return -1;
 
     pthread_rwlock_rdlock(&rl->lock);
@@ -355,6 +438,7 @@ int ratelimit_stats(RateLimiter* rl, size_t* active_users, uint64_t* total_reque
  */
 EXPORT
 int ratelimit_clear_all(RateLimiter* rl) {
+    NATIVE_STATS_SCOPE();
     if (!rl) return -1;
 
     pthread_rwlock_wrlock(&rl->lock);
@@ -0,0 +1,25 @@
+/**
+ * Sliding window rate limiter (libratelimit)
+ *
+ * Shared by the ffi-loaded library and the N-API addon.
+ */
+
+#ifndef MUSCLEMAP_LIMITER_H
+#define MUSCLEMAP_LIMITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct RateLimiter RateLimiter;
+
+RateLimiter* ratelimit_create(size_t capacity, uint32_t limit);
+void ratelimit_destroy(RateLimiter* rl);
+int ratelimit_check(RateLimiter* rl, uint64_t user_id, uint32_t count);
+int ratelimit_check_batch(RateLimiter* rl, const uint64_t* user_ids, size_t n, uint32_t count, int8_t* verdicts);
+int ratelimit_remaining(RateLimiter* rl, uint64_t user_id);
+uint64_t ratelimit_reset_ms(RateLimiter* rl, uint64_t user_id);
+int ratelimit_reset_user(RateLimiter* rl, uint64_t user_id);
+int ratelimit_stats(RateLimiter* rl, size_t* active_users, uint64_t* total_requests);
+int ratelimit_clear_all(RateLimiter* rl);
+
+#endif /* MUSCLEMAP_LIMITER_H */
@@ -0,0 +1,369 @@
+/**
+ * Native Call Statistics
+ *
+ * Compile: gcc -O3 -fPIC -shared -DMUSCLEMAP_NATIVE_STATS -o libnativestats.so native_stats.c -lpthread
+ *
+ * The per-call record is inline in native_stats.h; this file holds its
+ * slow path, snapshots and reset.
+ *
+ * Features:
+ * - Per-thread buffers written only by their owner (relaxed atomics, so
+ *   snapshots from other threads are race-free)
+ * - Log-linear histograms: exact below 16 ticks, then 8 sub-buckets per
+ *   power of two up to 2^40 ticks
+ * - Rows allocated per site a thread calls (2.5 KB each), so a thread
+ *   calling a few functions holds a few rows rather than one per site
+ * - Reset by epoch: threads zero their own rows on their next call
+ * - Exiting threads fold their counts into a shared retired block
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "native_stats.h"
+
+#ifdef _WIN32
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT __attribute__((visibility("default")))
+#endif
+
+/* Configuration constants */
+#define MIN_CALIBRATION_NS 10000000ull
+
+/* ============================================
+ * DATA STRUCTURES
+ * ============================================ */
+
+/**
+ * Process-wide registry
+ */
+static struct {
+    pthread_mutex_t lock;       /* sites, thread list, retired, epoch, calibration */
+    NativeStatsSite* sites[NATIVE_STATS_MAX_SITES];
+    _Atomic int32_t site_count;
+    NativeStatsThread* threads; /* Live thread buffers */
+    NativeStatsRow retired[NATIVE_STATS_MAX_SITES]; /* Folded from exited threads */
+    uint64_t start_ticks;       /* Calibration origin */
+    uint64_t start_ns;
+    double ns_per_tick;
+} g_stats = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .ns_per_tick = 1.0,
+};
+
+static pthread_key_t g_thread_key;
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+
+/* Read inline by native_stats_record() (see native_stats.h) */
+EXPORT uint64_t native_stats_epoch;
+EXPORT _Thread_local NativeStatsThread* native_stats_thread __attribute__((tls_model("initial-exec")));
+
+/* ============================================
+ * HELPERS
+ * ============================================ */
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+__attribute__((constructor))
+static void stats_calibration_start(void) {
+    g_stats.start_ticks = native_stats_now();
+    g_stats.start_ns = monotonic_ns();
+}
+
+static inline uint64_t load(const uint64_t* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/**
+ * Exclusive upper bound of a bucket, in ticks
+ */
+static uint64_t bucket_upper_ticks(int32_t bucket) {
+    if (bucket < NATIVE_STATS_LINEAR_BUCKETS) {
+        return (uint64_t)bucket + 1;
+    }
+    int32_t exponent = 4 + ((bucket - NATIVE_STATS_LINEAR_BUCKETS) >> NATIVE_STATS_SUB_BUCKET_BITS);
+    uint64_t sub = (uint64_t)((bucket - NATIVE_STATS_LINEAR_BUCKETS) & ((1 << NATIVE_STATS_SUB_BUCKET_BITS) - 1));
+    uint64_t width = 1ull << (exponent - NATIVE_STATS_SUB_BUCKET_BITS);
+    return ((1ull << NATIVE_STATS_SUB_BUCKET_BITS) + sub) * width + width;
+}
+
+/* ============================================
+ * THREAD BUFFERS
+ * ============================================ */
+
+static void clear_row(NativeStatsRow* row) {
+    __atomic_store_n(&row->ticks, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&row->max_ticks, 0, __ATOMIC_RELAXED);
+    for (int32_t b = 0; b < NATIVE_STATS_BUCKETS; b++) {
+        __atomic_store_n(&row->buckets[b], 0, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Zero a thread's rows for a new epoch (owner only)
+ */
+static void clear_thread(NativeStatsThread* ts, uint64_t epoch) {
+    for (int32_t s = 0; s < NATIVE_STATS_MAX_SITES; s++) {
+        if (ts->rows[s]) {
+            clear_row(ts->rows[s]);
+        }
+    }
+    __atomic_store_n(&ts->epoch, epoch, __ATOMIC_RELEASE);
+}
+
+/**
+ * Thread exit: fold counts of the current epoch into the retired block
+ */
+static void detach_thread(void* arg) {
+    NativeStatsThread* ts = arg;
+
+    pthread_mutex_lock(&g_stats.lock);
+    NativeStatsThread** link = &g_stats.threads;
+    while (*link && *link != ts) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = ts->next;
+    }
+
+    bool current = ts->epoch == native_stats_epoch;
+    for (int32_t s = 0; s < NATIVE_STATS_MAX_SITES; s++) {
+        NativeStatsRow* row = ts->rows[s];
+        if (!row) continue;
+        if (current) {
+            NativeStatsRow* r = &g_stats.retired[s];
+            native_stats_bump(&r->ticks, row->ticks);
+            if (row->max_ticks > r->max_ticks) {
+                __atomic_store_n(&r->max_ticks, row->max_ticks, __ATOMIC_RELAXED);
+            }
+            for (int32_t b = 0; b < NATIVE_STATS_BUCKETS; b++) {
+                native_stats_bump(&r->buckets[b], row->buckets[b]);
+            }
+        }
+        free(row);
+    }
+    pthread_mutex_unlock(&g_stats.lock);
+
+    native_stats_thread = NULL;
+    free(ts);
+}
+
+static void create_thread_key(void) {
+    pthread_key_create(&g_thread_key, detach_thread);
+}
+
+static NativeStatsThread* attach_thread(void) {
+    pthread_once(&g_key_once, create_thread_key);
+
+    NativeStatsThread* ts = calloc(1, sizeof(NativeStatsThread));
+    if (!ts) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_stats.lock);
+    ts->epoch = native_stats_epoch;
+    ts->next = g_stats.threads;
+    g_stats.threads = ts;
+    pthread_mutex_unlock(&g_stats.lock);
+
+    pthread_setspecific(g_thread_key, ts);
+    native_stats_thread = ts;
+    return ts;
+}
+
+static int32_t register_site(NativeStatsSite* site) {
+    pthread_mutex_lock(&g_stats.lock);
+    int32_t id = __atomic_load_n(&site->id, __ATOMIC_RELAXED);
+    if (id == 0) {
+        int32_t count = atomic_load(&g_stats.site_count);
+        if (count < NATIVE_STATS_MAX_SITES) {
+            g_stats.sites[count] = site;
+            atomic_store(&g_stats.site_count, count + 1);
+            id = count + 1;
+        } else {
+            id = -1;
+        }
+        __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_stats.lock);
+    return id;
+}
+
+/* ============================================
+ * RECORDING
+ * ============================================ */
+
+EXPORT __attribute__((noinline, cold)) void native_stats_record_slow(NativeStatsSite* site, uint64_t ticks) {
+    int32_t id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if (id == 0) {
+        id = register_site(site);
+    }
+    if (id < 0) {
+        return;
+    }
+
+    NativeStatsThread* ts = native_stats_thread;
+    if (!ts) {
+        ts = attach_thread();
+        if (!ts) return;
+    }
+
+    uint64_t epoch = __atomic_load_n(&native_stats_epoch, __ATOMIC_RELAXED);
+    if (ts->epoch != epoch) {
+        clear_thread(ts, epoch);
+    }
+
+    NativeStatsRow* row = ts->rows[id - 1];
+    if (!row) {
+        row = calloc(1, sizeof(NativeStatsRow));
+        if (!row) return;
+        /* Snapshots load rows with acquire: they see it zeroed */
+        __atomic_store_n(&ts->rows[id - 1], row, __ATOMIC_RELEASE);
+    }
+
+    native_stats_bump(&row->ticks, ticks);
+    if (ticks > row->max_ticks) {
+        __atomic_store_n(&row->max_ticks, ticks, __ATOMIC_RELAXED);
+    }
+    native_stats_bump(&row->buckets[native_stats_bucket(ticks)], 1);
+}
+
+/* ============================================
+ * SNAPSHOT / RESET
+ * ============================================ */
+
+EXPORT int native_stats_enabled(void) {
+#ifdef MUSCLEMAP_NATIVE_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Refresh ticks-to-ns (called with lock held)
+ * Waits out the rest of a short window right after load so the ratio
+ * is never measured over too few ticks.
+ */
+static void calibrate_locked(void) {
+#if NATIVE_STATS_HAS_TSC
+    uint64_t now_ns;
+    while ((now_ns = monotonic_ns()) - g_stats.start_ns < MIN_CALIBRATION_NS) {
+    }
+    uint64_t now_ticks = native_stats_now();
+    if (now_ticks > g_stats.start_ticks) {
+        g_stats.ns_per_tick = (double)(now_ns - g_stats.start_ns) / (double)(now_ticks - g_stats.start_ticks);
+    }
+#endif
+}
+
+static double percentile_ns(const uint64_t* buckets, uint64_t calls, double p, double ns_per_tick) {
+    uint64_t target = (uint64_t)(p * (double)calls + 0.5);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int32_t b = 0; b < NATIVE_STATS_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= target) {
+            return (double)bucket_upper_ticks(b) * ns_per_tick;
+        }
+    }
+    return 0.0;
+}
+
+/**
+ * Add one row into a snapshot entry
+ * Returns the row's max ticks
+ */
+static uint64_t add_row(NativeStatsEntry* entry, uint64_t* ticks, const NativeStatsRow* row) {
+    *ticks += load(&row->ticks);
+    for (int32_t b = 0; b < NATIVE_STATS_BUCKETS; b++) {
+        entry->buckets[b] += load(&row->buckets[b]);
+    }
+    return load(&row->max_ticks);
+}
+
+EXPORT int32_t native_stats_snapshot(NativeStatsEntry* out, int32_t max) {
+    pthread_mutex_lock(&g_stats.lock);
+    calibrate_locked();
+
+    uint64_t epoch = native_stats_epoch;
+    int32_t sites = atomic_load(&g_stats.site_count);
+    int32_t found = 0;
+
+    for (int32_t s = 0; s < sites; s++) {
+        NativeStatsEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        uint64_t ticks = 0;
+        uint64_t max_ticks = add_row(&entry, &ticks, &g_stats.retired[s]);
+
+        for (NativeStatsThread* ts = g_stats.threads; ts; ts = ts->next) {
+            if (__atomic_load_n(&ts->epoch, __ATOMIC_ACQUIRE) != epoch) {
+                continue;
+            }
+            const NativeStatsRow* row = __atomic_load_n(&ts->rows[s], __ATOMIC_ACQUIRE);
+            if (row) {
+                uint64_t thread_max = add_row(&entry, &ticks, row);
+                if (thread_max > max_ticks) max_ticks = thread_max;
+            }
+        }
+
+        /* Calls are the histogram total, read with the buckets */
+        for (int32_t b = 0; b < NATIVE_STATS_BUCKETS; b++) {
+            entry.calls += entry.buckets[b];
+        }
+        if (entry.calls == 0) {
+            continue;
+        }
+
+        double scale = g_stats.ns_per_tick;
+        snprintf(entry.name, sizeof(entry.name), "%s", g_stats.sites[s]->name);
+        entry.total_ns = (double)ticks * scale;
+        entry.mean_ns = entry.total_ns / (double)entry.calls;
+        entry.max_ns = (double)max_ticks * scale;
+        entry.p50_ns = percentile_ns(entry.buckets, entry.calls, 0.50, scale);
+        entry.p90_ns = percentile_ns(entry.buckets, entry.calls, 0.90, scale);
+        entry.p99_ns = percentile_ns(entry.buckets, entry.calls, 0.99, scale);
+        if (entry.p50_ns > entry.max_ns) entry.p50_ns = entry.max_ns;
+        if (entry.p90_ns > entry.max_ns) entry.p90_ns = entry.max_ns;
+        if (entry.p99_ns > entry.max_ns) entry.p99_ns = entry.max_ns;
+
+        if (out && found < max) {
+            out[found] = entry;
+        }
+        found++;
+    }
+
+    pthread_mutex_unlock(&g_stats.lock);
+    return found;
+}
+
+EXPORT double native_stats_bucket_limit(int32_t bucket) {
+    if (bucket < 0 || bucket >= NATIVE_STATS_BUCKETS) {
+        return -1.0;
+    }
+    pthread_mutex_lock(&g_stats.lock);
+    double scale = g_stats.ns_per_tick;
+    pthread_mutex_unlock(&g_stats.lock);
+    return (double)bucket_upper_ticks(bucket) * scale;
+}
+
+EXPORT void native_stats_reset(void) {
+    pthread_mutex_lock(&g_stats.lock);
+    for (int32_t s = 0; s < NATIVE_STATS_MAX_SITES; s++) {
+        clear_row(&g_stats.retired[s]);
+    }
+    __atomic_store_n(&native_stats_epoch, native_stats_epoch + 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_stats.lock);
+}
@@ -0,0 +1,204 @@
+/**
+ * Native Call Statistics
+ *
+ * Opt-in call counts and latency histograms for the exported functions
+ * of every native library. Build with -DMUSCLEMAP_NATIVE_STATS
+ * (make NATIVE_STATS=1) to record; otherwise NATIVE_STATS_SCOPE()
+ * compiles to nothing and the snapshot reports no data.
+ *
+ * Recording is per thread (no shared cache lines on the hot path):
+ * - Durations are taken from the TSC on x86 (clock_gettime elsewhere)
+ *   and converted to nanoseconds at snapshot time
+ * - Histograms are log-linear, HdrHistogram-style: 8 linear sub-buckets
+ *   per power of two, so any bucket is within 12.5% of its values
+ * - The record itself is inline below: a thread-local load, an epoch
+ *   check and three owner-only adds. Registering a site, a thread's
+ *   first call, its first call of a site and the first call after a
+ *   reset go out of line to native_stats_record_slow()
+ * - A thread holds a row per site it has called, not per known site
+ * - Threads that exit fold their counts into a shared block
+ *
+ * Usage in an exported function (records on every return path):
+ *   EXPORT int geohash_encode(...) {
+ *       NATIVE_STATS_SCOPE();
+ *       ...
+ *   }
+ */
+
+#ifndef MUSCLEMAP_NATIVE_STATS_H
+#define MUSCLEMAP_NATIVE_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NATIVE_STATS_HAS_TSC 1
+#else
+#define NATIVE_STATS_HAS_TSC 0
+#endif
+
+#define NATIVE_STATS_MAX_SITES 64
+#define NATIVE_STATS_LINEAR_BUCKETS 16   /* Exact below 16 ticks */
+#define NATIVE_STATS_SUB_BUCKET_BITS 3
+#define NATIVE_STATS_MAX_EXPONENT 40     /* Longer calls share the last bucket */
+#define NATIVE_STATS_BUCKETS 312
+#define NATIVE_STATS_NAME_LEN 48
+
+/* One instrumented function; id is assigned on its first call */
+typedef struct {
+    const char* name;
+    int32_t id;                          /* 0 = unregistered, -1 = table full */
+} NativeStatsSite;
+
+typedef struct {
+    NativeStatsSite* site;
+    uint64_t start;
+} NativeStatsScope;
+
+/* One thread's counts for one site (calls are the bucket total) */
+typedef struct {
+    uint64_t ticks;
+    uint64_t max_ticks;
+    uint64_t buckets[NATIVE_STATS_BUCKETS];
+} NativeStatsRow;
+
+/* Counts of one thread; rows are allocated on the thread's first call of each site */
+typedef struct NativeStatsThread {
+    uint64_t epoch;                      /* Reset epoch the rows belong to */
+    NativeStatsRow* rows[NATIVE_STATS_MAX_SITES];
+    struct NativeStatsThread* next;
+} NativeStatsThread;
+
+/* Per-function totals since the last reset */
+typedef struct {
+    char name[NATIVE_STATS_NAME_LEN];
+    uint64_t calls;
+    double total_ns;
+    double mean_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double max_ns;
+    uint64_t buckets[NATIVE_STATS_BUCKETS];  /* See native_stats_bucket_limit() */
+} NativeStatsEntry;
+
+/**
+ * Current time in timer ticks (TSC cycles, or ns without a TSC)
+ */
+static inline uint64_t native_stats_now(void) {
+#if NATIVE_STATS_HAS_TSC
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * Record a call of `ticks` when the inline path cannot: registers the
+ * site, attaches the thread, clears its rows after a reset or allocates
+ * its row for the site
+ */
+void native_stats_record_slow(NativeStatsSite* site, uint64_t ticks);
+
+/**
+ * Whether the library was built with MUSCLEMAP_NATIVE_STATS
+ */
+int native_stats_enabled(void);
+
+/**
+ * Copy totals of every function called since the last reset
+ *
+ * @param out Entries to fill (may be NULL to count only)
+ * @param max Capacity of out
+ * @return Number of functions with data (may exceed max)
+ */
+int32_t native_stats_snapshot(NativeStatsEntry* out, int32_t max);
+
+/**
+ * Upper bound in nanoseconds of histogram bucket `bucket`
+ * Uses the same timer calibration as the last snapshot.
+ */
+double native_stats_bucket_limit(int32_t bucket);
+
+/**
+ * Zero all counts; threads clear their own buffers on their next call
+ */
+void native_stats_reset(void);
+
+/* Bumped by native_stats_reset(); rows of older epochs are stale */
+extern uint64_t native_stats_epoch;
+
+/* Buffer of the current thread, if it has recorded anything
+ * (initial-exec: one pointer of static TLS, no __tls_get_addr call) */
+extern _Thread_local NativeStatsThread* native_stats_thread __attribute__((tls_model("initial-exec")));
+
+/**
+ * Histogram bucket of a duration in ticks
+ */
+static inline int32_t native_stats_bucket(uint64_t ticks) {
+    if (ticks < NATIVE_STATS_LINEAR_BUCKETS) {
+        return (int32_t)ticks;
+    }
+    int32_t exponent = 63 - __builtin_clzll(ticks);
+    if (exponent > NATIVE_STATS_MAX_EXPONENT) {
+        return NATIVE_STATS_BUCKETS - 1;
+    }
+    int32_t sub = (int32_t)((ticks >> (exponent - NATIVE_STATS_SUB_BUCKET_BITS)) &
+                            ((1 << NATIVE_STATS_SUB_BUCKET_BITS) - 1));
+    return NATIVE_STATS_LINEAR_BUCKETS + ((exponent - 4) << NATIVE_STATS_SUB_BUCKET_BITS) + sub;
+}
+
+/**
+ * Owner-side add; a relaxed store keeps concurrent snapshots race-free
+ */
+static inline void native_stats_bump(uint64_t* counter, uint64_t amount) {
+    __atomic_store_n(counter, *counter + amount, __ATOMIC_RELAXED);
+}
+
+/**
+ * Record one call of site that started at `start`
+ */
+static inline void native_stats_record(NativeStatsSite* site, uint64_t start) {
+    uint64_t ticks = native_stats_now() - start;
+    NativeStatsThread* ts = native_stats_thread;
+    int32_t id = __atomic_load_n(&site->id, __ATOMIC_RELAXED);
+    NativeStatsRow* row = NULL;
+    if (__builtin_expect(ts != NULL && id > 0, 1) &&
+        __builtin_expect(__atomic_load_n(&ts->epoch, __ATOMIC_RELAXED) ==
+                         __atomic_load_n(&native_stats_epoch, __ATOMIC_RELAXED), 1)) {
+        row = ts->rows[id - 1];
+    }
+    if (__builtin_expect(row == NULL, 0)) {
+        native_stats_record_slow(site, ticks);
+        return;
+    }
+
+    native_stats_bump(&row->ticks, ticks);
+    if (ticks > row->max_ticks) {
+        __atomic_store_n(&row->max_ticks, ticks, __ATOMIC_RELAXED);
+    }
+    native_stats_bump(&row->buckets[native_stats_bucket(ticks)], 1);
+}
+
+#ifdef MUSCLEMAP_NATIVE_STATS
+
+static inline void native_stats_scope_end(NativeStatsScope* scope) {
+    native_stats_record(scope->site, scope->start);
+}
+
+#define NATIVE_STATS_SCOPE()                                                                  \
+    static NativeStatsSite native_stats_site_ = {__func__, 0};                                \
+    NativeStatsScope native_stats_scope_ __attribute__((cleanup(native_stats_scope_end))) = { \
+        &native_stats_site_, native_stats_now()}
+
+#else
+
+#define NATIVE_STATS_SCOPE() ((void)0)
+
+#endif
+
+#endif /* MUSCLEMAP_NATIVE_STATS_H */
@@ -0,0 +1,348 @@
+/**
+ * WebAssembly build of libgeo and libtu
+ *
+ * Usage:
+ *   import { loadMuscleMapWasm } from './musclemap-wasm.mjs';
+ *   const native = await loadMuscleMapWasm();
+ *   native.geohashEncode(40.7128, -74.006, 9);
+ *
+ * Build with `make wasm` (lib/wasm/, next to musclemap-core.mjs/.wasm).
+ *
+ * Same functions, arguments and results as the N-API addon's geo and TU
+ * exports (src/addon/addon.c), computed by the same C sources compiled
+ * with emcc -msimd128, so the frontend gets the server's numbers
+ * (test/wasm.mjs checks them bit for bit). Differences:
+ * - tuLoadCatalog takes the catalog bytes (Uint8Array or ArrayBuffer)
+ *   instead of a path; they are written to the module's in-memory
+ *   filesystem and mapped from there
+ * - tuActiveIsa() reports the kernel variant ("simd128")
+ * - Batches run on the calling thread (the work pool has no workers)
+ */
+
+import createMuscleMapCore from './musclemap-core.mjs';
+
+// Must match src/geo/geohash.h and src/workout/tu_calculator.h
+const GEOHASH_MAX_LEN = 12;
+const ID_BUFFER_LEN = 64;
+const MAX_MUSCLES = 64;
+const MAX_WORKOUT_EXERCISES = 50;
+const INPUT_SIZE = 16;                       // WorkoutExerciseInput
+const RESULT_SIZE = 4 + MAX_MUSCLES * 4;     // TUResult
+const POINTER_SIZE = 4;                      // wasm32
+
+const CATALOG_PATH = '/catalog.bin';
+const CATALOG_ERRORS = {
+  [-1]: 'cannot open or map catalog file',
+  [-2]: 'not a catalog file, or truncated',
+  [-3]: 'catalog format version, byte order or layout not supported',
+  [-4]: 'catalog file is corrupt',
+};
+
+const align8 = (n) => (n + 7) & ~7;
+
+function expectTyped(value, Type, message) {
+  if (!(value instanceof Type)) throw new TypeError(message);
+  return value;
+}
+
+function expectString(value) {
+  if (typeof value !== 'string') throw new TypeError('Expected string');
+  return value;
+}
+
+/**
+ * Caller's output array when it has the type and room, else a new one (as the addon)
+ */
+function outputTyped(out, Type, length) {
+  return out instanceof Type && out.length >= length ? out : new Type(length);
+}
+
+/**
+ * Instantiate the module; options go to the Emscripten factory (e.g. locateFile)
+ */
+export async function loadMuscleMapWasm(options = {}) {
+  const core = await createMuscleMapCore(options);
+
+  // One scratch block for call arguments and results, grown on demand.
+  // Heap views are re-read after every allocation: growth replaces them.
+  let scratch = 0;
+  let scratchSize = 0;
+  function reserve(bytes) {
+    if (!scratch || bytes > scratchSize) {
+      const size = Math.max(bytes, scratchSize * 2, 4096);
+      const block = core._malloc(size);
+      if (!block) throw new Error('Out of memory');
+      core._free(scratch);
+      scratch = block;
+      scratchSize = size;
+    }
+    return scratch;
+  }
+
+  // ============ libgeo ============
+
+  function geohashEncode(lat, lng, precision = 9) {
+    const out = reserve(GEOHASH_MAX_LEN + 1);
+    const len = core._geohash_encode(lat, lng, precision, out);
+    return len < 0 ? null : core.UTF8ToString(out, len);
+  }
+
+  function geohashDecode(hash) {
+    const base = reserve(16 + GEOHASH_MAX_LEN + 1);
+    core.stringToUTF8(expectString(hash), base + 16, GEOHASH_MAX_LEN + 1);
+    if (core._geohash_decode(base + 16, base, base + 8) !== 0) return null;
+    return { lat: core.HEAPF64[base >> 3], lng: core.HEAPF64[(base >> 3) + 1] };
+  }
+
+  function geohashPrecisionError(precision) {
+    const base = reserve(16);
+    if (core._geohash_precision_error(precision, base, base + 8) !== 0) return null;
+    return { latErr: core.HEAPF64[base >> 3], lngErr: core.HEAPF64[(base >> 3) + 1] };
+  }
+
+  function geohashNeighbors(hash) {
+    const base = reserve(8 * 13 + GEOHASH_MAX_LEN + 2);
+    const input = base + 8 * 13;
+    core.stringToUTF8(expectString(hash), input, GEOHASH_MAX_LEN + 2);
+    if (core._geohash_neighbors(input, base) !== 0) return null;
+    const result = [];
+    for (let i = 0; i < 8; i++) result.push(core.UTF8ToString(base + i * 13));
+    return result;
+  }
+
+  function haversineMeters(lat1, lng1, lat2, lng2) {
+    return core._haversine_meters(lat1, lng1, lat2, lng2);
+  }
+
+  /**
+   * points holds interleaved lat/lng pairs; returns out (or a new array)
+   */
+  function haversineBatch(lat, lng, points, out) {
+    expectTyped(points, Float64Array, 'Expected Float64Array of lat/lng pairs');
+    const count = Math.floor(points.length / 2);
+    const result = outputTyped(out, Float64Array, count);
+
+    const base = reserve(count * 16 + count * 8);
+    const distances = base + count * 16;
+    core.HEAPF64.set(points.subarray(0, count * 2), base >> 3);
+    core._haversine_batch(lat, lng, base, count, distances);
+    result.set(core.HEAPF64.subarray(distances >> 3, (distances >> 3) + count));
+    return result;
+  }
+
+  function isWithinRadius(lat1, lng1, lat2, lng2, radiusMeters) {
+    return core._is_within_radius(lat1, lng1, lat2, lng2, radiusMeters) !== 0;
+  }
+
+  function boundingBox(lat, lng, radiusMeters) {
+    const base = reserve(32);
+    core._bounding_box(lat, lng, radiusMeters, base, base + 8, base + 16, base + 24);
+    const f64 = core.HEAPF64;
+    const i = base >> 3;
+    return { minLat: f64[i], maxLat: f64[i + 1], minLng: f64[i + 2], maxLng: f64[i + 3] };
+  }
+
+  function optimalPrecision(radiusMeters) {
+    return core._optimal_precision(radiusMeters);
+  }
+
+  // ============ libtu ============
+
+  function tuInit() {
+    return core._tu_init();
+  }
+
+  function tuClear() {
+    core._tu_clear();
+  }
+
+  /**
+   * activations: Float32Array or number[] of percentages, one per muscle
+   */
+  function tuAddExercise(id, activations) {
+    const base = reserve(MAX_MUSCLES * 4 + ID_BUFFER_LEN);
+    const idPtr = base + MAX_MUSCLES * 4;
+    core.stringToUTF8(expectString(id), idPtr, ID_BUFFER_LEN);
+
+    let count;
+    const f32 = core.HEAPF32;
+    f32.fill(0, base >> 2, (base >> 2) + MAX_MUSCLES);
+    if (ArrayBuffer.isView(activations)) {
+      expectTyped(activations, Float32Array, 'Expected Float32Array of activations');
+      count = activations.length > MAX_MUSCLES ? MAX_MUSCLES + 1 : activations.length;
+      f32.set(activations.subarray(0, MAX_MUSCLES), base >> 2);
+    } else if (Array.isArray(activations)) {
+      count = activations.length;
+      for (let m = 0; m < count && m < MAX_MUSCLES; m++) {
+        f32[(base >> 2) + m] = typeof activations[m] === 'number' ? activations[m] : 0;
+      }
+    } else {
+      throw new TypeError('Expected activations array');
+    }
+    return core._tu_add_exercise(idPtr, base, count);
+  }
+
+  function tuAddMuscle(id, biasWeight) {
+    const base = reserve(ID_BUFFER_LEN);
+    core.stringToUTF8(expectString(id), base, ID_BUFFER_LEN);
+    return core._tu_add_muscle(base, biasWeight);
+  }
+
+  function tuFindExercise(id) {
+    const base = reserve(ID_BUFFER_LEN);
+    core.stringToUTF8(expectString(id), base, ID_BUFFER_LEN);
+    return core._tu_find_exercise(base);
+  }
+
+  /**
+   * Load a binary catalog (tools/build-catalog.js output) from its bytes;
+   * returns the exercise count, throws if the catalog is unusable
+   */
+  function tuLoadCatalog(bytes) {
+    const data = bytes instanceof ArrayBuffer ? new Uint8Array(bytes)
+      : ArrayBuffer.isView(bytes) ? new Uint8Array(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+      : null;
+    if (!data) throw new TypeError('Expected catalog bytes (Uint8Array or ArrayBuffer)');
+
+    core.FS.writeFile(CATALOG_PATH, data);
+    const base = reserve(CATALOG_PATH.length + 1);
+    core.stringToUTF8(CATALOG_PATH, base, CATALOG_PATH.length + 1);
+    const count = core._tu_load_catalog(base);
+    if (count < 0) throw new Error(CATALOG_ERRORS[count] || 'unknown catalog error');
+    return count;
+  }
+
+  function tuGetStats() {
+    const base = reserve(8);
+    core._tu_get_stats(base, base + 4);
+    return { exerciseCount: core.HEAP32[base >> 2], muscleCount: core.HEAP32[(base >> 2) + 1] };
+  }
+
+  /**
+   * [{ exerciseIndex, sets, reps?, weight? }] -> { totalTu, muscleActivations } | null
+   */
+  function tuCalculate(exercises) {
+    if (!Array.isArray(exercises)) throw new TypeError('Expected array of workout exercises');
+    const count = exercises.length;
+    if (count === 0 || count > MAX_WORKOUT_EXERCISES) return null;
+
+    const base = reserve(count * INPUT_SIZE + RESULT_SIZE);
+    const result = base + count * INPUT_SIZE;
+    const i32 = core.HEAP32;
+    const f32 = core.HEAPF32;
+    for (let i = 0; i < count; i++) {
+      const ex = exercises[i];
+      const at = (base + i * INPUT_SIZE) >> 2;
+      i32[at] = typeof ex.exerciseIndex === 'number' ? ex.exerciseIndex | 0 : -1;
+      i32[at + 1] = typeof ex.sets === 'number' ? ex.sets | 0 : 0;
+      i32[at + 2] = typeof ex.reps === 'number' ? ex.reps | 0 : 10;
+      f32[at + 3] = typeof ex.weight === 'number' ? ex.weight : 0;
+    }
+
+    if (core._tu_calculate(base, count, result) !== 0) return null;
+    const totals = core.HEAPF32.subarray(result >> 2, (result >> 2) + 1 + MAX_MUSCLES);
+    return { totalTu: totals[0], muscleActivations: totals.slice(1) };
+  }
+
+  /**
+   * packed holds (exerciseIndex, sets) pairs; workout w spans pairs
+   * offsets[w] .. offsets[w + 1]. Workouts that fail to calculate yield NaN.
+   */
+  function tuCalculateBatch(packed, offsets, out) {
+    expectTyped(packed, Int32Array, 'Expected Int32Array of (index, sets) pairs');
+    expectTyped(offsets, Int32Array, 'Expected Int32Array of workout offsets');
+    const batch = offsets.length > 0 ? offsets.length - 1 : 0;
+    const pairs = Math.floor(packed.length / 2);
+    for (let w = 0; w < batch; w++) {
+      if (offsets[w] < 0 || offsets[w + 1] < offsets[w] || offsets[w + 1] > pairs) {
+        throw new RangeError('Workout offsets must be ascending and within packed');
+      }
+    }
+    const totals = outputTyped(out, Float32Array, batch);
+    if (batch === 0) return totals;
+
+    const inputs = reserve((pairs + 1) * INPUT_SIZE + align8(batch * POINTER_SIZE) +
+                           align8(batch * 4) + batch * RESULT_SIZE);
+    const workouts = inputs + (pairs + 1) * INPUT_SIZE;
+    const counts = workouts + align8(batch * POINTER_SIZE);
+    const results = counts + align8(batch * 4);
+
+    const i32 = core.HEAP32;
+    const f32 = core.HEAPF32;
+    for (let i = 0; i < pairs; i++) {
+      const at = (inputs + i * INPUT_SIZE) >> 2;
+      i32[at] = packed[2 * i];
+      i32[at + 1] = packed[2 * i + 1];
+      i32[at + 2] = 10;
+      f32[at + 3] = 0;
+    }
+    for (let w = 0; w < batch; w++) {
+      i32[(workouts >> 2) + w] = inputs + offsets[w] * INPUT_SIZE;
+      i32[(counts >> 2) + w] = offsets[w + 1] - offsets[w];
+      f32[(results + w * RESULT_SIZE) >> 2] = NaN;
+    }
+
+    core._tu_calculate_batch(workouts, counts, batch, results);
+
+    // tu_calculate leaves rejected workouts untouched, so they stay NaN
+    const heap = core.HEAPF32;
+    for (let w = 0; w < batch; w++) totals[w] = heap[(results + w * RESULT_SIZE) >> 2];
+    return totals;
+  }
+
+  /**
+   * activations: Float32Array [exerciseCount * muscleCount]; sets: Int32Array;
+   * biasWeights: Float32Array [muscleCount]
+   */
+  function tuCalculateSimple(activations, sets, biasWeights, exerciseCount, muscleCount) {
+    expectTyped(activations, Float32Array, 'Expected Float32Array activations');
+    expectTyped(sets, Int32Array, 'Expected Int32Array sets');
+    expectTyped(biasWeights, Float32Array, 'Expected Float32Array bias weights');
+    exerciseCount |= 0;
+    muscleCount |= 0;
+    if (exerciseCount < 0 || muscleCount < 0 || muscleCount > MAX_MUSCLES ||
+        activations.length < exerciseCount * muscleCount ||
+        sets.length < exerciseCount || biasWeights.length < muscleCount) {
+      throw new RangeError('Array lengths do not match exerciseCount and muscleCount');
+    }
+
+    const activationBytes = exerciseCount * muscleCount * 4;
+    const base = reserve(activationBytes + exerciseCount * 4 + muscleCount * 4);
+    const setsPtr = base + activationBytes;
+    const biasPtr = setsPtr + exerciseCount * 4;
+    core.HEAPF32.set(activations.subarray(0, exerciseCount * muscleCount), base >> 2);
+    core.HEAP32.set(sets.subarray(0, exerciseCount), setsPtr >> 2);
+    core.HEAPF32.set(biasWeights.subarray(0, muscleCount), biasPtr >> 2);
+    return core._tu_calculate_simple(base, setsPtr, biasPtr, exerciseCount, muscleCount);
+  }
+
+  /**
+   * Kernel variant in use ("simd128")
+   */
+  function tuActiveIsa() {
+    return core.UTF8ToString(core._tu_active_isa());
+  }
+
+  return {
+    geohashEncode,
+    geohashDecode,
+    geohashPrecisionError,
+    geohashNeighbors,
+    haversineMeters,
+    haversineBatch,
+    isWithinRadius,
+    boundingBox,
+    optimalPrecision,
+    tuInit,
+    tuClear,
+    tuAddExercise,
+    tuAddMuscle,
+    tuFindExercise,
+    tuLoadCatalog,
+    tuGetStats,
+    tuCalculate,
+    tuCalculateBatch,
+    tuCalculateSimple,
+    tuActiveIsa,
+  };
+}
@@ -1,11 +1,13 @@
 /**
  * High-performance Training Unit (TU) Calculator
  *
- * Compile: gcc -O3 -march=native -fPIC -shared -o libtu.so tu_calculator.c -lm
+ * Compile: gcc -O3 -fPIC -shared -o libtu.so tu_calculator.c -lm
  *
  * Features:
  * - Pre-cached exercise activation data
- * - SIMD-optimized batch TU calculations
+ * - Zero-copy loading of the shared binary catalog (tu_load_catalog)
+ * - SIMD-optimized batch TU calculations (AVX2/AVX-512 picked at load time,
+ *   SIMD128 in the WebAssembly build)
  * - Thread-safe exercise cache
  */
 
@@ -15,6 +17,18 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+#include "tu_calculator.h"
+#include "../common/cpu_dispatch.h"
+#include "../workpool/workpool.h"
+#include "../stats/native_stats.h"
+#include "../common/probes.h"
+#include "../common/catalog_format.h"
+#include "../capture/native_capture.h"
 
 #ifdef _WIN32
 #define EXPORT __declspec(dllexport)
@@ -24,60 +38,150 @@
 
 /* Configuration */
 #define MAX_EXERCISES 1000
-#define MAX_MUSCLES 64
-#define MAX_WORKOUT_EXERCISES 50
 #define EXERCISE_ID_LEN 64
+#define BATCH_GRAIN 64              /* Workouts per work-stealing range (~20-50 us) */
 
-/* Exercise with muscle activations */
-typedef struct {
-    char id[EXERCISE_ID_LEN];
-    float activations[MAX_MUSCLES];  /* Activation percentage per muscle (0-100) */
-    uint32_t activation_count;        /* Number of non-zero activations */
-    bool is_valid;
-} CachedExercise;
-
-/* Muscle with bias weight */
-typedef struct {
-    char id[EXERCISE_ID_LEN];
-    float bias_weight;
-    bool is_valid;
-} CachedMuscle;
+_Static_assert(EXERCISE_ID_LEN == CATALOG_ID_LEN && MAX_MUSCLES == CATALOG_MAX_MUSCLES,
+               "built-in cache rows must match the catalog file layout");
 
-/* Workout exercise input */
-typedef struct {
-    int32_t exercise_index;  /* Index into cached exercises */
-    int32_t sets;
-    int32_t reps;            /* Optional, default 10 */
-    float weight;            /* Optional */
-} WorkoutExerciseInput;
+/* Built-in cache, filled by tu_add_exercise / tu_add_muscle */
+static char g_exercise_ids[MAX_EXERCISES][EXERCISE_ID_LEN];
+static float g_exercise_activations[MAX_EXERCISES][MAX_MUSCLES] __attribute__((aligned(64)));
+static uint32_t g_activation_counts[MAX_EXERCISES];  /* Activations given per exercise */
+static char g_muscle_ids[MAX_MUSCLES][EXERCISE_ID_LEN];
+static float g_muscle_bias[MAX_MUSCLES];
 
-/* TU calculation result */
-typedef struct {
-    float total_tu;
-    float muscle_activations[MAX_MUSCLES];
-} TUResult;
+/*
+ * Tables in use: the built-in cache, or the sections of a catalog file
+ * mapped by tu_load_catalog (same row layouts, so the hot path is shared)
+ */
+static const float* g_activations = &g_exercise_activations[0][0];  /* [exercise][MAX_MUSCLES] */
+static const uint32_t* g_spans = g_activation_counts;    /* Activations to accumulate per exercise */
+static const float* g_bias = g_muscle_bias;
+static CatalogFile g_catalog_file;                       /* Mapped catalog, or not open */
 
-/* Global cache */
-static CachedExercise g_exercises[MAX_EXERCISES];
-static CachedMuscle g_muscles[MAX_MUSCLES];
 static int32_t g_exercise_count = 0;
 static int32_t g_muscle_count = 0;
 static pthread_rwlock_t g_cache_lock = PTHREAD_RWLOCK_INITIALIZER;
 
+/* ============================================
+ * SIMD KERNELS
+ * ============================================ */
+
+/**
+ * totals[m] += activation% * sets for each positive activation
+ * Branch-free so it vectorizes; every ISA variant gives identical sums
+ */
+static inline __attribute__((always_inline)) void accumulate_body(
+    float* restrict totals,
+    const float* restrict activations,
+    int32_t count,
+    float sets
+) {
+    for (int32_t m = 0; m < count; m++) {
+        float activation = activations[m] > 0.0f ? activations[m] : 0.0f;
+        totals[m] += (activation / 100.0f) * sets;
+    }
+}
+
+static void accumulate_baseline(float* restrict totals, const float* restrict activations, int32_t count, float sets) {
+    accumulate_body(totals, activations, count, sets);
+}
+
+#if NATIVE_DISPATCH_X86
+NATIVE_TARGET_AVX2
+static void accumulate_avx2(float* restrict totals, const float* restrict activations, int32_t count, float sets) {
+    accumulate_body(totals, activations, count, sets);
+}
+
+NATIVE_TARGET_AVX512
+static void accumulate_avx512(float* restrict totals, const float* restrict activations, int32_t count, float sets) {
+    accumulate_body(totals, activations, count, sets);
+}
+#endif
+
+#if NATIVE_DISPATCH_WASM_SIMD
+/**
+ * accumulate_body four muscles per step, for the WebAssembly build
+ * pmax(0, a) is `0 < a ? a : 0`, the scalar clamp (NaN and -0 give +0)
+ */
+static void accumulate_simd128(float* restrict totals, const float* restrict activations, int32_t count, float sets) {
+    const v128_t zero = wasm_f32x4_splat(0.0f);
+    const v128_t hundred = wasm_f32x4_splat(100.0f);
+    const v128_t scale = wasm_f32x4_splat(sets);
+
+    int32_t m = 0;
+    for (; m + 4 <= count; m += 4) {
+        v128_t activation = wasm_f32x4_pmax(zero, wasm_v128_load(activations + m));
+        v128_t added = wasm_f32x4_mul(wasm_f32x4_div(activation, hundred), scale);
+        wasm_v128_store(totals + m, wasm_f32x4_add(wasm_v128_load(totals + m), added));
+    }
+    accumulate_body(totals + m, activations + m, count - m, sets);
+}
+#endif
+
+typedef void (*AccumulateFn)(float* restrict, const float* restrict, int32_t, float);
+
+static AccumulateFn accumulate_activations = accumulate_baseline;
+static NativeIsa g_isa = NATIVE_ISA_BASELINE;
+
+/**
+ * Pick the widest kernel variant for this CPU at load time
+ */
+__attribute__((constructor))
+static void tu_select_kernels(void) {
+    g_isa = native_isa_select();
+#if NATIVE_DISPATCH_X86
+    if (g_isa == NATIVE_ISA_AVX512) {
+        accumulate_activations = accumulate_avx512;
+    } else if (g_isa == NATIVE_ISA_AVX2) {
+        accumulate_activations = accumulate_avx2;
+    }
+#elif NATIVE_DISPATCH_WASM_SIMD
+    if (g_isa == NATIVE_ISA_SIMD128) {
+        accumulate_activations = accumulate_simd128;
+    }
+#endif
+}
+
+/**
+ * Name of the kernel variant in use ("baseline", "avx2", "avx512" or "simd128")
+ */
+EXPORT const char* tu_active_isa(void) {
+    NATIVE_STATS_SCOPE();
+    return NATIVE_ISA_NAMES[g_isa];
+}
+
 /* ============================================
  * CACHE MANAGEMENT
  * ============================================ */
 
+/**
+ * Empty the cache and drop a mapped catalog (write lock held)
+ */
+static void reset_cache_locked(void) {
+    catalog_file_close(&g_catalog_file);
+    g_activations = &g_exercise_activations[0][0];
+    g_spans = g_activation_counts;
+    g_bias = g_muscle_bias;
+
+    memset(g_exercise_ids, 0, sizeof(g_exercise_ids));
+    memset(g_exercise_activations, 0, sizeof(g_exercise_activations));
+    memset(g_activation_counts, 0, sizeof(g_activation_counts));
+    memset(g_muscle_ids, 0, sizeof(g_muscle_ids));
+    memset(g_muscle_bias, 0, sizeof(g_muscle_bias));
+    g_exercise_count = 0;
+    g_muscle_count = 0;
+}
+
 /**
  * Initialize the TU calculator cache
  * Returns: 0 on success, -1 on error
  */
 EXPORT int tu_init(void) {
+    NATIVE_STATS_SCOPE();
     pthread_rwlock_wrlock(&g_cache_lock);
-    memset(g_exercises, 0, sizeof(g_exercises));
-    memset(g_muscles, 0, sizeof(g_muscles));
-    g_exercise_count = 0;
-    g_muscle_count = 0;
+    reset_cache_locked();
     pthread_rwlock_unlock(&g_cache_lock);
     return 0;
 }
@@ -86,12 +190,46 @@ EXPORT int tu_init(void) {
  * Clear the cache
  */
 EXPORT void tu_clear(void) {
+    NATIVE_STATS_SCOPE();
     pthread_rwlock_wrlock(&g_cache_lock);
-    memset(g_exercises, 0, sizeof(g_exercises));
-    memset(g_muscles, 0, sizeof(g_muscles));
-    g_exercise_count = 0;
-    g_muscle_count = 0;
+    reset_cache_locked();
+    pthread_rwlock_unlock(&g_cache_lock);
+}
+
+/**
+ * Replace the cache with a binary catalog file (src/common/catalog_format.h)
+ *
+ * The file is mapped read-only and used in place: exercise indices are the
+ * catalog's dense indices and muscles follow its muscle order. Until the
+ * next tu_init / tu_clear, tu_add_exercise and tu_add_muscle fail.
+ *
+ * @param path Catalog file written by tools/build-catalog.js
+ * @return Number of exercises, or a negative CATALOG_ERR_* code
+ */
+EXPORT int tu_load_catalog(const char* path) {
+    NATIVE_STATS_SCOPE();
+    if (!path) {
+        return CATALOG_ERR_OPEN;
+    }
+
+    CatalogFile file;
+    int rc = catalog_file_open(path, &file);
+    if (rc != 0) {
+        return rc;
+    }
+
+    pthread_rwlock_wrlock(&g_cache_lock);
+    reset_cache_locked();
+    g_catalog_file = file;
+    g_activations = catalog_section(&file, CATALOG_SECTION_ACTIVATIONS);
+    g_spans = catalog_section(&file, CATALOG_SECTION_ACTIVATION_SPAN);
+    g_bias = catalog_section(&file, CATALOG_SECTION_MUSCLE_BIAS);
+    g_exercise_count = (int32_t)file.header->exercise_count;
+    g_muscle_count = (int32_t)file.header->muscle_count;
+    int count = g_exercise_count;
     pthread_rwlock_unlock(&g_cache_lock);
+
+    return count;
 }
 
 /**
@@ -103,26 +241,25 @@ EXPORT int tu_add_exercise(
     const float* activations,
     int32_t activation_count
 ) {
+    NATIVE_STATS_SCOPE();
     if (!exercise_id || !activations || activation_count > MAX_MUSCLES) {
         return -1;
     }
 
     pthread_rwlock_wrlock(&g_cache_lock);
 
-    if (g_exercise_count >= MAX_EXERCISES) {
+    if (g_catalog_file.header || g_exercise_count >= MAX_EXERCISES) {
         pthread_rwlock_unlock(&g_cache_lock);
         return -1;
     }
 
     int index = g_exercise_count++;
-    CachedExercise* ex = &g_exercises[index];
 
-    strncpy(ex->id, exercise_id, EXERCISE_ID_LEN - 1);
-    ex->id[EXERCISE_ID_LEN - 1] = '\0';
+    strncpy(g_exercise_ids[index], exercise_id, EXERCISE_ID_LEN - 1);
+    g_exercise_ids[index][EXERCISE_ID_LEN - 1] = '\0';
 
-    memcpy(ex->activations, activations, activation_count * sizeof(float));
-    ex->activation_count = activation_count;
-    ex->is_valid = true;
+    memcpy(g_exercise_activations[index], activations, activation_count * sizeof(float));
+    g_activation_counts[index] = activation_count;
 
     pthread_rwlock_unlock(&g_cache_lock);
     return index;
@@ -136,24 +273,23 @@ EXPORT int tu_add_muscle(
     const char* muscle_id,
     float bias_weight
 ) {
+    NATIVE_STATS_SCOPE();
     if (!muscle_id) {
         return -1;
     }
 
     pthread_rwlock_wrlock(&g_cache_lock);
 
-    if (g_muscle_count >= MAX_MUSCLES) {
+    if (g_catalog_file.header || g_muscle_count >= MAX_MUSCLES) {
         pthread_rwlock_unlock(&g_cache_lock);
         return -1;
     }
 
     int index = g_muscle_count++;
-    CachedMuscle* m = &g_muscles[index];
 
-    strncpy(m->id, muscle_id, EXERCISE_ID_LEN - 1);
-    m->id[EXERCISE_ID_LEN - 1] = '\0';
-    m->bias_weight = bias_weight;
-    m->is_valid = true;
+    strncpy(g_muscle_ids[index], muscle_id, EXERCISE_ID_LEN - 1);
+    g_muscle_ids[index][EXERCISE_ID_LEN - 1] = '\0';
+    g_muscle_bias[index] = bias_weight;
 
     pthread_rwlock_unlock(&g_cache_lock);
     return index;
@@ -164,13 +300,20 @@ EXPORT int tu_add_muscle(
  * Returns: index or -1 if not found
  */
 EXPORT int tu_find_exercise(const char* exercise_id) {
+    NATIVE_STATS_SCOPE();
     if (!exercise_id) return -1;
 
     pthread_rwlock_rdlock(&g_cache_lock);
 
+    /* Mapped catalogs carry an ID hash table */
+    if (g_catalog_file.header) {
+        int index = catalog_find_exercise(&g_catalog_file, exercise_id);
+        pthread_rwlock_unlock(&g_cache_lock);
+        return index;
+    }
+
     for (int i = 0; i < g_exercise_count; i++) {
-        if (g_exercises[i].is_valid &&
-            strncmp(g_exercises[i].id, exercise_id, EXERCISE_ID_LEN) == 0) {
+        if (strncmp(g_exercise_ids[i], exercise_id, EXERCISE_ID_LEN) == 0) {
             pthread_rwlock_unlock(&g_cache_lock);
             return i;
         }
@@ -184,6 +327,7 @@ EXPORT int tu_find_exercise(const char* exercise_id) {
  * Get cache statistics
  */
 EXPORT void tu_get_stats(int32_t* exercise_count, int32_t* muscle_count) {
+    NATIVE_STATS_SCOPE();
     pthread_rwlock_rdlock(&g_cache_lock);
     if (exercise_count) *exercise_count = g_exercise_count;
     if (muscle_count) *muscle_count = g_muscle_count;
@@ -195,16 +339,36 @@ EXPORT void tu_get_stats(int32_t* exercise_count, int32_t* muscle_count) {
  * ============================================ */
 
 /**
- * Calculate TU for a single workout
- *
- * @param exercises Array of exercise inputs
- * @param count Number of exercises
- * @param result Output result structure
- * @return 0 on success, -1 on error
+ * Append a workout's exercises to a capture record, up to the record's room
+ */
+static void capture_workout(NativeCaptureRecord* capture, const WorkoutExerciseInput* exercises, int32_t count) {
+    NativeCaptureTu* args = (NativeCaptureTu*)capture->args;
+    args->workouts++;
+    if (!exercises || count <= 0) {
+        return;
+    }
+    int32_t room = NATIVE_CAPTURE_TU_EXERCISES - args->exercises;
+    int32_t kept = count < room ? count : (room > 0 ? room : 0);
+    for (int32_t e = 0; e < kept; e++) {
+        int32_t sets = exercises[e].sets;
+        args->exercise_index[args->exercises + e] = exercises[e].exercise_index;
+        args->sets[args->exercises + e] = (uint8_t)(sets < 0 ? 0 : sets > UINT8_MAX ? UINT8_MAX : sets);
+        if (sets < 0 || sets > UINT8_MAX) {
+            capture->flags |= NATIVE_CAPTURE_TRUNCATED;
+        }
+    }
+    if (kept < count) {
+        capture->flags |= NATIVE_CAPTURE_TRUNCATED;
+    }
+    args->exercises += count;
+}
+
+/**
+ * TU for one workout (shared by tu_calculate and the batch workers)
  *
  * Formula: TU = sum(activation * sets * bias_weight) for each muscle
  */
-EXPORT int __attribute__((hot)) tu_calculate(
+static inline __attribute__((always_inline)) int calculate_workout(
     const WorkoutExerciseInput* exercises,
     int32_t count,
     TUResult* result
@@ -226,29 +390,21 @@ EXPORT int __attribute__((hot)) tu_calculate(
             continue;
         }
 
-        const CachedExercise* ex = &g_exercises[input->exercise_index];
-        if (!ex->is_valid) {
-            continue;
-        }
-
         /* Sets contribution */
         int32_t sets = input->sets > 0 ? input->sets : 1;
 
-        /* Accumulate activations for each muscle */
-        for (uint32_t m = 0; m < ex->activation_count && m < MAX_MUSCLES; m++) {
-            float activation = ex->activations[m];
-            if (activation > 0.0f) {
-                /* activation is 0-100, normalize to 0-1 */
-                result->muscle_activations[m] += (activation / 100.0f) * (float)sets;
-            }
-        }
+        /* Accumulate activations for each muscle (0-100, normalized to 0-1) */
+        uint32_t span = g_spans[input->exercise_index];
+        int32_t muscles = span < MAX_MUSCLES ? (int32_t)span : MAX_MUSCLES;
+        accumulate_activations(result->muscle_activations,
+                               g_activations + (size_t)input->exercise_index * MAX_MUSCLES, muscles, (float)sets);
     }
 
     /* Apply bias weights and calculate total TU */
     float total = 0.0f;
     for (int m = 0; m < g_muscle_count; m++) {
-        if (result->muscle_activations[m] > 0.0f && g_muscles[m].is_valid) {
-            float weighted = result->muscle_activations[m] * g_muscles[m].bias_weight;
+        if (result->muscle_activations[m] > 0.0f) {
+            float weighted = result->muscle_activations[m] * g_bias[m];
             total += weighted;
         }
     }
@@ -260,7 +416,51 @@ EXPORT int __attribute__((hot)) tu_calculate(
 }
 
 /**
- * Calculate TU for a batch of workouts (parallel optimization)
+ * Calculate TU for a single workout
+ *
+ * @param exercises Array of exercise inputs
+ * @param count Number of exercises
+ * @param result Output result structure
+ * @return 0 on success, -1 on error
+ */
+EXPORT int __attribute__((hot)) tu_calculate(
+    const WorkoutExerciseInput* exercises,
+    int32_t count,
+    TUResult* result
+) {
+    NATIVE_STATS_SCOPE();
+    NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_TU_CALCULATE);
+    if (capture) {
+        capture_workout(capture, exercises, count);
+    }
+    return calculate_workout(exercises, count, result);
+}
+
+/**
+ * Shared state for a parallel batch
+ */
+typedef struct {
+    const WorkoutExerciseInput** workouts;
+    const int32_t* workout_counts;
+    TUResult* results;
+    _Atomic int32_t success_count;
+} BatchContext;
+
+static void calculate_range(void* ctx, size_t begin, size_t end) {
+    BatchContext* batch = ctx;
+    int32_t success = 0;
+
+    for (size_t i = begin; i < end; i++) {
+        if (calculate_workout(batch->workouts[i], batch->workout_counts[i], &batch->results[i]) == 0) {
+            success++;
+        }
+    }
+
+    atomic_fetch_add_explicit(&batch->success_count, success, memory_order_relaxed);
+}
+
+/**
+ * Calculate TU for a batch of workouts (parallel on the shared work pool)
  *
  * @param workouts Array of workout arrays
  * @param workout_counts Number of exercises in each workout
@@ -274,19 +474,26 @@ EXPORT int tu_calculate_batch(
     int32_t batch_size,
     TUResult* results
 ) {
+    NATIVE_STATS_SCOPE();
     if (!workouts || !workout_counts || !results || batch_size <= 0) {
         return -1;
     }
 
-    int success_count = 0;
-
-    for (int i = 0; i < batch_size; i++) {
-        if (tu_calculate(workouts[i], workout_counts[i], &results[i]) == 0) {
-            success_count++;
+    NATIVE_CAPTURE_SCOPE(capture, NATIVE_CAPTURE_TU_CALCULATE_BATCH);
+    if (capture) {
+        for (int32_t i = 0; i < batch_size; i++) {
+            capture_workout(capture, workouts[i], workout_counts[i]);
         }
     }
 
-    return success_count;
+    NATIVE_PROBE1(tu__batch__start, batch_size);
+
+    BatchContext batch = {workouts, workout_counts, results, 0};
+    workpool_parallel_for(0, (size_t)batch_size, BATCH_GRAIN, calculate_range, &batch);
+
+    int32_t success = atomic_load(&batch.success_count);
+    NATIVE_PROBE2(tu__batch__end, batch_size, success);
+    return success;
 }
 
 /**
@@ -306,6 +513,7 @@ EXPORT float __attribute__((hot)) tu_calculate_simple(
     int32_t exercise_count,
     int32_t muscle_count
 ) {
+    NATIVE_STATS_SCOPE();
     if (!activations || !sets || !bias_weights ||
         exercise_count <= 0 || muscle_count <= 0) {
         return 0.0f;
@@ -316,13 +524,7 @@ EXPORT float __attribute__((hot)) tu_calculate_simple(
     /* Accumulate activations */
     for (int e = 0; e < exercise_count; e++) {
         int32_t s = sets[e] > 0 ? sets[e] : 1;
-
-        for (int m = 0; m < muscle_count; m++) {
-            float activation = activations[e * muscle_count + m];
-            if (activation > 0.0f) {
-                muscle_totals[m] += (activation / 100.0f) * (float)s;
-            }
-        }
+        accumulate_activations(muscle_totals, activations + (size_t)e * muscle_count, muscle_count, (float)s);
     }
 
     /* Apply bias weights */
@@ -0,0 +1,57 @@
+/**
+ * Training Unit calculator (libtu)
+ *
+ * Shared by the ffi-loaded library and the N-API addon.
+ */
+
+#ifndef MUSCLEMAP_TU_CALCULATOR_H
+#define MUSCLEMAP_TU_CALCULATOR_H
+
+#include <stdint.h>
+
+#define MAX_MUSCLES 64
+#define MAX_WORKOUT_EXERCISES 50
+
+/* Workout exercise input */
+typedef struct {
+    int32_t exercise_index;  /* Index into cached exercises */
+    int32_t sets;
+    int32_t reps;            /* Optional, default 10 */
+    float weight;            /* Optional */
+} WorkoutExerciseInput;
+
+/* TU calculation result */
+typedef struct {
+    float total_tu;
+    float muscle_activations[MAX_MUSCLES];
+} TUResult;
+
+int tu_init(void);
+void tu_clear(void);
+int tu_add_exercise(const char* exercise_id, const float* activations, int32_t activation_count);
+int tu_add_muscle(const char* muscle_id, float bias_weight);
+int tu_find_exercise(const char* exercise_id);
+
+/* Map a binary catalog (src/common/catalog_format.h) in place of the cache:
+ * exercise count, or a negative CATALOG_ERR_* code */
+int tu_load_catalog(const char* path);
+void tu_get_stats(int32_t* exercise_count, int32_t* muscle_count);
+int tu_calculate(const WorkoutExerciseInput* exercises, int32_t count, TUResult* result);
+int tu_calculate_batch(
+    const WorkoutExerciseInput** workouts,
+    const int32_t* workout_counts,
+    int32_t batch_size,
+    TUResult* results
+);
+float tu_calculate_simple(
+    const float* activations,
+    const int32_t* sets,
+    const float* bias_weights,
+    int32_t exercise_count,
+    int32_t muscle_count
+);
+
+/* Kernel variant picked at load time: "baseline", "avx2", "avx512" or "simd128" */
+const char* tu_active_isa(void);
+
+#endif /* MUSCLEMAP_TU_CALCULATOR_H */
@@ -0,0 +1,580 @@
+/**
+ * Shared Work-Stealing Thread Pool
+ *
+ * Compile: gcc -O3 -fPIC -shared -o libworkpool.so workpool.c -lpthread
+ *
+ * Features:
+ * - Per-thread deques: owners push/pop the newest range, thieves take
+ *   the oldest (largest) one
+ * - Lazy binary splitting down to the caller's grain size
+ * - Callers from outside the pool (Node main thread, libuv workers) get
+ *   a submit deque and help until their batch is done
+ * - Idle workers spin briefly, then sleep until a batch or a new range
+ *   is posted, so they do not compete with libuv's threads
+ * - Default size leaves room for libuv's pool (UV_THREADPOOL_SIZE)
+ *
+ * WebAssembly builds (__EMSCRIPTEN__) are compiled without threads and
+ * take the serial implementation at the end of this file: one thread,
+ * every batch inline on the caller.
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "workpool.h"
+#include "../stats/native_stats.h"
+
+#ifdef _WIN32
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifndef __EMSCRIPTEN__
+
+/* Configuration constants */
+#define DEQUE_CAPACITY 256
+#define MAX_SUBMITTERS 32
+#define MAX_THREADS 256
+#define SPIN_ROUNDS 64
+#define YIELD_ROUNDS 16         /* sched_yield rounds after spinning, before sleeping */
+#define UV_DEFAULT_THREADS 4    /* libuv's pool size when UV_THREADPOOL_SIZE is unset */
+
+/* ============================================
+ * DATA STRUCTURES
+ * ============================================ */
+
+/**
+ * One parallel_for call; lives on the caller's stack until remaining hits 0
+ */
+typedef struct {
+    WorkpoolRangeFn fn;
+    void* ctx;
+    size_t grain;
+    _Atomic size_t remaining;
+} Job;
+
+/**
+ * A range of a job's items
+ */
+typedef struct {
+    size_t begin;
+    size_t end;
+    Job* job;
+} Task;
+
+/**
+ * Bounded deque; owner works at the tail, thieves at the head
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    _Atomic size_t size;
+    size_t head;
+    size_t tail;
+    bool in_use;
+    Task tasks[DEQUE_CAPACITY];
+} Deque;
+
+/**
+ * Process-wide pool state
+ */
+static struct {
+    pthread_mutex_t lock;       /* start/stop, submit slots, sleeping workers */
+    pthread_cond_t wake;        /* Batch started, range pushed, or stopping */
+    pthread_t* threads;
+    Deque* deques;              /* [deque_count]: worker deques, then submit deques */
+    int32_t deque_count;
+    int32_t submit_base;        /* Index of the first submit deque */
+    int32_t workers;            /* Running background threads (thread count - 1) */
+    int32_t configured_threads; /* 0 = environment/default */
+    int32_t configured_pin;     /* -1 = environment */
+    _Atomic bool started;
+    _Atomic bool stopping;
+    _Atomic int32_t active_jobs;
+    _Atomic int32_t sleeping;
+} g_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .configured_pin = -1,
+};
+
+/* Deque of the current thread (worker or submitter), if any */
+static _Thread_local Deque* tl_deque;
+
+/* ============================================
+ * DEQUE OPERATIONS
+ * ============================================ */
+
+static void deque_init(Deque* dq) {
+    pthread_mutex_init(&dq->lock, NULL);
+    atomic_init(&dq->size, 0);
+    dq->head = 0;
+    dq->tail = 0;
+    dq->in_use = false;
+}
+
+/**
+ * Push at the tail; returns false when full (caller runs the task itself)
+ */
+static bool deque_push(Deque* dq, Task task) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail - dq->head == DEQUE_CAPACITY) {
+        pthread_mutex_unlock(&dq->lock);
+        return false;
+    }
+    dq->tasks[dq->tail % DEQUE_CAPACITY] = task;
+    dq->tail++;
+    atomic_store_explicit(&dq->size, dq->tail - dq->head, memory_order_relaxed);
+    pthread_mutex_unlock(&dq->lock);
+    return true;
+}
+
+/**
+ * Pop the newest task (owner side)
+ */
+static bool deque_pop(Deque* dq, Task* out) {
+    if (atomic_load_explicit(&dq->size, memory_order_relaxed) == 0) {
+        return false;
+    }
+    pthread_mutex_lock(&dq->lock);
+    bool found = dq->tail != dq->head;
+    if (found) {
+        dq->tail--;
+        *out = dq->tasks[dq->tail % DEQUE_CAPACITY];
+        atomic_store_explicit(&dq->size, dq->tail - dq->head, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+/**
+ * Take the oldest task (thief side)
+ */
+static bool deque_steal(Deque* dq, Task* out) {
+    if (atomic_load_explicit(&dq->size, memory_order_relaxed) == 0) {
+        return false;
+    }
+    pthread_mutex_lock(&dq->lock);
+    bool found = dq->tail != dq->head;
+    if (found) {
+        *out = dq->tasks[dq->head % DEQUE_CAPACITY];
+        dq->head++;
+        atomic_store_explicit(&dq->size, dq->tail - dq->head, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+/**
+ * Steal from any other deque, starting at a random victim
+ */
+static bool steal_any(Deque* self, uint32_t* rng, Task* out) {
+    int32_t count = g_pool.deque_count;
+
+    uint32_t x = *rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *rng = x;
+
+    int32_t start = (int32_t)(x % (uint32_t)count);
+    for (int32_t i = 0; i < count; i++) {
+        Deque* victim = &g_pool.deques[(start + i) % count];
+        if (victim != self && deque_steal(victim, out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Whether any deque holds a task (g_pool.lock held by a worker about to sleep)
+ */
+static bool any_work(void) {
+    for (int32_t i = 0; i < g_pool.deque_count; i++) {
+        if (atomic_load_explicit(&g_pool.deques[i].size, memory_order_relaxed) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Wake one sleeping worker after a push
+ * The fence pairs with the one in worker_main: either the sleeper sees
+ * the new task before waiting, or this sees it counted in `sleeping`.
+ */
+static void wake_sleeper(void) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&g_pool.sleeping, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&g_pool.lock);
+        pthread_cond_signal(&g_pool.wake);
+        pthread_mutex_unlock(&g_pool.lock);
+    }
+}
+
+/* ============================================
+ * EXECUTION
+ * ============================================ */
+
+/**
+ * Run a range: push upper halves for thieves until it fits the grain,
+ * then process the rest here
+ */
+static void run_task(Deque* self, Task task) {
+    Job* job = task.job;
+    size_t begin = task.begin;
+    size_t end = task.end;
+
+    while (end - begin > job->grain) {
+        size_t mid = begin + (end - begin) / 2;
+        if (!deque_push(self, (Task){mid, end, job})) {
+            break;
+        }
+        wake_sleeper();
+        end = mid;
+    }
+
+    job->fn(job->ctx, begin, end);
+    atomic_fetch_sub_explicit(&job->remaining, end - begin, memory_order_release);
+}
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+typedef struct {
+    int32_t index;
+    int32_t pin;
+} WorkerArgs;
+
+static void* worker_main(void* arg) {
+    WorkerArgs args = *(WorkerArgs*)arg;
+    free(arg);
+
+    Deque* self = &g_pool.deques[args.index];
+    tl_deque = self;
+
+#ifdef __linux__
+    if (args.pin) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(args.index % (cpus > 0 ? cpus : 1), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    uint32_t rng = 0x9E3779B9u * (uint32_t)(args.index + 1);
+    int32_t idle = 0;
+
+    while (!atomic_load_explicit(&g_pool.stopping, memory_order_acquire)) {
+        Task task;
+        if (deque_pop(self, &task) || steal_any(self, &rng, &task)) {
+            run_task(self, task);
+            idle = 0;
+            continue;
+        }
+
+        /* A batch is running: spin, then yield, for a bounded time */
+        if (atomic_load(&g_pool.active_jobs) > 0 && idle < SPIN_ROUNDS + YIELD_ROUNDS) {
+            if (++idle < SPIN_ROUNDS) {
+                cpu_relax();
+            } else {
+                sched_yield();
+            }
+            continue;
+        }
+
+        /* Nothing to steal: sleep until a batch starts or a range is pushed */
+        pthread_mutex_lock(&g_pool.lock);
+        atomic_fetch_add(&g_pool.sleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        while (!any_work() && !atomic_load(&g_pool.stopping)) {
+            pthread_cond_wait(&g_pool.wake, &g_pool.lock);
+        }
+        atomic_fetch_sub(&g_pool.sleeping, 1);
+        pthread_mutex_unlock(&g_pool.lock);
+        idle = 0;
+    }
+
+    return NULL;
+}
+
+/* ============================================
+ * POOL LIFECYCLE
+ * ============================================ */
+
+static int32_t resolve_thread_count(void) {
+    if (g_pool.configured_threads > 0) {
+        return g_pool.configured_threads;
+    }
+    const char* env = getenv("MUSCLEMAP_NATIVE_THREADS");
+    if (env && atoi(env) > 0) {
+        return atoi(env);
+    }
+
+    /* Leave room for libuv's pool, which runs the addon's async work */
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    const char* uv = getenv("UV_THREADPOOL_SIZE");
+    long uv_threads = uv && atoi(uv) > 0 ? atoi(uv) : UV_DEFAULT_THREADS;
+    return cpus - uv_threads > 1 ? (int32_t)(cpus - uv_threads) : 1;
+}
+
+static int32_t resolve_pin(void) {
+    if (g_pool.configured_pin >= 0) {
+        return g_pool.configured_pin;
+    }
+    const char* env = getenv("MUSCLEMAP_NATIVE_AFFINITY");
+    return env && strcmp(env, "1") == 0;
+}
+
+/**
+ * Start workers (called with g_pool.lock held)
+ * On thread creation failure the pool keeps whatever workers started
+ */
+static void start_locked(void) {
+    int32_t threads = resolve_thread_count();
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    int32_t workers = threads - 1;
+    int32_t pin = resolve_pin();
+
+    g_pool.workers = 0;
+    g_pool.deque_count = 0;
+    g_pool.deques = calloc((size_t)(workers + MAX_SUBMITTERS), sizeof(Deque));
+    g_pool.threads = calloc((size_t)(workers > 0 ? workers : 1), sizeof(pthread_t));
+    if (!g_pool.deques || !g_pool.threads) {
+        free(g_pool.deques);
+        free(g_pool.threads);
+        g_pool.deques = NULL;
+        g_pool.threads = NULL;
+        atomic_store(&g_pool.started, true);
+        return;
+    }
+
+    for (int32_t i = 0; i < workers + MAX_SUBMITTERS; i++) {
+        deque_init(&g_pool.deques[i]);
+    }
+    g_pool.deque_count = workers + MAX_SUBMITTERS;
+    g_pool.submit_base = workers;
+    atomic_store(&g_pool.stopping, false);
+
+    for (int32_t i = 0; i < workers; i++) {
+        WorkerArgs* args = malloc(sizeof(WorkerArgs));
+        if (!args) break;
+        args->index = i;
+        args->pin = pin;
+        if (pthread_create(&g_pool.threads[i], NULL, worker_main, args) != 0) {
+            free(args);
+            break;
+        }
+        g_pool.workers++;
+    }
+
+    atomic_store_explicit(&g_pool.started, true, memory_order_release);
+}
+
+static void ensure_started(void) {
+    if (atomic_load_explicit(&g_pool.started, memory_order_acquire)) {
+        return;
+    }
+    pthread_mutex_lock(&g_pool.lock);
+    if (!atomic_load(&g_pool.started)) {
+        start_locked();
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+EXPORT void workpool_shutdown(void) {
+    NATIVE_STATS_SCOPE();
+    pthread_mutex_lock(&g_pool.lock);
+    if (!atomic_load(&g_pool.started)) {
+        pthread_mutex_unlock(&g_pool.lock);
+        return;
+    }
+    atomic_store(&g_pool.stopping, true);
+    pthread_cond_broadcast(&g_pool.wake);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    for (int32_t i = 0; i < g_pool.workers; i++) {
+        pthread_join(g_pool.threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&g_pool.lock);
+    if (g_pool.deques) {
+        for (int32_t i = 0; i < g_pool.deque_count; i++) {
+            pthread_mutex_destroy(&g_pool.deques[i].lock);
+        }
+    }
+    free(g_pool.deques);
+    free(g_pool.threads);
+    g_pool.deques = NULL;
+    g_pool.threads = NULL;
+    g_pool.workers = 0;
+    g_pool.deque_count = 0;
+    atomic_store(&g_pool.started, false);
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+EXPORT int workpool_configure(int32_t threads, int32_t pin_cpus) {
+    NATIVE_STATS_SCOPE();
+    if (threads < 0 || threads > MAX_THREADS) {
+        return -1;
+    }
+    workpool_shutdown();
+
+    pthread_mutex_lock(&g_pool.lock);
+    g_pool.configured_threads = threads;
+    g_pool.configured_pin = pin_cpus != 0;
+    pthread_mutex_unlock(&g_pool.lock);
+    return 0;
+}
+
+EXPORT int32_t workpool_thread_count(void) {
+    NATIVE_STATS_SCOPE();
+    ensure_started();
+    return g_pool.workers + 1;
+}
+
+/* ============================================
+ * PARALLEL FOR
+ * ============================================ */
+
+static Deque* acquire_submit_deque(void) {
+    Deque* found = NULL;
+    pthread_mutex_lock(&g_pool.lock);
+    for (int32_t i = 0; i < MAX_SUBMITTERS && g_pool.deques; i++) {
+        Deque* dq = &g_pool.deques[g_pool.submit_base + i];
+        if (!dq->in_use) {
+            dq->in_use = true;
+            found = dq;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+    return found;
+}
+
+static void release_submit_deque(Deque* dq) {
+    pthread_mutex_lock(&g_pool.lock);
+    dq->in_use = false;
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+EXPORT int workpool_parallel_for(size_t begin, size_t end, size_t grain, WorkpoolRangeFn fn, void* ctx) {
+    NATIVE_STATS_SCOPE();
+    if (!fn) {
+        return -1;
+    }
+    if (end <= begin) {
+        return 0;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    /* Small batches and single-threaded pools run inline */
+    if (end - begin <= grain) {
+        fn(ctx, begin, end);
+        return 0;
+    }
+    ensure_started();
+    if (g_pool.workers == 0) {
+        fn(ctx, begin, end);
+        return 0;
+    }
+
+    Deque* self = tl_deque;
+    bool submitter = self == NULL;
+    if (submitter) {
+        self = acquire_submit_deque();
+        if (!self) {
+            /* More concurrent callers than submit slots: run serially */
+            fn(ctx, begin, end);
+            return 0;
+        }
+        tl_deque = self;
+    }
+
+    Job job = {fn, ctx, grain, end - begin};
+
+    /* Publish the batch, then wake sleepers (pairs with worker_main) */
+    atomic_fetch_add(&g_pool.active_jobs, 1);
+    if (atomic_load(&g_pool.sleeping) > 0) {
+        pthread_mutex_lock(&g_pool.lock);
+        pthread_cond_broadcast(&g_pool.wake);
+        pthread_mutex_unlock(&g_pool.lock);
+    }
+
+    run_task(self, (Task){begin, end, &job});
+
+    /* Help until every range is done, including ranges taken by thieves */
+    uint32_t rng = (uint32_t)(uintptr_t)&job | 1u;
+    int32_t idle = 0;
+    while (atomic_load_explicit(&job.remaining, memory_order_acquire) > 0) {
+        Task task;
+        if (deque_pop(self, &task) || steal_any(self, &rng, &task)) {
+            run_task(self, task);
+            idle = 0;
+        } else if (++idle < SPIN_ROUNDS) {
+            cpu_relax();
+        } else {
+            sched_yield();
+        }
+    }
+
+    atomic_fetch_sub(&g_pool.active_jobs, 1);
+
+    if (submitter) {
+        tl_deque = NULL;
+        release_submit_deque(self);
+    }
+    return 0;
+}
+
+#else /* __EMSCRIPTEN__ */
+
+/* ============================================
+ * SERIAL POOL (WebAssembly)
+ * ============================================ */
+
+#define MAX_THREADS 256
+
+EXPORT void workpool_shutdown(void) {
+    NATIVE_STATS_SCOPE();
+}
+
+EXPORT int workpool_configure(int32_t threads, int32_t pin_cpus) {
+    NATIVE_STATS_SCOPE();
+    (void)pin_cpus;
+    return threads < 0 || threads > MAX_THREADS ? -1 : 0;
+}
+
+EXPORT int32_t workpool_thread_count(void) {
+    NATIVE_STATS_SCOPE();
+    return 1;
+}
+
+EXPORT int workpool_parallel_for(size_t begin, size_t end, size_t grain, WorkpoolRangeFn fn, void* ctx) {
+    NATIVE_STATS_SCOPE();
+    (void)grain;
+    if (!fn) {
+        return -1;
+    }
+    if (end > begin) {
+        fn(ctx, begin, end);
+    }
+    return 0;
+}
+
+#endif /* __EMSCRIPTEN__ */
@@ -0,0 +1,58 @@
+/**
+ * Shared Work-Stealing Thread Pool
+ *
+ * One pool per process for every native library's batch APIs, so
+ * parallel batches never stack their own threads on top of libuv's.
+ * Started lazily on the first parallel batch.
+ *
+ * Environment (read at start):
+ * - MUSCLEMAP_NATIVE_THREADS: threads including the caller (default:
+ *   online CPUs minus UV_THREADPOOL_SIZE, or minus libuv's default of 4,
+ *   at least 1; 1 runs everything on the calling thread)
+ * - MUSCLEMAP_NATIVE_AFFINITY=1: pin worker i to CPU i
+ *
+ * WebAssembly builds have no threads: the pool is always one thread and
+ * every batch runs inline on the caller.
+ */
+
+#ifndef MUSCLEMAP_WORKPOOL_H
+#define MUSCLEMAP_WORKPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Processes items [begin, end) of a parallel_for */
+typedef void (*WorkpoolRangeFn)(void* ctx, size_t begin, size_t end);
+
+/**
+ * Set thread count and CPU pinning, overriding the environment
+ * Stops a running pool (must not race with parallel_for); it restarts
+ * with the new settings on next use.
+ *
+ * @param threads Threads including the caller; 0 = environment/default
+ * @param pin_cpus Nonzero pins worker i to CPU i
+ * @return 0 on success, -1 on error
+ */
+int workpool_configure(int32_t threads, int32_t pin_cpus);
+
+/**
+ * Threads available to parallel_for, including the caller
+ */
+int32_t workpool_thread_count(void);
+
+/**
+ * Run fn over [begin, end) in ranges of at most `grain` items
+ * Ranges are split lazily and stolen by idle workers; the caller works
+ * too and returns once every item is done. Ranges no larger than grain
+ * (or a pool of one thread) run inline on the caller.
+ *
+ * @return 0 on success, -1 on error
+ */
+int workpool_parallel_for(size_t begin, size_t end, size_t grain, WorkpoolRangeFn fn, void* ctx);
+
+/**
+ * Stop and join the workers (pool restarts on next use)
+ */
+void workpool_shutdown(void);
+
+#endif /* MUSCLEMAP_WORKPOOL_H */
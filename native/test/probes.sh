@@ -0,0 +1,104 @@
+#!/bin/sh
+#
+# USDT probe check
+#
+# Usage: sh test/probes.sh (from native/, after `make release`; or `make test-probes`)
+#
+# Verifies every documented probe is present in the built libraries and
+# the solver, with its argument count. When bpftrace is installed and the
+# script runs as root, it also attaches to ratelimit__verdict,
+# tu__batch__end and solve__end on live benchmark runs and checks that
+# they fire.
+#
+# Probes (provider "musclemap"):
+#
+#   library          probe                      arguments
+#   libratelimit     ratelimit__verdict         user_id (u64), count (u32),
+#                                               verdict (1 allowed, 0 limited,
+#                                               -1 table full), slots probed
+#   librank          rank__sort__start          users (size_t)
+#   librank          rank__sort__end            users sorted (size_t, 0 on failure)
+#   librank          rank__simple__sort__start  scores (size_t)
+#   librank          rank__simple__sort__end    scores sorted (size_t, 0 on failure)
+#   libtu            tu__batch__start           workouts (i32)
+#   libtu            tu__batch__end             workouts (i32), succeeded (i32)
+#   solver           solve__start               catalog exercises, time available (s)
+#   solver           solve__filtered            candidates after hard filters
+#   solver           solve__scored              candidates scored
+#   solver           solve__end                 exercises selected (0 on early exit)
+#
+# Example: rejections per second by probe depth
+#   bpftrace -e 'usdt:lib/libratelimit.so:musclemap:ratelimit__verdict /arg2 == 0/ { @[arg3] = count(); }
+#                interval:s:1 { print(@); clear(@); }' -p $(pgrep -f api)
+
+set -eu
+
+LIB_DIR=${LIB_DIR:-lib}
+BUILD_DIR=${BUILD_DIR:-build}
+
+failures=0
+
+# expect <file> <probe> <argument count>
+expect() {
+    notes=$(readelf -n "$1" 2>/dev/null | grep -A3 "Name: $2\$" || true)
+    if [ -z "$notes" ]; then
+        echo "FAIL $1: probe $2 missing"
+        failures=$((failures + 1))
+        return
+    fi
+    # Every copy of the probe (inlined sites) must carry the same arguments
+    counts=$(printf '%s\n' "$notes" | grep 'Arguments:' | sed 's/.*Arguments://' | awk '{ print NF }' | sort -u)
+    if [ "$counts" != "$3" ]; then
+        echo "FAIL $1: probe $2 has $counts argument(s), expected $3"
+        failures=$((failures + 1))
+        return
+    fi
+    echo "ok   $1: $2 ($3 args)"
+}
+
+if ! readelf -n "$LIB_DIR/libratelimit.so" 2>/dev/null | grep -q stapsdt; then
+    echo "No USDT notes in $LIB_DIR/libratelimit.so (probes compiled out on this platform?)"
+    exit 1
+fi
+
+expect "$LIB_DIR/libratelimit.so" ratelimit__verdict 4
+expect "$LIB_DIR/librank.so" rank__sort__start 1
+expect "$LIB_DIR/librank.so" rank__sort__end 1
+expect "$LIB_DIR/librank.so" rank__simple__sort__start 1
+expect "$LIB_DIR/librank.so" rank__simple__sort__end 1
+expect "$LIB_DIR/libtu.so" tu__batch__start 1
+expect "$LIB_DIR/libtu.so" tu__batch__end 2
+
+# The solver is a single translation unit; check it as linked into its bench suite
+SOLVER_BIN="$BUILD_DIR/bench/solver-suite"
+make --no-print-directory "$SOLVER_BIN" > /dev/null
+expect "$SOLVER_BIN" solve__start 2
+expect "$SOLVER_BIN" solve__filtered 1
+expect "$SOLVER_BIN" solve__scored 1
+expect "$SOLVER_BIN" solve__end 1
+
+# Live check with a real tracer, when one is available
+if command -v bpftrace > /dev/null 2>&1 && [ "$(id -u)" = 0 ]; then
+    make --no-print-directory "$BUILD_DIR/bench/ratelimit-bench" "$BUILD_DIR/bench/tu-bench" > /dev/null
+    for run in "ratelimit-bench $LIB_DIR/libratelimit.so ratelimit__verdict" \
+               "tu-bench $LIB_DIR/libtu.so tu__batch__end" \
+               "solver-suite $SOLVER_BIN solve__end"; do
+        set -- $run
+        hits=$(bpftrace -q -e "usdt:$2:musclemap:$3 { @hits = count(); }" \
+            -c "$BUILD_DIR/bench/$1 --reps 5 --warmup 1" 2>/dev/null | sed -n 's/^@hits: //p')
+        if [ "${hits:-0}" -gt 0 ]; then
+            echo "ok   bpftrace: $3 fired $hits times"
+        else
+            echo "FAIL bpftrace: $3 did not fire"
+            failures=$((failures + 1))
+        fi
+    done
+else
+    echo "skip live attach (needs bpftrace and root)"
+fi
+
+if [ "$failures" -gt 0 ]; then
+    echo "$failures probe check(s) failed"
+    exit 1
+fi
+echo "All probes present"
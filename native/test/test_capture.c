@@ -0,0 +1,155 @@
+/**
+ * libnativecapture ring test (run by `make test`)
+ *
+ * Writer threads record calls with self-checking arguments into a
+ * minimum-size ring, wrapping it many times over, while a reader takes
+ * records off the live mapping the way tools/replay.c does. Every record
+ * either reader accepts must be whole: one call's time, op, thread and
+ * arguments, never a mix of two.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../src/capture/native_capture.h"
+
+#define WRITERS 6
+#define CALLS 50000
+#define RING_PATH "build/test_capture.bin"
+
+static _Atomic int g_writing;
+static _Atomic uint64_t g_bad;
+
+/**
+ * Argument bytes derived from the record's identity
+ */
+static uint8_t arg_byte(uint64_t id, size_t i) {
+    return (uint8_t)((id * 0x9E3779B97F4A7C15ull) >> (8 * (i % 8))) ^ (uint8_t)i;
+}
+
+static void* writer(void* arg) {
+    uint64_t thread = (uint64_t)(uintptr_t)arg;
+    for (uint64_t i = 0; i < CALLS; i++) {
+        NativeCaptureRecord local;
+        NativeCaptureRecord* record = native_capture_begin(NATIVE_CAPTURE_RANK_FULL_RANKING, &local);
+        if (!record) {
+            continue;
+        }
+        /* Half the arguments, then (for some calls) long enough for the
+         * ring to wrap, then the rest */
+        uint64_t id = (thread << 32) | i;
+        memcpy(record->args, &id, sizeof(id));
+        for (size_t b = sizeof(uint64_t); b < NATIVE_CAPTURE_ARGS_LEN / 2; b++) {
+            record->args[b] = arg_byte(id, b);
+        }
+        if ((i & 255) == 0) {
+            usleep(200);
+        }
+        for (size_t b = NATIVE_CAPTURE_ARGS_LEN / 2; b < NATIVE_CAPTURE_ARGS_LEN; b++) {
+            record->args[b] = arg_byte(id, b);
+        }
+        record->flags = (uint32_t)(id & 0xffff);
+        native_capture_end(record);
+    }
+    return NULL;
+}
+
+/**
+ * Whether a record holds exactly one call's data
+ */
+static int record_whole(const NativeCaptureRecord* record) {
+    uint64_t id;
+    memcpy(&id, record->args, sizeof(id));
+    if (record->op != NATIVE_CAPTURE_RANK_FULL_RANKING || record->flags != (uint32_t)(id & 0xffff) ||
+        (id >> 32) >= WRITERS) {
+        return 0;
+    }
+    for (size_t b = sizeof(uint64_t); b < NATIVE_CAPTURE_ARGS_LEN; b++) {
+        if (record->args[b] != arg_byte(id, b)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Take the ring's published records as replay does; returns how many
+ */
+static uint64_t read_ring(const NativeCaptureHeader* header) {
+    const NativeCaptureRecord* ring = (const NativeCaptureRecord*)(header + 1);
+    uint64_t taken = 0;
+    for (uint64_t slot = 0; slot < header->capacity; slot++) {
+        uint64_t sequence = atomic_load_explicit(&ring[slot].sequence, memory_order_acquire);
+        if (sequence == 0 || (sequence & NATIVE_CAPTURE_PENDING) ||
+            ((sequence - 1) & (header->capacity - 1)) != slot) {
+            continue;
+        }
+        NativeCaptureRecord copy;
+        memcpy(&copy, &ring[slot], sizeof(copy));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&ring[slot].sequence, memory_order_relaxed) != sequence) {
+            continue;
+        }
+        if (!record_whole(&copy)) {
+            atomic_fetch_add(&g_bad, 1);
+        }
+        taken++;
+    }
+    return taken;
+}
+
+static void* reader(void* arg) {
+    const NativeCaptureHeader* header = arg;
+    while (atomic_load(&g_writing)) {
+        read_ring(header);
+    }
+    return NULL;
+}
+
+int main(void) {
+    if (native_capture_start(RING_PATH, 1, NATIVE_CAPTURE_MIN_RECORDS - 1) == 0) {
+        printf("ring below NATIVE_CAPTURE_MIN_RECORDS accepted\n");
+        return 1;
+    }
+    if (native_capture_start(RING_PATH, 1, NATIVE_CAPTURE_MIN_RECORDS) != 0) {
+        printf("cannot start capture to %s\n", RING_PATH);
+        return 1;
+    }
+
+    int fd = open(RING_PATH, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) return 1;
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return 1;
+
+    atomic_store(&g_writing, 1);
+    pthread_t read_thread, threads[WRITERS];
+    pthread_create(&read_thread, NULL, reader, base);
+    for (uintptr_t t = 0; t < WRITERS; t++) {
+        pthread_create(&threads[t], NULL, writer, (void*)t);
+    }
+    for (int t = 0; t < WRITERS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    atomic_store(&g_writing, 0);
+    pthread_join(read_thread, NULL);
+
+    uint64_t captured = native_capture_stop();
+    uint64_t kept = read_ring(base);
+    munmap(base, (size_t)st.st_size);
+    unlink(RING_PATH);
+
+    printf("Capture: %llu calls into a %d-record ring, %llu kept, %llu torn\n",
+           (unsigned long long)captured, NATIVE_CAPTURE_MIN_RECORDS, (unsigned long long)kept,
+           (unsigned long long)atomic_load(&g_bad));
+    if (captured != (uint64_t)WRITERS * CALLS || kept == 0 || atomic_load(&g_bad) != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,25 @@
+/**
+ * libgeo smoke test (run by `make test`)
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/geo/geohash.h"
+
+int main(void) {
+    char hash[13];
+    double lat, lng;
+    if (geohash_encode(40.7128, -74.0060, 9, hash) != 9) return 1;
+    printf("NYC geohash (9): %s\n", hash);
+    if (geohash_decode(hash, &lat, &lng) != 0) return 1;
+    printf("Decoded: %.4f, %.4f\n", lat, lng);
+    double dist = haversine_meters(40.7128, -74.0060, 34.0522, -118.2437);
+    printf("NYC to LA: %.0f meters\n", dist);
+
+    double points[] = {34.0522, -118.2437, 40.7128, -74.0060};
+    double batch[2];
+    if (haversine_batch(40.7128, -74.0060, points, 2, batch) != 0) return 1;
+    if (batch[0] != dist || batch[1] != 0.0) return 1;
+    return 0;
+}
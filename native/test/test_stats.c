@@ -0,0 +1,158 @@
+/**
+ * libnativestats stress test (run by `make test`; `make test-tsan` runs
+ * it under ThreadSanitizer)
+ *
+ * Rounds of short-lived threads record calls on a few sites while other
+ * threads take snapshots, so threads attach, fold into the retired block
+ * on exit and are read mid-record. A second pass resets concurrently.
+ * Without resets every call must be counted exactly once; snapshots
+ * taken during a run must never go backwards or report percentiles out
+ * of order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../src/stats/native_stats.h"
+
+#define ROUNDS 6
+#define WRITERS 8
+#define CALLS 20000
+
+static int g_failures;
+static _Atomic int g_running;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL " __VA_ARGS__); \
+        printf("\n"); \
+        g_failures++; \
+    } \
+} while (0)
+
+/* Instrumented functions (the volatile sink keeps the bodies) */
+static _Thread_local volatile uint64_t g_sink;
+
+__attribute__((noinline)) static void stats_site_short(void) {
+    NATIVE_STATS_SCOPE();
+    g_sink++;
+}
+
+__attribute__((noinline)) static void stats_site_long(void) {
+    NATIVE_STATS_SCOPE();
+    for (int i = 0; i < 200; i++) g_sink++;
+}
+
+__attribute__((noinline)) static void stats_site_rare(void) {
+    NATIVE_STATS_SCOPE();
+}
+
+/**
+ * Calls recorded for a site in a snapshot (0 if absent)
+ */
+static uint64_t calls_of(const NativeStatsEntry* entries, int32_t count, const char* name) {
+    for (int32_t i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) return entries[i].calls;
+    }
+    return 0;
+}
+
+static void* writer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < CALLS; i++) {
+        stats_site_short();
+        if (i % 2 == 0) stats_site_long();
+        if (i % 1000 == 0) stats_site_rare();
+    }
+    return NULL;
+}
+
+/* Snapshots while writers run; calls only grow unless `resets` is set */
+static void* reader(void* arg) {
+    int resets = *(int*)arg;
+    NativeStatsEntry* entries = malloc(NATIVE_STATS_MAX_SITES * sizeof(NativeStatsEntry));
+    if (!entries) return NULL;
+    uint64_t last = 0;
+    while (atomic_load(&g_running)) {
+        int32_t count = native_stats_snapshot(entries, NATIVE_STATS_MAX_SITES);
+        for (int32_t i = 0; i < count && i < NATIVE_STATS_MAX_SITES; i++) {
+            const NativeStatsEntry* e = &entries[i];
+            uint64_t counted = 0;
+            for (int32_t b = 0; b < NATIVE_STATS_BUCKETS; b++) counted += e->buckets[b];
+            CHECK(counted == e->calls, "%s: %llu calls but %llu in the histogram", e->name,
+                  (unsigned long long)e->calls, (unsigned long long)counted);
+            CHECK(e->p50_ns <= e->p90_ns && e->p90_ns <= e->p99_ns && e->p99_ns <= e->max_ns,
+                  "%s: percentiles out of order", e->name);
+        }
+        uint64_t now = calls_of(entries, count < NATIVE_STATS_MAX_SITES ? count : NATIVE_STATS_MAX_SITES,
+                                "stats_site_short");
+        if (!resets) {
+            CHECK(now >= last, "snapshot went from %llu to %llu calls", (unsigned long long)last,
+                  (unsigned long long)now);
+            last = now;
+        }
+        if (resets) native_stats_reset();
+    }
+    free(entries);
+    return NULL;
+}
+
+static void run_rounds(int resets) {
+    pthread_t read_threads[2];
+    atomic_store(&g_running, 1);
+    for (int r = 0; r < 2; r++) {
+        pthread_create(&read_threads[r], NULL, reader, &resets);
+    }
+    for (int round = 0; round < ROUNDS; round++) {
+        pthread_t threads[WRITERS];
+        for (int t = 0; t < WRITERS; t++) {
+            pthread_create(&threads[t], NULL, writer, NULL);
+        }
+        for (int t = 0; t < WRITERS; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    atomic_store(&g_running, 0);
+    for (int r = 0; r < 2; r++) {
+        pthread_join(read_threads[r], NULL);
+    }
+}
+
+int main(void) {
+    CHECK(native_stats_enabled(), "built without MUSCLEMAP_NATIVE_STATS");
+
+    /* Exact counts: every writer thread has exited, so all of them come
+     * from the retired block */
+    run_rounds(0);
+    NativeStatsEntry entries[NATIVE_STATS_MAX_SITES];
+    int32_t count = native_stats_snapshot(entries, NATIVE_STATS_MAX_SITES);
+    uint64_t expected = (uint64_t)ROUNDS * WRITERS * CALLS;
+    CHECK(calls_of(entries, count, "stats_site_short") == expected, "short: %llu calls, expected %llu",
+          (unsigned long long)calls_of(entries, count, "stats_site_short"), (unsigned long long)expected);
+    CHECK(calls_of(entries, count, "stats_site_long") == expected / 2, "long: %llu calls, expected %llu",
+          (unsigned long long)calls_of(entries, count, "stats_site_long"), (unsigned long long)expected / 2);
+    CHECK(calls_of(entries, count, "stats_site_rare") == (uint64_t)ROUNDS * WRITERS * (CALLS / 1000),
+          "rare: %llu calls", (unsigned long long)calls_of(entries, count, "stats_site_rare"));
+
+    /* Resets racing with records and snapshots, then exact counts again */
+    run_rounds(1);
+    native_stats_reset();
+    count = native_stats_snapshot(entries, NATIVE_STATS_MAX_SITES);
+    CHECK(count == 0, "%d sites have calls after a reset", count);
+
+    /* This thread keeps its buffer across the reset: its rows are
+     * cleared on its next call, not folded */
+    for (int i = 0; i < 1000; i++) stats_site_short();
+    run_rounds(0);
+    count = native_stats_snapshot(entries, NATIVE_STATS_MAX_SITES);
+    CHECK(calls_of(entries, count, "stats_site_short") == expected + 1000, "short after reset: %llu calls",
+          (unsigned long long)calls_of(entries, count, "stats_site_short"));
+
+    printf("Stats: %d threads x %d rounds, %llu calls per site counted\n", WRITERS, ROUNDS,
+           (unsigned long long)expected);
+    return g_failures == 0 ? 0 : 1;
+}
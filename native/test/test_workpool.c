@@ -0,0 +1,299 @@
+/**
+ * libworkpool test (run by `make test`; `make test-tsan` runs it under
+ * ThreadSanitizer)
+ *
+ * - Concurrent submitters, more than there are submit deques, so some
+ *   batches take the serial fallback
+ * - Nested parallel_for from inside a task
+ * - Pools of one thread and pools whose worker threads fail to start
+ *   (pthread_create is interposed below)
+ * - rank_full_ranking above PARALLEL_SORT_MIN against a qsort reference
+ * - tu_calculate_batch against tu_calculate per workout
+ *
+ * Every item of every batch must run exactly once, and the library
+ * results must not depend on the pool size.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include "../src/workpool/workpool.h"
+#include "../src/rank/rank_calculator.h"
+#include "../src/workout/tu_calculator.h"
+
+#define SUBMITTERS 40                 /* More than the pool's 32 submit deques */
+#define SUBMIT_BATCHES 20
+#define SUBMIT_ITEMS 5000
+#define NESTED_OUTER 64
+#define NESTED_INNER 1000
+#define RANK_USERS 100000             /* Above PARALLEL_SORT_MIN */
+#define TU_EXERCISES 200
+#define TU_MUSCLES 40
+#define TU_WORKOUTS 3000
+
+static int g_failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL " __VA_ARGS__); \
+        printf("\n"); \
+        g_failures++; \
+    } \
+} while (0)
+
+/* ============================================
+ * THREAD START FAILURES
+ * ============================================ */
+
+/* Threads pthread_create may still start; -1 = no limit */
+static _Atomic int g_spawn_budget = -1;
+
+int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*start)(void*), void* arg) {
+    static int (*real_create)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+    if (!real_create) {
+        *(void**)&real_create = dlsym(RTLD_NEXT, "pthread_create");
+    }
+    int budget = atomic_load(&g_spawn_budget);
+    while (budget >= 0) {
+        if (budget == 0) {
+            return EAGAIN;
+        }
+        if (atomic_compare_exchange_weak(&g_spawn_budget, &budget, budget - 1)) {
+            break;
+        }
+    }
+    return real_create(thread, attr, start, arg);
+}
+
+static uint32_t xorshift(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* ============================================
+ * PARALLEL FOR
+ * ============================================ */
+
+typedef struct {
+    _Atomic uint8_t* runs;
+    size_t offset;
+} Counter;
+
+static void count_range(void* ctx, size_t begin, size_t end) {
+    Counter* counter = ctx;
+    for (size_t i = begin; i < end; i++) {
+        atomic_fetch_add_explicit(&counter->runs[counter->offset + i], 1, memory_order_relaxed);
+    }
+}
+
+static size_t count_wrong(_Atomic uint8_t* runs, size_t count) {
+    size_t wrong = 0;
+    for (size_t i = 0; i < count; i++) {
+        wrong += atomic_load_explicit(&runs[i], memory_order_relaxed) != 1;
+    }
+    return wrong;
+}
+
+static void* submitter(void* arg) {
+    size_t* wrong = arg;
+    _Atomic uint8_t* runs = malloc(SUBMIT_ITEMS);
+    if (!runs) {
+        *wrong = SUBMIT_ITEMS;
+        return NULL;
+    }
+    for (int b = 0; b < SUBMIT_BATCHES; b++) {
+        memset((void*)runs, 0, SUBMIT_ITEMS);
+        Counter counter = {runs, 0};
+        if (workpool_parallel_for(0, SUBMIT_ITEMS, 16, count_range, &counter) != 0) {
+            *wrong += SUBMIT_ITEMS;
+        }
+        *wrong += count_wrong(runs, SUBMIT_ITEMS);
+    }
+    free((void*)runs);
+    return NULL;
+}
+
+static void test_concurrent_submitters(const char* pool) {
+    pthread_t threads[SUBMITTERS];
+    size_t wrong[SUBMITTERS] = {0};
+    int started = 0;
+    for (int t = 0; t < SUBMITTERS; t++) {
+        if (pthread_create(&threads[t], NULL, submitter, &wrong[t]) != 0) break;
+        started++;
+    }
+    size_t total = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        total += wrong[t];
+    }
+    CHECK(started == SUBMITTERS, "%s: started %d of %d submitters", pool, started, SUBMITTERS);
+    CHECK(total == 0, "%s: concurrent submitters ran %zu items other than once", pool, total);
+}
+
+static void nested_range(void* ctx, size_t begin, size_t end) {
+    _Atomic uint8_t* runs = ctx;
+    for (size_t i = begin; i < end; i++) {
+        Counter counter = {runs, i * NESTED_INNER};
+        workpool_parallel_for(0, NESTED_INNER, 8, count_range, &counter);
+    }
+}
+
+static void test_nested(const char* pool) {
+    size_t count = (size_t)NESTED_OUTER * NESTED_INNER;
+    _Atomic uint8_t* runs = calloc(count, 1);
+    if (!runs) return;
+    workpool_parallel_for(0, NESTED_OUTER, 1, nested_range, (void*)runs);
+    size_t wrong = count_wrong(runs, count);
+    CHECK(wrong == 0, "%s: nested parallel_for ran %zu items other than once", pool, wrong);
+    free((void*)runs);
+}
+
+/* ============================================
+ * LIBRARY RESULTS
+ * ============================================ */
+
+static int compare_desc(const void* a, const void* b) {
+    const RankedUser* x = a;
+    const RankedUser* y = b;
+    if (x->score != y->score) return x->score < y->score ? 1 : -1;
+    return strcmp(x->user_id, y->user_id);
+}
+
+static size_t user_number(const RankedUser* user) {
+    return (size_t)strtoul(user->user_id + 5, NULL, 10);
+}
+
+static void test_rank(const char* pool) {
+    RankedUser* users = calloc(RANK_USERS, sizeof(RankedUser));
+    RankedUser* expected = calloc(RANK_USERS, sizeof(RankedUser));
+    RankedUser* by_user = calloc(RANK_USERS, sizeof(RankedUser));
+    if (!users || !expected || !by_user) return;
+
+    /* Few distinct scores, so most users tie */
+    uint32_t rng = 12345;
+    for (size_t i = 0; i < RANK_USERS; i++) {
+        snprintf(users[i].user_id, USER_ID_LEN, "user-%zu", i);
+        users[i].score = (double)(xorshift(&rng) % 5000) / 4.0;
+    }
+    memcpy(expected, users, RANK_USERS * sizeof(RankedUser));
+    qsort(expected, RANK_USERS, sizeof(RankedUser), compare_desc);
+    rank_assign_ranks(expected, RANK_USERS);
+    rank_calculate_percentiles(expected, RANK_USERS);
+
+    CHECK(rank_full_ranking(users, RANK_USERS) == 0, "%s: rank_full_ranking failed", pool);
+    size_t wrong = 0;
+    for (size_t i = 0; i < RANK_USERS; i++) {
+        wrong += users[i].score != expected[i].score;
+        by_user[user_number(&users[i])] = users[i];
+    }
+    for (size_t i = 0; i < RANK_USERS; i++) {
+        const RankedUser* got = &by_user[user_number(&expected[i])];
+        wrong += strcmp(got->user_id, expected[i].user_id) != 0 || got->rank != expected[i].rank ||
+                 got->percentile != expected[i].percentile;
+    }
+    CHECK(wrong == 0, "%s: rank_full_ranking differs from the serial sort in %zu places", pool, wrong);
+
+    free(users);
+    free(expected);
+    free(by_user);
+}
+
+static void setup_tu(void) {
+    tu_init();
+    uint32_t rng = 777;
+    char id[32];
+    for (int m = 0; m < TU_MUSCLES; m++) {
+        snprintf(id, sizeof(id), "muscle-%d", m);
+        tu_add_muscle(id, 0.5f + (float)(xorshift(&rng) % 100) / 100.0f);
+    }
+    for (int e = 0; e < TU_EXERCISES; e++) {
+        float activations[TU_MUSCLES] = {0};
+        for (int k = 0; k < 6; k++) {
+            activations[xorshift(&rng) % TU_MUSCLES] = (float)(xorshift(&rng) % 100);
+        }
+        snprintf(id, sizeof(id), "exercise-%d", e);
+        tu_add_exercise(id, activations, TU_MUSCLES);
+    }
+}
+
+static void test_tu(const char* pool) {
+    WorkoutExerciseInput* inputs = calloc((size_t)TU_WORKOUTS * 12, sizeof(WorkoutExerciseInput));
+    const WorkoutExerciseInput** workouts = calloc(TU_WORKOUTS, sizeof(*workouts));
+    int32_t* counts = calloc(TU_WORKOUTS, sizeof(int32_t));
+    TUResult* batch = malloc(TU_WORKOUTS * sizeof(TUResult));
+    TUResult* single = malloc(TU_WORKOUTS * sizeof(TUResult));
+    if (!inputs || !workouts || !counts || !batch || !single) return;
+
+    /* Some workouts are empty or name an unknown exercise, and fail */
+    uint32_t rng = 4242;
+    int32_t expected_success = 0;
+    for (int w = 0; w < TU_WORKOUTS; w++) {
+        workouts[w] = inputs + w * 12;
+        counts[w] = (int32_t)(xorshift(&rng) % 13);
+        for (int e = 0; e < counts[w]; e++) {
+            WorkoutExerciseInput* in = &inputs[w * 12 + e];
+            in->exercise_index = (int32_t)(xorshift(&rng) % (TU_EXERCISES + 2)) - 1;
+            in->sets = (int32_t)(xorshift(&rng) % 6);
+            in->reps = (int32_t)(xorshift(&rng) % 15);
+            in->weight = (float)(xorshift(&rng) % 200);
+        }
+    }
+
+    memset(batch, 0x5a, TU_WORKOUTS * sizeof(TUResult));
+    memset(single, 0x5a, TU_WORKOUTS * sizeof(TUResult));
+    for (int w = 0; w < TU_WORKOUTS; w++) {
+        expected_success += tu_calculate(workouts[w], counts[w], &single[w]) == 0;
+    }
+    int success = tu_calculate_batch(workouts, counts, TU_WORKOUTS, batch);
+
+    int wrong = 0;
+    for (int w = 0; w < TU_WORKOUTS; w++) {
+        wrong += memcmp(&batch[w], &single[w], sizeof(TUResult)) != 0;
+    }
+    CHECK(success == expected_success, "%s: tu_calculate_batch succeeded %d times, tu_calculate %d",
+          pool, success, expected_success);
+    CHECK(wrong == 0, "%s: tu_calculate_batch differs from tu_calculate in %d workouts", pool, wrong);
+
+    free(inputs);
+    free((void*)workouts);
+    free(counts);
+    free(batch);
+    free(single);
+}
+
+/* ============================================
+ * POOLS
+ * ============================================ */
+
+static void run_pool(const char* pool, int32_t threads, int spawn_budget, int32_t expected_threads) {
+    atomic_store(&g_spawn_budget, spawn_budget);
+    workpool_configure(threads, 0);
+    int32_t running = workpool_thread_count();
+    atomic_store(&g_spawn_budget, -1);
+    CHECK(running == expected_threads, "%s: %d threads running, expected %d", pool, running, expected_threads);
+
+    test_concurrent_submitters(pool);
+    test_nested(pool);
+    test_rank(pool);
+    test_tu(pool);
+    printf("Workpool: %s (%d threads) done\n", pool, running);
+}
+
+int main(void) {
+    setup_tu();
+    run_pool("pool of 4", 4, -1, 4);
+    run_pool("pool of 1", 1, -1, 1);
+    run_pool("pool of 8, 2 workers started", 8, 2, 3);
+    run_pool("pool of 8, no workers started", 8, 0, 1);
+    workpool_shutdown();
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,304 @@
+#!/usr/bin/env node
+/**
+ * WebAssembly build vs native addon
+ *
+ * Usage: node test/wasm.mjs [iterations] (from native/; or `make test-wasm`)
+ *
+ * Runs the same seeded inputs through the N-API addon
+ * (build/Release/musclemap_native.node) and the wasm module
+ * (lib/wasm/musclemap-wasm.mjs), both with lib/catalog.bin loaded, and
+ * compares results bit for bit:
+ *
+ * - geohash encode/decode/neighbors/precision error, bounding box
+ *   latitudes, optimal precision and every TU result must be identical
+ * - haversine distances and bounding box longitudes also call sin, cos
+ *   and atan2, which come from glibc natively and from musl in wasm; both
+ *   are accurate to under an ulp but not always to the same bit, so these
+ *   report how many match exactly and fail beyond MAX_ULP
+ *
+ * Then prints addon and wasm throughput for the same calls.
+ *
+ * Build first: npm run build:addon && make wasm catalog
+ */
+
+import fs from 'fs';
+import path from 'path';
+import { createRequire } from 'module';
+import { fileURLToPath, pathToFileURL } from 'url';
+
+const ROOT = path.resolve(path.dirname(fileURLToPath(import.meta.url)), '..');
+const ITERATIONS = Number(process.argv[2]) || 100000;
+const CASES = 20000;
+const BATCH = 1024;
+const MAX_ULP = 4;
+
+const f64 = new Float64Array(1);
+const f64Bits = new BigInt64Array(f64.buffer);
+const f32 = new Float32Array(1);
+const f32Bits = new Int32Array(f32.buffer);
+
+function bits64(x) {
+  f64[0] = x;
+  return f64Bits[0];
+}
+
+function bits32(x) {
+  f32[0] = x;
+  return f32Bits[0];
+}
+
+/**
+ * Distance in units in the last place (same-sign finite doubles)
+ */
+function ulps(a, b) {
+  const d = bits64(a) - bits64(b);
+  return Number(d < 0n ? -d : d);
+}
+
+/**
+ * Deterministic inputs (mulberry32), so failures reproduce
+ */
+function random(seed) {
+  return () => {
+    seed = (seed + 0x6d2b79f5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+let failures = 0;
+
+function check(name, ok, detail) {
+  if (!ok) {
+    failures++;
+    if (failures <= 20) console.log(`  FAIL ${name}: ${detail}`);
+  }
+}
+
+function sameDouble(name, a, b) {
+  check(name, bits64(a) === bits64(b), `${a} vs ${b}`);
+}
+
+function sameFloats(name, a, b) {
+  const length = Math.max(a.length, b.length);
+  for (let i = 0; i < length; i++) {
+    if (bits32(a[i]) !== bits32(b[i])) {
+      check(name, false, `[${i}] ${a[i]} vs ${b[i]}`);
+      return;
+    }
+  }
+}
+
+/**
+ * Libm-bound results: count exact matches, fail beyond MAX_ULP
+ */
+function libmTally() {
+  const tally = { exact: 0, total: 0, maxUlp: 0 };
+  tally.add = (name, a, b) => {
+    const d = ulps(a, b);
+    tally.total++;
+    if (d === 0) tally.exact++;
+    tally.maxUlp = Math.max(tally.maxUlp, d);
+    check(name, d <= MAX_ULP, `${a} vs ${b} (${d} ulp)`);
+  };
+  return tally;
+}
+
+function checkGeo(addon, wasm) {
+  const rand = random(1);
+  const distances = libmTally();
+  const boxLng = libmTally();
+
+  for (let i = 0; i < CASES; i++) {
+    const lat = rand() * 180 - 90;
+    const lng = rand() * 360 - 180;
+    const lat2 = lat + (rand() - 0.5) * 2;
+    const lng2 = lng + (rand() - 0.5) * 2;
+    const precision = 1 + (i % 12);
+    const radius = rand() * 200000;
+
+    const hash = addon.geohashEncode(lat, lng, precision);
+    check('geohashEncode', hash === wasm.geohashEncode(lat, lng, precision), `${lat},${lng}@${precision}`);
+
+    const a = addon.geohashDecode(hash);
+    const b = wasm.geohashDecode(hash);
+    sameDouble('geohashDecode lat', a.lat, b.lat);
+    sameDouble('geohashDecode lng', a.lng, b.lng);
+
+    check('geohashNeighbors', addon.geohashNeighbors(hash).join() === wasm.geohashNeighbors(hash).join(), hash);
+
+    const boxA = addon.boundingBox(lat, lng, radius);
+    const boxB = wasm.boundingBox(lat, lng, radius);
+    sameDouble('boundingBox minLat', boxA.minLat, boxB.minLat);
+    sameDouble('boundingBox maxLat', boxA.maxLat, boxB.maxLat);
+    boxLng.add('boundingBox minLng', boxA.minLng, boxB.minLng);
+    boxLng.add('boundingBox maxLng', boxA.maxLng, boxB.maxLng);
+
+    check('optimalPrecision', addon.optimalPrecision(radius) === wasm.optimalPrecision(radius), `${radius}`);
+    distances.add('haversineMeters', addon.haversineMeters(lat, lng, lat2, lng2), wasm.haversineMeters(lat, lng, lat2, lng2));
+  }
+
+  for (let p = -1; p <= 13; p++) {
+    const a = addon.geohashPrecisionError(p);
+    const b = wasm.geohashPrecisionError(p);
+    check('geohashPrecisionError', (a === null) === (b === null), `precision ${p}`);
+    if (a && b) {
+      sameDouble('geohashPrecisionError latErr', a.latErr, b.latErr);
+      sameDouble('geohashPrecisionError lngErr', a.lngErr, b.lngErr);
+    }
+  }
+  for (const hash of ['', 'a', 'u4pruydqqvjx', 'u4pruydqqvjxy', 'zzzzzzzzzzzz', '000000000000']) {
+    check('geohashDecode invalid', JSON.stringify(addon.geohashDecode(hash)) === JSON.stringify(wasm.geohashDecode(hash)), hash);
+    check('geohashNeighbors invalid', JSON.stringify(addon.geohashNeighbors(hash)) === JSON.stringify(wasm.geohashNeighbors(hash)), hash);
+  }
+
+  // Odd batch sizes cover the SIMD128 kernel's scalar tail
+  const points = new Float64Array((BATCH + 1) * 2);
+  for (let i = 0; i < points.length; i++) points[i] = i % 2 ? rand() * 360 - 180 : rand() * 180 - 90;
+  for (const count of [0, 1, 2, 3, BATCH + 1]) {
+    const slice = points.subarray(0, count * 2);
+    const a = addon.haversineBatch(40.7, -74.0, slice);
+    const b = wasm.haversineBatch(40.7, -74.0, slice);
+    check('haversineBatch length', a.length === b.length, `${a.length} vs ${b.length}`);
+    for (let i = 0; i < a.length; i++) {
+      distances.add('haversineBatch', a[i], b[i]);
+      sameDouble('haversineBatch vs haversineMeters (wasm)', b[i],
+                 wasm.haversineMeters(40.7, -74.0, slice[2 * i], slice[2 * i + 1]));
+    }
+  }
+
+  return { distances, boxLng };
+}
+
+function checkTu(addon, wasm, catalog) {
+  const rand = random(2);
+  const exercises = addon.tuLoadCatalog(catalog);
+  check('tuLoadCatalog', exercises === wasm.tuLoadCatalog(fs.readFileSync(catalog)), `${exercises} exercises`);
+  check('tuGetStats', JSON.stringify(addon.tuGetStats()) === JSON.stringify(wasm.tuGetStats()), 'stats differ');
+
+  // Workouts of 1-50 exercises, with the occasional invalid index or set count
+  const workouts = [];
+  for (let w = 0; w < 2000; w++) {
+    const length = 1 + Math.floor(rand() * 50);
+    const workout = [];
+    for (let e = 0; e < length; e++) {
+      const invalid = rand() < 0.002;
+      workout.push({
+        exerciseIndex: invalid ? exercises + 3 : Math.floor(rand() * exercises),
+        sets: invalid && rand() < 0.5 ? -1 : 1 + Math.floor(rand() * 6),
+        reps: 5 + Math.floor(rand() * 10),
+      });
+    }
+    workouts.push(workout);
+  }
+
+  for (const workout of workouts) {
+    const a = addon.tuCalculate(workout);
+    const b = wasm.tuCalculate(workout);
+    check('tuCalculate null', (a === null) === (b === null), JSON.stringify(workout));
+    if (a && b) {
+      check('tuCalculate totalTu', bits32(a.totalTu) === bits32(b.totalTu), `${a.totalTu} vs ${b.totalTu}`);
+      sameFloats('tuCalculate muscleActivations', a.muscleActivations, b.muscleActivations);
+    }
+  }
+
+  const { packed, offsets } = packWorkouts(workouts);
+  sameFloats('tuCalculateBatch', addon.tuCalculateBatch(packed, offsets), wasm.tuCalculateBatch(packed, offsets));
+
+  // Unaligned muscle counts cover the SIMD128 kernel's scalar tail
+  for (const muscles of [1, 3, 17, 64]) {
+    const count = 40;
+    const activations = new Float32Array(count * muscles);
+    for (let i = 0; i < activations.length; i++) activations[i] = rand() < 0.1 ? -rand() * 10 : rand() * 100;
+    const sets = Int32Array.from({ length: count }, () => Math.floor(rand() * 6));
+    const bias = Float32Array.from({ length: muscles }, () => 0.5 + rand());
+    const a = addon.tuCalculateSimple(activations, sets, bias, count, muscles);
+    const b = wasm.tuCalculateSimple(activations, sets, bias, count, muscles);
+    check('tuCalculateSimple', bits32(a) === bits32(b), `${muscles} muscles: ${a} vs ${b}`);
+  }
+
+  return workouts;
+}
+
+function packWorkouts(workouts) {
+  const offsets = new Int32Array(workouts.length + 1);
+  workouts.forEach((workout, w) => { offsets[w + 1] = offsets[w] + workout.length; });
+  const packed = new Int32Array(offsets[workouts.length] * 2);
+  let i = 0;
+  for (const workout of workouts) {
+    for (const ex of workout) {
+      packed[i++] = ex.exerciseIndex;
+      packed[i++] = ex.sets;
+    }
+  }
+  return { packed, offsets };
+}
+
+/**
+ * Run fn `iterations` times after a short warmup; returns ns per call
+ */
+function time(fn, iterations) {
+  for (let i = 0; i < Math.min(iterations, 10000); i++) fn(i);
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < iterations; i++) fn(i);
+  return Number(process.hrtime.bigint() - start) / iterations;
+}
+
+function throughput(addon, wasm, workouts) {
+  const coords = new Float64Array(BATCH * 2);
+  for (let i = 0; i < BATCH; i++) {
+    coords[2 * i] = -60 + ((i * 37) % 120);
+    coords[2 * i + 1] = -170 + ((i * 53) % 340);
+  }
+  const distances = new Float64Array(BATCH);
+  const batch = workouts.slice(0, 256);
+  const { packed, offsets } = packWorkouts(batch);
+  const totals = new Float32Array(batch.length);
+  const batchIterations = Math.max(1, Math.floor(ITERATIONS / BATCH));
+
+  const cases = [
+    ['geohashEncode', 'call', ITERATIONS, 1, (lib) => (i) => lib.geohashEncode(coords[(i % BATCH) * 2], coords[(i % BATCH) * 2 + 1], 9)],
+    ['haversineMeters', 'call', ITERATIONS, 1, (lib) => (i) => lib.haversineMeters(40.7, -74.0, coords[(i % BATCH) * 2], coords[(i % BATCH) * 2 + 1])],
+    ['haversineBatch', 'point', batchIterations, BATCH, (lib) => () => lib.haversineBatch(40.7, -74.0, coords, distances)],
+    ['tuCalculate', 'call', ITERATIONS / 10, 1, (lib) => (i) => lib.tuCalculate(workouts[i % workouts.length])],
+    ['tuCalculateBatch', 'workout', Math.max(1, ITERATIONS / 2560), batch.length, (lib) => () => lib.tuCalculateBatch(packed, offsets, totals)],
+  ];
+
+  console.log(`\nthroughput (${ITERATIONS} iterations; wasm ISA: ${wasm.tuActiveIsa()})`);
+  console.log(`${'ns/op'.padEnd(28)}${'addon'.padStart(10)}${'wasm'.padStart(10)}${'wasm/addon'.padStart(12)}`);
+  for (const [name, unit, iterations, per, bind] of cases) {
+    const native = time(bind(addon), Math.ceil(iterations)) / per;
+    const web = time(bind(wasm), Math.ceil(iterations)) / per;
+    console.log(`${`${name} (${unit})`.padEnd(28)}${native.toFixed(1).padStart(10)}${web.toFixed(1).padStart(10)}` +
+                `${`${(web / native).toFixed(2)}x`.padStart(12)}`);
+  }
+}
+
+async function main() {
+  const require = createRequire(import.meta.url);
+  const addon = require(path.join(ROOT, 'build', 'Release', 'musclemap_native.node'));
+  const { loadMuscleMapWasm } = await import(pathToFileURL(path.join(ROOT, 'lib', 'wasm', 'musclemap-wasm.mjs')).href);
+  const wasm = await loadMuscleMapWasm();
+  const catalog = path.join(ROOT, 'lib', 'catalog.bin');
+
+  console.log('Testing wasm against the addon...');
+  const { distances, boxLng } = checkGeo(addon, wasm);
+  const workouts = checkTu(addon, wasm, catalog);
+
+  for (const [name, tally] of [['haversine', distances], ['boundingBox lng', boxLng]]) {
+    console.log(`  ${name}: ${tally.exact}/${tally.total} identical, max ${tally.maxUlp} ulp (libm)`);
+  }
+  if (failures > 0) {
+    console.log(`${failures} mismatches`);
+    process.exit(1);
+  }
+  console.log('  geohash, TU: identical');
+
+  throughput(addon, wasm, workouts);
+}
+
+main().catch((err) => {
+  console.error(err);
+  process.exit(1);
+});
@@ -0,0 +1,280 @@
+#!/usr/bin/env node
+/**
+ * Build the binary exercise catalog
+ *
+ * Usage: node tools/build-catalog.js [output] (default: lib/catalog.bin)
+ *
+ * Reads musclemap_exercises.json and new-path-exercises.json from the
+ * repository root and writes the mmap-able catalog described in
+ * src/common/catalog_format.h, loaded in place by libtu
+ * (tu_load_catalog) and the constraint solver (loadCatalogFile).
+ *
+ * Mapping (shared with apps/api/native/bench/convert-catalog.js):
+ * - Muscles are indexed in musclemap_exercises.json order (at most 64)
+ * - Exercise IDs hash with FNV-1a over their UTF-8 bytes
+ * - category -> movement pattern (Lunge counts as squat, unknown as isolation)
+ * - difficulty strings map beginner/intermediate/advanced to 1/3/5
+ * - compound: five or more activated muscles
+ * - primary muscles: activation >= 70 on muscles 0-30
+ * - bodyweight works everywhere; kettlebells at gym/home/park; free weights
+ *   and the equipment paths (pool, pole, ...) at the gym only
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const ROOT = path.resolve(__dirname, '../..');
+
+// Must match src/common/catalog_format.h
+const MAGIC = 'MMCATLG';
+const FORMAT_VERSION = 1;
+const BYTE_ORDER = 0x01020304;
+const ALIGN = 64;
+const ID_LEN = 64;
+const MAX_MUSCLES = 64;
+const BITSET_ROWS = 32;
+const HEADER_SIZE = 56 + 19 * 8;
+const SECTIONS = [
+  'exerciseIds', 'idTable', 'exercises', 'difficulty', 'movementPattern', 'isCompound',
+  'exclusionMask', 'activeMask', 'workedMask', 'locationBits', 'equipmentBits',
+  'activations', 'activationSpan', 'csrOffsets', 'csrMuscles', 'csrValues',
+  'muscleIds', 'muscleBias', 'muscleRecovery',
+];
+
+// Muscles covered by the solver's mask columns (MAX_MUSCLES in constraint-solver.c)
+const MASK_MUSCLES = 50;
+const DEFAULT_RECOVERY_HOURS = 48;
+
+const PATTERNS = { Push: 0, Pull: 1, Squat: 2, Lunge: 2, Hinge: 3, Carry: 4, Core: 5, Isolation: 6 };
+const DIFFICULTY = { beginner: 1, intermediate: 3, advanced: 5 };
+
+// Location bits: gym=0, home=1, park=2, hotel=3, office=4, travel=5
+const ALL_LOCATIONS = 0b111111;
+const GROUPS = {
+  bodyweight: { locations: ALL_LOCATIONS, equipment: 0 },
+  kettlebell: { locations: 0b111, equipment: 1 << 1 },
+  freeweight: { locations: 0b1, equipment: 1 << 2 },
+  swimming: { locations: 0b1, equipment: 1 << 3 },
+  pole: { locations: 0b1, equipment: 1 << 4 },
+  equestrian: { locations: 0b1, equipment: 1 << 5 },
+  cycling: { locations: 0b1, equipment: 1 << 6 },
+  climbing: { locations: 0b1, equipment: 1 << 7 },
+  rowing: { locations: 0b1, equipment: 1 << 8 },
+};
+
+/**
+ * FNV-1a over the UTF-8 bytes of a string, as a signed 32-bit integer
+ */
+function fnv1a(str) {
+  let hash = 0x811c9dc5;
+  for (const byte of Buffer.from(str, 'utf8')) {
+    hash ^= byte;
+    hash = Math.imul(hash, 0x01000193);
+  }
+  return hash | 0;
+}
+
+/**
+ * Read both JSON catalogs into muscles and exercises with dense indices
+ */
+function readSourceCatalog(root = ROOT) {
+  const base = JSON.parse(fs.readFileSync(path.join(root, 'musclemap_exercises.json'), 'utf8'));
+  const paths = JSON.parse(fs.readFileSync(path.join(root, 'new-path-exercises.json'), 'utf8'));
+
+  const muscleIds = Object.keys(base.muscles);
+  if (muscleIds.length > MAX_MUSCLES) {
+    throw new Error(`${muscleIds.length} muscles, the catalog holds at most ${MAX_MUSCLES}`);
+  }
+  const muscleIndex = new Map(muscleIds.map((id, i) => [id, i]));
+  const muscles = muscleIds.map((id) => ({
+    id,
+    bias: base.muscles[id].bias ?? 1,
+    recoveryHours: base.muscles[id].recovery_hrs || DEFAULT_RECOVERY_HOURS,
+  }));
+
+  const exercises = [];
+  for (const catalog of [base, paths]) {
+    for (const [group, list] of Object.entries(catalog.exercises)) {
+      const placement = GROUPS[group] || { locations: 0b1, equipment: 0 };
+
+      for (const ex of list) {
+        const activations = new Float32Array(MAX_MUSCLES);
+        let primary = 0;
+        for (const [muscle, value] of Object.entries(ex.activations || {})) {
+          const m = muscleIndex.get(muscle);
+          if (m === undefined || value <= 0) continue;
+          activations[m] = value;
+          if (value >= 70 && m < 31) primary |= 1 << m;
+        }
+
+        const difficulty = typeof ex.difficulty === 'number' ? ex.difficulty : DIFFICULTY[ex.difficulty] || 2;
+        exercises.push({
+          id: ex.id,
+          hash: fnv1a(ex.id),
+          difficulty,
+          compound: Object.keys(ex.activations || {}).length >= 5 ? 1 : 0,
+          pattern: PATTERNS[ex.category] ?? PATTERNS.Isolation,
+          seconds: 60,
+          rest: difficulty >= 4 ? 90 : 60,
+          locations: placement.locations,
+          equipment: placement.equipment,
+          primary,
+          activations,
+        });
+      }
+    }
+  }
+
+  return { muscles, exercises };
+}
+
+const align = (n) => Math.ceil(n / ALIGN) * ALIGN;
+
+/**
+ * Serialize a catalog from readSourceCatalog() into the binary format
+ */
+function buildCatalog({ muscles, exercises }) {
+  const count = exercises.length;
+  const words = Math.ceil(count / 64);
+  let tableSize = 64;
+  while (tableSize < 2 * count) tableSize *= 2;
+  const tableBits = Math.log2(tableSize);
+
+  // Sections, in CatalogSection order
+  const ids = Buffer.alloc(count * ID_LEN);
+  const idTable = new Int32Array(tableSize);
+  const records = new Int32Array(count * 6);
+  const difficulty = new Int32Array(count);
+  const movementPattern = new Int32Array(count);
+  const isCompound = new Int32Array(count);
+  const exclusionMask = new Int32Array(count);
+  const activeMask = new BigUint64Array(count);
+  const workedMask = new BigUint64Array(count);
+  const locationBits = new BigUint64Array(BITSET_ROWS * words);
+  const equipmentBits = new BigUint64Array(BITSET_ROWS * words);
+  const activations = new Float32Array(count * MAX_MUSCLES);
+  const activationSpan = new Uint32Array(count);
+  const csrOffsets = new Uint32Array(count + 1);
+  const csrMuscles = [];
+  const csrValues = [];
+  let equipmentUsed = 0;
+
+  exercises.forEach((ex, i) => {
+    const idBytes = Buffer.from(ex.id, 'utf8');
+    if (idBytes.length >= ID_LEN) throw new Error(`exercise id too long: ${ex.id}`);
+    idBytes.copy(ids, i * ID_LEN);
+
+    // Fibonacci hashing of the ID hash, linear probing (catalog_id_slot)
+    let slot = Math.imul(ex.hash, 0x9e3779b1) >>> (32 - tableBits);
+    while (idTable[slot] !== 0) slot = (slot + 1) & (tableSize - 1);
+    idTable[slot] = i + 1;
+
+    records.set([ex.hash, ex.seconds, ex.rest, ex.primary, ex.locations, ex.equipment], i * 6);
+    difficulty[i] = ex.difficulty;
+    movementPattern[i] = ex.pattern;
+    isCompound[i] = ex.compound;
+
+    // Same thresholds as set_exercise_muscles() in the solver
+    let worked = BigInt(ex.primary >>> 0);
+    let active = 0n;
+    for (let m = 0; m < MASK_MUSCLES; m++) {
+      if (ex.activations[m] > 40) worked |= 1n << BigInt(m);
+      if (ex.activations[m] > 0) active |= 1n << BigInt(m);
+    }
+    exclusionMask[i] = ex.primary | Number(worked & 0xffffffffn);
+    activeMask[i] = active;
+    workedMask[i] = worked;
+
+    const bit = 1n << BigInt(i % 64);
+    const word = Math.floor(i / 64);
+    for (let row = 0; row < BITSET_ROWS; row++) {
+      if ((ex.locations >>> row) & 1) locationBits[row * words + word] |= bit;
+      if ((ex.equipment >>> row) & 1) equipmentBits[row * words + word] |= bit;
+    }
+    equipmentUsed |= ex.equipment;
+
+    activations.set(ex.activations, i * MAX_MUSCLES);
+    for (let m = 0; m < MAX_MUSCLES; m++) {
+      if (ex.activations[m] > 0) {
+        activationSpan[i] = m + 1;
+        csrMuscles.push(m);
+        csrValues.push(ex.activations[m]);
+      }
+    }
+    csrOffsets[i + 1] = csrMuscles.length;
+  });
+
+  const muscleIds = Buffer.alloc(muscles.length * ID_LEN);
+  muscles.forEach((m, i) => {
+    const idBytes = Buffer.from(m.id, 'utf8');
+    if (idBytes.length >= ID_LEN) throw new Error(`muscle id too long: ${m.id}`);
+    idBytes.copy(muscleIds, i * ID_LEN);
+  });
+
+  const payload = {
+    exerciseIds: ids,
+    idTable,
+    exercises: records,
+    difficulty,
+    movementPattern,
+    isCompound,
+    exclusionMask,
+    activeMask,
+    workedMask,
+    locationBits,
+    equipmentBits,
+    activations,
+    activationSpan,
+    csrOffsets,
+    csrMuscles: Uint16Array.from(csrMuscles),
+    csrValues: Float32Array.from(csrValues),
+    muscleIds,
+    muscleBias: Float32Array.from(muscles.map((m) => m.bias)),
+    muscleRecovery: Int32Array.from(muscles.map((m) => m.recoveryHours)),
+  };
+
+  const offsets = [];
+  let size = align(HEADER_SIZE);
+  for (const name of SECTIONS) {
+    offsets.push(size);
+    size = align(size + payload[name].byteLength);
+  }
+
+  const file = Buffer.alloc(size);
+  file.write(MAGIC, 0, 'latin1');
+  file.writeUInt32LE(FORMAT_VERSION, 8);
+  file.writeUInt32LE(BYTE_ORDER, 12);
+  file.writeBigUInt64LE(BigInt(size), 16);
+  file.writeUInt32LE(count, 24);
+  file.writeUInt32LE(muscles.length, 28);
+  file.writeUInt32LE(MASK_MUSCLES, 32);
+  file.writeUInt32LE(csrValues.length, 36);
+  file.writeUInt32LE(tableSize, 40);
+  file.writeUInt32LE(words, 44);
+  file.writeInt32LE(equipmentUsed, 48);
+  SECTIONS.forEach((name, s) => {
+    file.writeBigUInt64LE(BigInt(offsets[s]), 56 + s * 8);
+    const data = payload[name];
+    Buffer.from(data.buffer, data.byteOffset, data.byteLength).copy(file, offsets[s]);
+  });
+  return file;
+}
+
+function main() {
+  const output = process.argv[2] || path.join(__dirname, '../lib/catalog.bin');
+  const catalog = readSourceCatalog();
+  const file = buildCatalog(catalog);
+
+  // Write beside the target and rename, so processes mapping the old file keep a consistent view
+  fs.mkdirSync(path.dirname(output), { recursive: true });
+  const tmp = `${output}.tmp`;
+  fs.writeFileSync(tmp, file);
+  fs.renameSync(tmp, output);
+  console.log(`Wrote ${catalog.exercises.length} exercises, ${catalog.muscles.length} muscles (${file.length} bytes) to ${output}`);
+}
+
+module.exports = { readSourceCatalog, buildCatalog, fnv1a, MASK_MUSCLES };
+
+if (require.main === module) {
+  main();
+}
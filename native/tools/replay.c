@@ -0,0 +1,735 @@
+/**
+ * Native Capture Replay
+ *
+ * Re-executes a ring file written by the native call capture
+ * (src/capture/native_capture.h, make NATIVE_CAPTURE=1) against the
+ * current libraries and constraint solver, so an optimization can be
+ * measured on real traffic offline.
+ *
+ * Compile: make replay (links libratelimit, librank, libtu; includes the solver)
+ * Usage:   build/replay CAPTURE [--speed X] [--threads N] [--catalog FILE] [--json FILE]
+ *
+ * - --speed 1 (default) replays at the captured pace, 10 ten times faster,
+ *   0 as fast as possible
+ * - --threads N (default 1) deals records round-robin, in time order
+ * - --catalog: binary catalog (lib/catalog.bin, make catalog) for libtu and
+ *   the solver, or a solver text catalog; synthetic catalogs sized from the
+ *   capture otherwise
+ * - --json writes per-operation results in the bench format, so
+ *   bench/compare.js can compare two builds
+ *
+ * Inputs are rebuilt from each record outside the timed section:
+ * - Limiters are recreated per captured limiter with its capacity and
+ *   limit; users beyond the first NATIVE_CAPTURE_RATELIMIT_USERS are
+ *   derived from the captured ones
+ * - Leaderboards are synthetic scores of the captured size
+ * - TU workouts repeat the captured exercises (and sets) up to the
+ *   captured count, split evenly across the batch's workouts
+ * - Solve requests are replayed field for field through the result cache;
+ *   excluded exercises beyond NATIVE_CAPTURE_SOLVE_EXCLUDED are dropped
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../src/capture/native_capture.h"
+#include "../src/ratelimit/limiter.h"
+#include "../src/rank/rank_calculator.h"
+#include "../src/workout/tu_calculator.h"
+
+/* The solver's MAX_MUSCLES is its mask width; libtu's row width is fixed above */
+#undef MAX_MUSCLES
+#define SOLVER_NO_NAPI
+#include "../../apps/api/native/src/constraint-solver.c"
+#include "../../apps/api/native/bench/bench-catalog.h"
+
+#include "bench.h"
+
+/* Configuration constants */
+#define MAX_THREADS 64
+#define MAX_LIMITERS 64
+#define SYNTHETIC_TU_MUSCLES 40
+#define SYNTHETIC_SOLVER_EXERCISES 1000
+
+static const char* const OP_NAMES[NATIVE_CAPTURE_OP_COUNT] = {
+    [NATIVE_CAPTURE_RATELIMIT_CHECK] = "ratelimit_check",
+    [NATIVE_CAPTURE_RATELIMIT_CHECK_BATCH] = "ratelimit_check_batch",
+    [NATIVE_CAPTURE_RANK_FULL_RANKING] = "rank_full_ranking",
+    [NATIVE_CAPTURE_RANK_SIMPLE_PERCENTILES] = "rank_simple_percentiles",
+    [NATIVE_CAPTURE_TU_CALCULATE] = "tu_calculate",
+    [NATIVE_CAPTURE_TU_CALCULATE_BATCH] = "tu_calculate_batch",
+    [NATIVE_CAPTURE_SOLVE] = "solve",
+};
+
+/**
+ * One captured limiter, recreated for the replay
+ */
+typedef struct {
+    uint64_t identity;
+    RateLimiter* limiter;
+} ReplayLimiter;
+
+/**
+ * Replay state shared by the worker threads (read-only once they start)
+ */
+typedef struct {
+    NativeCaptureRecord* records;        /* Valid records in time order */
+    size_t count;
+    int32_t threads;
+    double speed;                        /* 0 = as fast as possible */
+    uint64_t start_ns;                   /* Replay clock origin */
+
+    ReplayLimiter limiters[MAX_LIMITERS];
+    int32_t limiter_count;
+
+    size_t max_rank;                     /* Largest leaderboard */
+    RankedUser* rank_users;              /* [max_rank] template */
+    double* rank_scores;                 /* [max_rank] template */
+
+    size_t max_tu_exercises;             /* Largest TU call, in exercises */
+    int32_t max_tu_workouts;
+
+    Catalog* catalog;
+    ResultCache* cache;
+
+    uint64_t* latency_ns;                /* [count], by record */
+    uint64_t* late_ns;                   /* [count] start behind schedule */
+} Replay;
+
+typedef struct {
+    Replay* replay;
+    int32_t index;
+} ReplayThread;
+
+static int compare_records(const void* a, const void* b) {
+    const NativeCaptureRecord* x = a;
+    const NativeCaptureRecord* y = b;
+    return (x->time_ns > y->time_ns) - (x->time_ns < y->time_ns);
+}
+
+/**
+ * Map a capture and copy out its published records, sorted by start time
+ * Returns the record count, or -1 (after printing the reason) on error
+ */
+static long read_capture(const char* path, NativeCaptureHeader* header_out, NativeCaptureRecord** records_out) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(NativeCaptureHeader)) {
+        fprintf(stderr, "%s: not a capture file\n", path);
+        close(fd);
+        return -1;
+    }
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+
+    const NativeCaptureHeader* header = base;
+    uint64_t capacity = header->capacity;
+    if (memcmp(header->magic, NATIVE_CAPTURE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != NATIVE_CAPTURE_VERSION || header->record_size != sizeof(NativeCaptureRecord) ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        (size_t)st.st_size < sizeof(NativeCaptureHeader) + capacity * sizeof(NativeCaptureRecord)) {
+        fprintf(stderr, "%s: not a version %d capture file\n", path, NATIVE_CAPTURE_VERSION);
+        munmap(base, (size_t)st.st_size);
+        return -1;
+    }
+    memcpy(header_out, header, sizeof(*header_out));
+
+    const NativeCaptureRecord* ring = (const NativeCaptureRecord*)(header + 1);
+    NativeCaptureRecord* records = malloc(capacity * sizeof(NativeCaptureRecord));
+    if (!records) {
+        munmap(base, (size_t)st.st_size);
+        return -1;
+    }
+
+    long count = 0;
+    for (uint64_t slot = 0; slot < capacity; slot++) {
+        const NativeCaptureRecord* record = &ring[slot];
+        uint64_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        /* Skip empty slots, records still being copied in, and torn slots */
+        if (sequence == 0 || (sequence & NATIVE_CAPTURE_PENDING) || ((sequence - 1) & (capacity - 1)) != slot) {
+            continue;
+        }
+        NativeCaptureRecord* copy = &records[count];
+        memcpy(copy, record, sizeof(NativeCaptureRecord));
+        /* A live capture may have rewritten the slot during the copy */
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&record->sequence, memory_order_relaxed) != sequence) {
+            continue;
+        }
+        if (copy->op == 0 || copy->op >= NATIVE_CAPTURE_OP_COUNT) {
+            continue;
+        }
+        count++;
+    }
+    munmap(base, (size_t)st.st_size);
+
+    qsort(records, (size_t)count, sizeof(NativeCaptureRecord), compare_records);
+    *records_out = records;
+    return count;
+}
+
+/* ============================================
+ * INPUTS
+ * ============================================ */
+
+static RateLimiter* find_limiter(Replay* replay, uint64_t identity) {
+    for (int32_t i = 0; i < replay->limiter_count; i++) {
+        if (replay->limiters[i].identity == identity) {
+            return replay->limiters[i].limiter;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Captured user k (derived past the users the record holds)
+ */
+static uint64_t replay_user(const NativeCaptureRatelimit* args, uint64_t k) {
+    uint64_t kept = args->users < NATIVE_CAPTURE_RATELIMIT_USERS ? args->users : NATIVE_CAPTURE_RATELIMIT_USERS;
+    return args->user_ids[k % kept] + (k / kept) * 0x9E3779B97F4A7C15ull;
+}
+
+/**
+ * Captured limiters, leaderboard and TU sizes, and the catalogs
+ * @return 0 on success, -1 on error
+ */
+static int prepare(Replay* replay, const char* catalog_path) {
+    int32_t max_tu_index = 0;
+    int32_t max_catalog = 0;
+
+    for (size_t r = 0; r < replay->count; r++) {
+        const NativeCaptureRecord* record = &replay->records[r];
+        switch (record->op) {
+        case NATIVE_CAPTURE_RATELIMIT_CHECK:
+        case NATIVE_CAPTURE_RATELIMIT_CHECK_BATCH: {
+            const NativeCaptureRatelimit* args = (const NativeCaptureRatelimit*)record->args;
+            if (args->capacity == 0 || find_limiter(replay, args->limiter)) {
+                break;
+            }
+            if (replay->limiter_count == MAX_LIMITERS) {
+                fprintf(stderr, "more than %d limiters captured\n", MAX_LIMITERS);
+                return -1;
+            }
+            RateLimiter* rl = ratelimit_create(args->capacity, args->limit);
+            if (!rl) {
+                return -1;
+            }
+            replay->limiters[replay->limiter_count++] = (ReplayLimiter){args->limiter, rl};
+            break;
+        }
+        case NATIVE_CAPTURE_RANK_FULL_RANKING:
+        case NATIVE_CAPTURE_RANK_SIMPLE_PERCENTILES: {
+            const NativeCaptureRank* args = (const NativeCaptureRank*)record->args;
+            if (args->count > replay->max_rank) {
+                replay->max_rank = args->count;
+            }
+            break;
+        }
+        case NATIVE_CAPTURE_TU_CALCULATE:
+        case NATIVE_CAPTURE_TU_CALCULATE_BATCH: {
+            const NativeCaptureTu* args = (const NativeCaptureTu*)record->args;
+            if (args->exercises > 0 && (size_t)args->exercises > replay->max_tu_exercises) {
+                replay->max_tu_exercises = (size_t)args->exercises;
+            }
+            if (args->workouts > replay->max_tu_workouts) {
+                replay->max_tu_workouts = args->workouts;
+            }
+            int32_t kept = args->exercises < NATIVE_CAPTURE_TU_EXERCISES ? args->exercises : NATIVE_CAPTURE_TU_EXERCISES;
+            for (int32_t e = 0; e < kept; e++) {
+                if (args->exercise_index[e] > max_tu_index) {
+                    max_tu_index = args->exercise_index[e];
+                }
+            }
+            break;
+        }
+        case NATIVE_CAPTURE_SOLVE: {
+            const NativeCaptureSolve* args = (const NativeCaptureSolve*)record->args;
+            if (args->catalog_exercises > max_catalog) {
+                max_catalog = args->catalog_exercises;
+            }
+            break;
+        }
+        }
+    }
+
+    /* Leaderboard templates: distinct users, scores with ties */
+    if (replay->max_rank > 0) {
+        replay->rank_users = calloc(replay->max_rank, sizeof(RankedUser));
+        replay->rank_scores = malloc(replay->max_rank * sizeof(double));
+        if (!replay->rank_users || !replay->rank_scores) {
+            return -1;
+        }
+        uint32_t rng = 0x2545F491u;
+        for (size_t i = 0; i < replay->max_rank; i++) {
+            double score = (double)(xorshift32(&rng) % 100000) / 10.0;
+            snprintf(replay->rank_users[i].user_id, USER_ID_LEN, "user-%zu", i);
+            replay->rank_users[i].score = score;
+            replay->rank_scores[i] = score;
+        }
+    }
+
+    /* libtu: the binary catalog in place, else synthetic exercises */
+    int tu_loaded = catalog_path ? tu_load_catalog(catalog_path) : -1;
+    if (tu_loaded < 0) {
+        tu_init();
+        uint32_t rng = 0x9E3779B9u;
+        float activations[SYNTHETIC_TU_MUSCLES];
+        char id[32];
+        for (int32_t m = 0; m < SYNTHETIC_TU_MUSCLES; m++) {
+            snprintf(id, sizeof(id), "muscle-%d", m);
+            tu_add_muscle(id, 0.5f + (float)(xorshift32(&rng) % 100) / 100.0f);
+        }
+        for (int32_t i = 0; i <= max_tu_index; i++) {
+            for (int32_t m = 0; m < SYNTHETIC_TU_MUSCLES; m++) {
+                activations[m] = xorshift32(&rng) % 6 == 0 ? (float)(xorshift32(&rng) % 100) : 0.0f;
+            }
+            snprintf(id, sizeof(id), "exercise-%d", i);
+            tu_add_exercise(id, activations, SYNTHETIC_TU_MUSCLES);
+        }
+    }
+    int32_t tu_exercises = 0, tu_muscles = 0;
+    tu_get_stats(&tu_exercises, &tu_muscles);
+
+    /* Solver: the given catalog, else synthetic at the captured size */
+    replay->catalog = catalog_path ? load_catalog(catalog_path) : NULL;
+    if (catalog_path && !replay->catalog) {
+        return -1;
+    }
+    if (!replay->catalog) {
+        replay->catalog = synthetic_catalog(max_catalog > 0 ? max_catalog : SYNTHETIC_SOLVER_EXERCISES, 0);
+        if (!replay->catalog) {
+            return -1;
+        }
+    }
+    atomic_init(&replay->catalog->refcount, 1);
+    replay->catalog->version = 1;
+    SolverInstance* instance = instance_create();
+    if (!instance) {
+        return -1;
+    }
+    instance->cache.catalog_version = replay->catalog->version;
+    replay->cache = &instance->cache;
+
+    printf("libtu: %s, %d exercises; solver: %s, %d exercises; %d limiter(s)\n",
+           tu_loaded < 0 ? "synthetic" : catalog_path, tu_exercises,
+           catalog_path ? catalog_path : "synthetic", replay->catalog->exercise_count, replay->limiter_count);
+    return 0;
+}
+
+/* ============================================
+ * REPLAY
+ * ============================================ */
+
+/**
+ * Per-thread buffers, sized for the largest captured call
+ */
+typedef struct {
+    uint64_t* user_ids;
+    int8_t* verdicts;
+    size_t users;
+    RankedUser* rank_users;
+    double* rank_scores;
+    double* percentiles;
+    WorkoutExerciseInput* tu_inputs;
+    const WorkoutExerciseInput** tu_workouts;
+    int32_t* tu_counts;
+    TUResult* tu_results;
+    uint64_t* excluded;
+    int32_t* out_indices;
+    int32_t* out_sets;
+    int32_t* out_reps;
+    int32_t* out_groups;
+} Scratch;
+
+static int scratch_reserve_users(Scratch* s, size_t users) {
+    if (users <= s->users) {
+        return 0;
+    }
+    uint64_t* ids = realloc(s->user_ids, users * sizeof(uint64_t));
+    if (ids) s->user_ids = ids;
+    int8_t* verdicts = realloc(s->verdicts, users);
+    if (verdicts) s->verdicts = verdicts;
+    if (!ids || !verdicts) {
+        return -1;
+    }
+    s->users = users;
+    return 0;
+}
+
+static int scratch_init(Scratch* s, const Replay* replay) {
+    memset(s, 0, sizeof(*s));
+    size_t rank = replay->max_rank ? replay->max_rank : 1;
+    size_t exercises = replay->max_tu_exercises ? replay->max_tu_exercises : 1;
+    size_t workouts = replay->max_tu_workouts > 0 ? (size_t)replay->max_tu_workouts : 1;
+    size_t plan = (size_t)replay->catalog->exercise_count + 1;
+    if (scratch_reserve_users(s, NATIVE_CAPTURE_RATELIMIT_USERS) != 0) {
+        return -1;
+    }
+
+    s->rank_users = malloc(rank * sizeof(RankedUser));
+    s->rank_scores = malloc(rank * sizeof(double));
+    s->percentiles = malloc(rank * sizeof(double));
+    s->tu_inputs = calloc(exercises, sizeof(WorkoutExerciseInput));
+    s->tu_workouts = malloc(workouts * sizeof(WorkoutExerciseInput*));
+    s->tu_counts = malloc(workouts * sizeof(int32_t));
+    s->tu_results = malloc(workouts * sizeof(TUResult));
+    s->excluded = malloc((size_t)(replay->catalog->words + 1) * sizeof(uint64_t));
+    s->out_indices = malloc(plan * sizeof(int32_t));
+    s->out_sets = malloc(plan * sizeof(int32_t));
+    s->out_reps = malloc(plan * sizeof(int32_t));
+    s->out_groups = malloc(plan * sizeof(int32_t));
+    return s->rank_users && s->rank_scores && s->percentiles && s->tu_inputs && s->tu_workouts &&
+           s->tu_counts && s->tu_results && s->excluded && s->out_indices && s->out_sets && s->out_reps &&
+           s->out_groups ? 0 : -1;
+}
+
+static void scratch_free(Scratch* s) {
+    free(s->user_ids);
+    free(s->verdicts);
+    free(s->rank_users);
+    free(s->rank_scores);
+    free(s->percentiles);
+    free(s->tu_inputs);
+    free(s->tu_workouts);
+    free(s->tu_counts);
+    free(s->tu_results);
+    free(s->excluded);
+    free(s->out_indices);
+    free(s->out_sets);
+    free(s->out_reps);
+    free(s->out_groups);
+}
+
+/**
+ * Rebuild a TU call's workouts in the scratch buffers
+ * @return Number of workouts
+ */
+static int32_t build_workouts(Scratch* s, const NativeCaptureTu* args) {
+    int32_t workouts = args->workouts > 0 ? args->workouts : 1;
+    int32_t exercises = args->exercises > 0 ? args->exercises : 0;
+    int32_t kept = exercises < NATIVE_CAPTURE_TU_EXERCISES ? exercises : NATIVE_CAPTURE_TU_EXERCISES;
+
+    for (int32_t e = 0; e < exercises; e++) {
+        s->tu_inputs[e].exercise_index = args->exercise_index[e % kept];
+        s->tu_inputs[e].sets = args->sets[e % kept];
+        s->tu_inputs[e].reps = 10;
+        s->tu_inputs[e].weight = 0.0f;
+    }
+
+    int32_t offset = 0;
+    for (int32_t w = 0; w < workouts; w++) {
+        int32_t count = exercises / workouts + (w < exercises % workouts ? 1 : 0);
+        s->tu_workouts[w] = s->tu_inputs + offset;
+        s->tu_counts[w] = count;
+        offset += count;
+    }
+    return workouts;
+}
+
+/**
+ * Rebuild a solve request (excluded exercises in the scratch bitset)
+ */
+static void build_request(Scratch* s, const Catalog* cat, const NativeCaptureSolve* args, SolverRequest* req) {
+    memset(req, 0, sizeof(*req));
+    req->time_available_seconds = args->time_available_seconds;
+    req->location = args->location;
+    req->equipment_mask = args->equipment_mask;
+    req->goals_mask = args->goals_mask;
+    req->fitness_level = args->fitness_level;
+    req->excluded_muscles_mask = args->excluded_muscles_mask;
+    req->recent_24h_muscles_mask = args->recent_24h_muscles_mask;
+    req->recent_48h_muscles_mask = args->recent_48h_muscles_mask;
+    req->optimize_deadline_us = args->optimize_deadline_us;
+    for (int p = 0; p < PATTERN_SLOTS; p++) {
+        req->pattern_quota[p] = args->pattern_quota[p];
+    }
+    req->max_antagonist_imbalance = args->max_antagonist_imbalance;
+    req->seed = args->seed;
+    req->variety = args->variety;
+    req->max_group_size = args->max_group_size;
+    memcpy(&req->weights, args->weights, sizeof(req->weights));
+
+    int32_t kept = args->excluded_count < NATIVE_CAPTURE_SOLVE_EXCLUDED ? args->excluded_count
+                                                                        : NATIVE_CAPTURE_SOLVE_EXCLUDED;
+    if (kept > 0 && cat->exercise_count > 0) {
+        memset(s->excluded, 0, (size_t)cat->words * sizeof(uint64_t));
+        for (int32_t e = 0; e < kept; e++) {
+            int32_t idx = args->excluded[e] % cat->exercise_count;
+            s->excluded[idx / 64] |= 1ULL << (idx % 64);
+        }
+        req->excluded_exercises = s->excluded;
+    }
+}
+
+/**
+ * Rebuild record r's inputs, wait for its slot on the replay clock, then time the call
+ */
+static void replay_record(Replay* replay, Scratch* s, size_t r) {
+    const NativeCaptureRecord* record = &replay->records[r];
+    int32_t workouts = 0;
+    SolverRequest request;
+    RateLimiter* rl = NULL;
+    const NativeCaptureRatelimit* limit_args = (const NativeCaptureRatelimit*)record->args;
+    const NativeCaptureRank* rank_args = (const NativeCaptureRank*)record->args;
+
+    switch (record->op) {
+    case NATIVE_CAPTURE_RATELIMIT_CHECK:
+    case NATIVE_CAPTURE_RATELIMIT_CHECK_BATCH:
+        rl = find_limiter(replay, limit_args->limiter);
+        if (limit_args->users > 0 && scratch_reserve_users(s, limit_args->users) == 0) {
+            for (uint64_t k = 0; k < limit_args->users; k++) {
+                s->user_ids[k] = replay_user(limit_args, k);
+            }
+        }
+        break;
+    case NATIVE_CAPTURE_RANK_FULL_RANKING:
+        memcpy(s->rank_users, replay->rank_users, rank_args->count * sizeof(RankedUser));
+        break;
+    case NATIVE_CAPTURE_RANK_SIMPLE_PERCENTILES:
+        memcpy(s->rank_scores, replay->rank_scores, rank_args->count * sizeof(double));
+        break;
+    case NATIVE_CAPTURE_TU_CALCULATE:
+    case NATIVE_CAPTURE_TU_CALCULATE_BATCH:
+        workouts = build_workouts(s, (const NativeCaptureTu*)record->args);
+        break;
+    case NATIVE_CAPTURE_SOLVE:
+        build_request(s, replay->catalog, (const NativeCaptureSolve*)record->args, &request);
+        break;
+    }
+
+    uint64_t scheduled = replay->start_ns;
+    if (replay->speed > 0.0) {
+        scheduled += (uint64_t)((double)(record->time_ns - replay->records[0].time_ns) / replay->speed);
+        struct timespec until = {(time_t)(scheduled / 1000000000ull), (long)(scheduled % 1000000000ull)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR) {
+        }
+    }
+
+    uint64_t t0 = bench_now_ns();
+    switch (record->op) {
+    case NATIVE_CAPTURE_RATELIMIT_CHECK:
+        bench_sink = ratelimit_check(rl, s->user_ids[0], limit_args->count);
+        break;
+    case NATIVE_CAPTURE_RATELIMIT_CHECK_BATCH:
+        bench_sink = ratelimit_check_batch(rl, s->user_ids, limit_args->users, limit_args->count, s->verdicts);
+        break;
+    case NATIVE_CAPTURE_RANK_FULL_RANKING:
+        bench_sink = rank_full_ranking(s->rank_users, rank_args->count);
+        break;
+    case NATIVE_CAPTURE_RANK_SIMPLE_PERCENTILES:
+        bench_sink = rank_simple_percentiles(s->rank_scores, rank_args->count, s->percentiles);
+        break;
+    case NATIVE_CAPTURE_TU_CALCULATE:
+        bench_sink = tu_calculate(s->tu_workouts[0], s->tu_counts[0], s->tu_results);
+        break;
+    case NATIVE_CAPTURE_TU_CALCULATE_BATCH:
+        bench_sink = tu_calculate_batch(s->tu_workouts, s->tu_counts, workouts, s->tu_results);
+        break;
+    case NATIVE_CAPTURE_SOLVE: {
+        Arena* arena = thread_arena();
+        ArenaMark mark = arena_mark(arena);
+        bench_sink = solve_cached(replay->cache, replay->catalog, &request, s->out_indices, s->out_sets,
+                                  s->out_reps, s->out_groups, replay->catalog->exercise_count);
+        arena_release(arena, mark);
+        break;
+    }
+    }
+    uint64_t t1 = bench_now_ns();
+
+    replay->latency_ns[r] = t1 - t0;
+    replay->late_ns[r] = replay->speed > 0.0 && t0 > scheduled ? t0 - scheduled : 0;
+}
+
+static void* replay_thread(void* arg) {
+    ReplayThread* thread = arg;
+    Replay* replay = thread->replay;
+    Scratch scratch;
+    if (scratch_init(&scratch, replay) != 0) {
+        fprintf(stderr, "replay thread %d: out of memory\n", thread->index);
+        scratch_free(&scratch);
+        return NULL;
+    }
+
+    for (size_t r = (size_t)thread->index; r < replay->count; r += (size_t)replay->threads) {
+        replay_record(replay, &scratch, r);
+    }
+    scratch_free(&scratch);
+    return NULL;
+}
+
+/* ============================================
+ * REPORT
+ * ============================================ */
+
+/**
+ * Per-operation latency table (replayed and as captured), and the bench JSON
+ */
+static int report(const Replay* replay, uint64_t elapsed_ns, const char* json_path) {
+    Bench b;
+    memset(&b, 0, sizeof(b));
+    b.suite = "replay";
+    b.reps = (int32_t)(replay->count < BENCH_MAX_REPS ? replay->count : BENCH_MAX_REPS);
+    b.cpu = -1;
+    b.json_path = json_path;
+
+    double* replayed = malloc((replay->count + 1) * sizeof(double));
+    double* captured = malloc((replay->count + 1) * sizeof(double));
+    double* late = malloc((replay->count + 1) * sizeof(double));
+    if (!replayed || !captured || !late) {
+        free(replayed);
+        free(captured);
+        free(late);
+        return 1;
+    }
+
+    double seconds = (double)elapsed_ns / 1e9;
+    printf("\n%-24s %8s %10s %10s %10s %10s %10s %12s\n", "operation", "calls", "p50 ns", "p90 ns", "p99 ns",
+           "max ns", "orig p50", "calls/s");
+    for (int op = 1; op < NATIVE_CAPTURE_OP_COUNT; op++) {
+        int32_t n = 0;
+        double sum = 0.0;
+        for (size_t r = 0; r < replay->count; r++) {
+            if (replay->records[r].op != op) continue;
+            replayed[n] = (double)replay->latency_ns[r];
+            captured[n] = (double)replay->records[r].duration_ns;
+            sum += replayed[n];
+            n++;
+        }
+        if (n == 0) continue;
+        qsort(replayed, (size_t)n, sizeof(double), bench_compare_double);
+        qsort(captured, (size_t)n, sizeof(double), bench_compare_double);
+
+        printf("%-24s %8d %10.0f %10.0f %10.0f %10.0f %10.0f %12.0f\n", OP_NAMES[op], n,
+               bench_percentile(replayed, n, 0.50), bench_percentile(replayed, n, 0.90),
+               bench_percentile(replayed, n, 0.99), replayed[n - 1], bench_percentile(captured, n, 0.50),
+               n / seconds);
+
+        if (b.count < BENCH_MAX_RESULTS) {
+            BenchResult* res = &b.results[b.count++];
+            snprintf(res->name, sizeof(res->name), "%s", OP_NAMES[op]);
+            res->samples = n;
+            res->ops_per_sample = 1.0;
+            res->min_ns = replayed[0];
+            res->p50_ns = bench_percentile(replayed, n, 0.50);
+            res->p90_ns = bench_percentile(replayed, n, 0.90);
+            res->p99_ns = bench_percentile(replayed, n, 0.99);
+            res->mean_ns = sum / n;
+        }
+    }
+
+    printf("\n%zu calls in %.3f s (%.0f calls/s, %d thread(s))\n", replay->count, seconds,
+           (double)replay->count / seconds, replay->threads);
+    if (replay->speed > 0.0 && replay->count > 0) {
+        for (size_t r = 0; r < replay->count; r++) {
+            late[r] = (double)replay->late_ns[r];
+        }
+        qsort(late, replay->count, sizeof(double), bench_compare_double);
+        printf("Start lateness vs the %.3gx schedule: p50 %.0f ns, p99 %.0f ns, max %.0f ns\n", replay->speed,
+               bench_percentile(late, (int32_t)replay->count, 0.50),
+               bench_percentile(late, (int32_t)replay->count, 0.99), late[replay->count - 1]);
+    }
+
+    free(replayed);
+    free(captured);
+    free(late);
+    return bench_finish(&b);
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s CAPTURE [--speed X] [--threads N] [--catalog FILE] [--json FILE]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Replay replay;
+    memset(&replay, 0, sizeof(replay));
+    replay.speed = 1.0;
+    replay.threads = 1;
+    const char* catalog_path = NULL;
+    const char* json_path = NULL;
+
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--speed") == 0) replay.speed = atof(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0) replay.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--catalog") == 0) catalog_path = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0) json_path = argv[++i];
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (replay.speed < 0.0 || replay.threads < 1 || replay.threads > MAX_THREADS) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    NativeCaptureHeader header;
+    long count = read_capture(argv[1], &header, &replay.records);
+    if (count < 0) {
+        return 1;
+    }
+    if (count == 0) {
+        fprintf(stderr, "%s: no records\n", argv[1]);
+        return 1;
+    }
+    replay.count = (size_t)count;
+    printf("%s: %zu records (pid %u, 1 in %u calls, ring of %llu), span %.3f s\n", argv[1], replay.count,
+           header.pid, header.sample_every, (unsigned long long)header.capacity,
+           (double)(replay.records[replay.count - 1].time_ns - replay.records[0].time_ns) / 1e9);
+
+    replay.latency_ns = calloc(replay.count, sizeof(uint64_t));
+    replay.late_ns = calloc(replay.count, sizeof(uint64_t));
+    if (!replay.latency_ns || !replay.late_ns || prepare(&replay, catalog_path) != 0) {
+        fprintf(stderr, "cannot prepare the replay\n");
+        return 1;
+    }
+
+    pthread_t threads[MAX_THREADS];
+    ReplayThread args[MAX_THREADS];
+    replay.start_ns = bench_now_ns();
+    for (int32_t t = 0; t < replay.threads; t++) {
+        args[t] = (ReplayThread){&replay, t};
+        if (pthread_create(&threads[t], NULL, replay_thread, &args[t]) != 0) {
+            fprintf(stderr, "cannot start replay thread %d\n", t);
+            return 1;
+        }
+    }
+    for (int32_t t = 0; t < replay.threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    uint64_t elapsed = bench_now_ns() - replay.start_ns;
+
+    int status = report(&replay, elapsed, json_path);
+    for (int32_t i = 0; i < replay.limiter_count; i++) {
+        ratelimit_destroy(replay.limiters[i].limiter);
+    }
+    catalog_release(replay.catalog);
+    free(replay.records);
+    free(replay.latency_ns);
+    free(replay.late_ns);
+    return status;
+}